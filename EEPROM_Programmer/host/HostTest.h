@@ -0,0 +1,60 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <cstdio>
+
+/**
+ * Checks of the host tests (host/<name>_test.cpp). Each test is its own executable, which is run by ctest:
+ * cmake -S host -B host/build && cmake --build host/build && ctest --test-dir host/build
+ *
+ * A failed check prints its file, line and expression and the test continues, so a single run shows all of the failures.
+ * No test framework is needed, the tests build everywhere the host tools build.
+ *
+ * Example:
+ * int main() {
+ *     CHECK_EQUAL(reverseBits(0b00000001), 0b10000000);
+ *     return testResult();
+ * }
+ */
+
+static unsigned int testChecks = 0;
+static unsigned int testFailures = 0;
+
+#define CHECK(condition) checkTest((condition), #condition, __FILE__, __LINE__)
+#define CHECK_EQUAL(actual, expected) checkTestEqual((long long) (actual), (long long) (expected), #actual, #expected, __FILE__, __LINE__)
+
+static inline bool checkTest(const bool& condition, const char* expression, const char* file, const int& line) {
+
+    testChecks++;
+
+    if (!condition) {
+        testFailures++;
+        printf("%s:%d: CHECK(%s) failed\n", file, line, expression);
+    }
+
+    return condition;
+}
+
+static inline bool checkTestEqual(const long long& actual, const long long& expected, const char* actualExpression, const char* expectedExpression,
+                                  const char* file, const int& line) {
+
+    testChecks++;
+
+    if (actual != expected) {
+        testFailures++;
+        printf("%s:%d: CHECK_EQUAL(%s, %s) failed: %lld != %lld\n", file, line, actualExpression, expectedExpression, actual, expected);
+    }
+
+    return actual == expected;
+}
+
+/**
+ * Prints the summary.
+ * @return The exit code of the test.
+ */
+static inline int testResult() {
+    printf("%u checks, %u failed\n", testChecks, testFailures);
+    return testFailures == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,32 @@
+#include "MicrocodeFiles.h"
+
+#include <fstream>
+#include <iterator>
+
+#include <Microcode.h>
+
+bool readBinaryFile(const std::string& path, std::vector<uint8_t>& bytes) {
+
+    std::ifstream file(path.c_str(), std::ios::binary);
+
+    if (!file)
+        return false;
+
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool loadMicrocodeImages(const std::string& firstPath, const std::string& secondPath,
+                         std::vector<uint8_t>& first, std::vector<uint8_t>& second) {
+
+    if (firstPath.empty() && secondPath.empty()) {
+        first.assign(MicrocodeImage::first, MicrocodeImage::first + MICROCODE_IMAGE_SIZE);
+        second.assign(MicrocodeImage::second, MicrocodeImage::second + MICROCODE_IMAGE_SIZE);
+        return true;
+    }
+
+    if (!readBinaryFile(firstPath, first) || !readBinaryFile(secondPath, second))
+        return false;
+
+    return !first.empty() && first.size() == second.size() && (first.size() & (first.size() - 1)) == 0 && first.size() <= 0x8000;
+}
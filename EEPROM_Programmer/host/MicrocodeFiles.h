@@ -0,0 +1,18 @@
+#ifndef MICROCODE_FILES_H
+#define MICROCODE_FILES_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+bool readBinaryFile(const std::string& path, std::vector<uint8_t>& bytes);
+
+/**
+ * Loads the images of the two microcode EEPROMs. For example a dump of the real chips made with eeprom_dump.
+ * If the paths are empty the images generated from InstructionSet.h are used.
+ * @return False if a file can't be read or the images are not the same power of 2 size.
+ */
+bool loadMicrocodeImages(const std::string& firstPath, const std::string& secondPath,
+                         std::vector<uint8_t>& first, std::vector<uint8_t>& second);
+
+#endif
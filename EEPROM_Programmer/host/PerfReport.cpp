@@ -0,0 +1,16 @@
+#include "PerfReport.h"
+
+#include <cstdio>
+
+void printPerfReport(const std::vector<PerfReportLine>& lines, const uint32_t& clockHz) {
+
+    printf("operation,count,min_cycles,avg_cycles,max_cycles,total_cycles,total_us\n");
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        const PerfCounter& counter = lines[i].counter;
+
+        printf("%s,%u,%u,%.1f,%u,%llu,%.1f\n", perfOperationName(lines[i].operation), counter.count, counter.min,
+               counter.count > 0 ? (double) counter.total / counter.count : 0.0, counter.max, (unsigned long long) counter.total,
+               clockHz > 0 ? counter.total * 1000000.0 / clockHz : 0.0);
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef PERF_REPORT_H
+#define PERF_REPORT_H
+
+#include <stdint.h>
+#include <vector>
+
+#include <PerfCounters.h>
+
+/**
+ * A counter (PerfCounters.h) of the programmer or of the simulated board with its operation.
+ */
+struct PerfReportLine {
+    uint8_t operation;
+    PerfCounter counter;
+};
+
+/**
+ * Prints the counters as CSV, one operation per line, so the reports of the Nano and the simulation can be compared with any tool:
+ * operation,count,min_cycles,avg_cycles,max_cycles,total_cycles,total_us
+ * @param clockHz The CPU clock, which converts the total to microseconds.
+ */
+void printPerfReport(const std::vector<PerfReportLine>& lines, const uint32_t& clockHz);
+
+#endif
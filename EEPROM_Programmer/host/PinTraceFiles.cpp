@@ -0,0 +1,80 @@
+#include "PinTraceFiles.h"
+
+#include <fstream>
+
+std::vector<TimedPinEvent> unwrapPinTrace(const std::vector<PinTraceEvent>& events, const uint32_t& clockHz) {
+
+    std::vector<TimedPinEvent> timed;
+    uint64_t cycles = 0;
+
+    for (size_t i = 0; i < events.size(); ++i) {
+
+        if (i > 0)
+            cycles += (uint16_t) (events[i].cycles - events[i - 1].cycles);
+
+        TimedPinEvent event = {cycles * 1000000000ULL / clockHz, events[i].signal, events[i].value};
+        timed.push_back(event);
+    }
+
+    return timed;
+}
+
+/**
+ * VCD identifiers of the signals. IO and IO_RELEASED are the same 8 bit wire.
+ */
+static const char* VCD_IDS[] = {"s", "c", "r", "w", "o", "d", "d"};
+
+static void writeVCDValue(std::ofstream& file, const uint8_t& signal, const uint8_t& value) {
+
+    if (signal == PIN_TRACE_IO_RELEASED) {
+        file << "bzzzzzzzz " << VCD_IDS[signal] << "\n";
+        return;
+    }
+
+    if (signal != PIN_TRACE_IO) {
+        file << (value ? '1' : '0') << VCD_IDS[signal] << "\n";
+        return;
+    }
+
+    file << 'b';
+
+    for (int bit = 7; bit >= 0; --bit)
+        file << ((value >> bit) & 0b1 ? '1' : '0');
+
+    file << ' ' << VCD_IDS[signal] << "\n";
+}
+
+bool writeVCD(const std::string& path, const std::vector<TimedPinEvent>& events) {
+
+    std::ofstream file(path.c_str());
+
+    file << "$timescale 1ns $end\n"
+            "$scope module programmer $end\n"
+            "$var wire 1 s SER $end\n"
+            "$var wire 1 c SRCLK $end\n"
+            "$var wire 1 r RCLK $end\n"
+            "$var wire 1 w WE $end\n"
+            "$var wire 1 o OE $end\n"
+            "$var wire 8 d IO $end\n"
+            "$upscope $end\n"
+            "$enddefinitions $end\n"
+            "$dumpvars\nxs\nxc\nxr\nxw\nxo\nbxxxxxxxx d\n$end\n";
+
+    uint64_t time = 0;
+
+    for (size_t i = 0; i < events.size(); ++i) {
+        const TimedPinEvent& event = events[i];
+
+        if (event.signal > PIN_TRACE_IO_RELEASED)
+            continue;
+
+        if (i == 0 || event.ns != time) {
+            time = event.ns;
+            file << '#' << time << "\n";
+        }
+
+        writeVCDValue(file, event.signal, event.value);
+    }
+
+    return (bool) file;
+}
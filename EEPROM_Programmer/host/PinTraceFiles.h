@@ -0,0 +1,53 @@
+#ifndef PIN_TRACE_FILES_H
+#define PIN_TRACE_FILES_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <PinTrace.h>
+#include <SimulatedBoard.h>
+
+/**
+ * Pin trace event (PinTrace.h) with the full time since the start of the trace.
+ */
+struct TimedPinEvent {
+    uint64_t ns;
+    uint8_t signal;
+    uint8_t value;
+};
+
+/**
+ * Trace of TracingHAL on the simulated board. The time is taken from the board, so it is not limited to 16 bits like on the Nano.
+ * Only the first @param limit events are kept.
+ */
+struct SimulatedPinTrace {
+    SimulatedBoard& board;
+    size_t limit;
+    std::vector<TimedPinEvent> events;
+
+    void record(const uint16_t& cycles, const uint8_t& signal, const uint8_t& value) {
+        (void) cycles;
+
+        if (events.size() >= limit)
+            return;
+
+        TimedPinEvent event = {(uint64_t) (board.cyclesToMicros(board.getCounters().cycles) * 1000 + 0.5), signal, value};
+        events.push_back(event);
+    }
+};
+
+/**
+ * Converts the events downloaded from the programmer. The 16 bit timestamps are unwrapped by adding the difference
+ * to the previous event, thus gaps longer than 65536 cycles are shortened (see PinTrace.h).
+ * @param clockHz The CPU clock of the programmer.
+ */
+std::vector<TimedPinEvent> unwrapPinTrace(const std::vector<PinTraceEvent>& events, const uint32_t& clockHz);
+
+/**
+ * Saves the events as Value Change Dump, which can be opened with GTKWave.
+ * OE is the level of the pin (active LOW). The data bus is 'z' when the programmer doesn't drive it.
+ */
+bool writeVCD(const std::string& path, const std::vector<TimedPinEvent>& events);
+
+#endif
@@ -0,0 +1,155 @@
+#include "ProgrammerClient.h"
+
+#define ANSWER_TIMEOUT_MS 1000
+#define ANSWER_ATTEMPTS 10
+#define BEGIN_RETRY_MS 250
+#define END_RETRY_MS 2000
+#define REQUEST_RETRY_MS 250
+#define INACTIVITY_TIMEOUT_MS 1000
+#define VERIFY_US_PER_ADDRESS 45
+
+bool uploadImage(SerialPort& port, uint8_t& seq, const std::vector<uint8_t>& image, const UploadOptions& options, UploadResult& result) {
+
+    result = UploadResult();
+
+    if (image.empty() || options.address + image.size() > 0x10000) {
+        result.error = "The image doesn't fit in the address space.";
+        return false;
+    }
+
+    FrameDecoder decoder;
+    Frame answer;
+    uint8_t payload[FRAME_MAX_PAYLOAD];
+
+    writeUint16(payload, options.address);
+    writeUint16(payload + 2, image.size());
+
+    uint64_t start = hostMillis();
+
+    if (!exchangeFrame(port, decoder, FRAME_BEGIN, seq, payload, 4, FRAME_ACK, answer, BEGIN_RETRY_MS, options.waitMs / BEGIN_RETRY_MS + 1)) {
+        result.error = "The programmer doesn't answer.";
+        return false;
+    }
+
+    for (size_t offset = 0; offset < image.size();) {
+
+        uint8_t length;
+        uint32_t consumed;
+        uint8_t type = fillDataFrame(&image[offset], image.size() - offset, options.address + offset, options.packed, options.skipValue,
+                                     payload, length, consumed);
+        seq++;
+
+        if (!exchangeFrame(port, decoder, type, seq, payload, length, FRAME_ACK, answer, ANSWER_TIMEOUT_MS, ANSWER_ATTEMPTS)) {
+            result.error = "No ACK for the data at address " + std::to_string(options.address + offset) + ".";
+            return false;
+        }
+
+        offset += consumed;
+        result.sentBytes += FRAME_HEADER_LENGTH + length + FRAME_CRC_LENGTH;
+        result.frames++;
+    }
+
+    seq++;
+    uint64_t endDeadline = hostMillis() + 30000 + image.size() * 20;
+    bool finished = false;
+
+    while (!finished && hostMillis() < endDeadline)
+        finished = exchangeFrame(port, decoder, FRAME_END, seq, 0, 0, FRAME_RESULT, answer, END_RETRY_MS, 1);
+
+    seq++;
+
+    if (!finished || answer.length < 8) {
+        result.error = "The programmer didn't report the result.";
+        return false;
+    }
+
+    result.milliseconds = hostMillis() - start;
+    result.written = readUint16(answer.payload);
+    result.skipped = readUint16(answer.payload + 2);
+    result.verified = readUint16(answer.payload + 4);
+    result.failed = readUint16(answer.payload + 6);
+
+    return true;
+}
+
+uint32_t verifyDurationMs(const uint16_t& length) {
+    return ((uint32_t) length * VERIFY_US_PER_ADDRESS + 999) / 1000;
+}
+
+bool requestVerify(SerialPort& port, const uint8_t& seq, const uint16_t& address, const uint16_t& length, const uint8_t& image,
+                   const int& waitMs, VerifyAnswer& answer) {
+
+    uint8_t payload[5];
+    writeUint16(payload, address);
+    writeUint16(payload + 2, length);
+    payload[4] = image;
+
+    FrameDecoder decoder;
+    bool answered = false;
+    bool received = false;
+    answer.mismatches.clear();
+    answer.nak = 0;
+
+    uint32_t durationMs = verifyDurationMs(length);
+
+    sendFrame(port, FRAME_VERIFY, seq, payload, sizeof(payload));
+    uint64_t lastActivity = hostMillis();
+    uint64_t lastRequest = lastActivity;
+    uint64_t giveUp = lastActivity + waitMs + durationMs;
+
+    /**
+     * The timeouts are checked for every byte, not only when nothing comes. A closed port or a programmer, which only prints text,
+     * must not keep the loop running.
+     * The blocks without a mismatch send nothing, so the gap between two VERIFY_MAP frames can be as long as the whole range.
+     */
+    while (true) {
+        int byte = port.readByte(10);
+        uint64_t now = hostMillis();
+
+        if (!answered && now >= giveUp)
+            return false;
+
+        if (answered && now - lastActivity > INACTIVITY_TIMEOUT_MS + durationMs)
+            return false;
+
+        if (byte < 0) {
+            if (!received && now - lastRequest > REQUEST_RETRY_MS + durationMs) {
+                sendFrame(port, FRAME_VERIFY, seq, payload, sizeof(payload));
+                lastRequest = now;
+            }
+
+            continue;
+        }
+
+        if (decoder.feed(byte) != FRAME_COMPLETE)
+            continue;
+
+        lastActivity = now;
+        received = true;
+
+        const Frame& frame = decoder.getFrame();
+
+        if (frame.seq != seq)
+            continue;
+
+        if (frame.type == FRAME_NAK) {
+            answer.nak = frame.length > 0 ? frame.payload[0] : NAK_LENGTH;
+            return false;
+        }
+
+        if (frame.type == FRAME_VERIFY_MAP && frame.length >= 2) {
+            answered = true;
+            uint16_t blockAddress = readUint16(frame.payload);
+
+            for (uint16_t bit = 0; bit < (frame.length - 2) * 8; ++bit) {
+                if (frame.payload[2 + bit / 8] & (0x80 >> (bit % 8)))
+                    answer.mismatches.push_back(blockAddress + bit);
+            }
+        } else if (frame.type == FRAME_VERIFY_END && frame.length >= 8) {
+            answer.length = readUint16(frame.payload);
+            answer.mismatchCount = readUint16(frame.payload + 2);
+            answer.crc = readUint32(frame.payload + 4);
+            return answer.length == length && answer.mismatchCount == answer.mismatches.size();
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef PROGRAMMER_CLIENT_H
+#define PROGRAMMER_CLIENT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "SerialPort.h"
+
+/**
+ * The host side of the upload and the verification (SerialProtocol.h), shared by eeprom_upload, eeprom_verify and eeprom_batch.
+ * Nothing is printed, the errors are returned, so several programmers can be served from their own threads at the same time.
+ */
+
+/**
+ * @param address Where the first byte of the image is written.
+ * @param packed, skipValue See fillDataFrame().
+ * @param waitMs How long to wait for the programmer to answer BEGIN (the Nano resets when the port is opened).
+ */
+struct UploadOptions {
+    uint32_t address;
+    bool packed;
+    int16_t skipValue;
+    int waitMs;
+};
+
+/**
+ * The counters are from the RESULT frame. @param error is empty if the programmer reported the result.
+ */
+struct UploadResult {
+    std::string error;
+    size_t frames;
+    size_t sentBytes;
+    uint64_t milliseconds;
+    uint16_t written;
+    uint16_t skipped;
+    uint16_t verified;
+    uint16_t failed;
+};
+
+/**
+ * @param mismatches The addresses from the VERIFY_MAP frames.
+ * @param nak The reason, if the programmer refused the request. 0 otherwise.
+ */
+struct VerifyAnswer {
+    uint16_t length;
+    uint16_t mismatchCount;
+    uint32_t crc;
+    uint8_t nak;
+    std::vector<uint16_t> mismatches;
+};
+
+/**
+ * BEGIN, the DATA (or DATA_PACKED) frames and END.
+ * @param seq The sequence of BEGIN. Afterwards the first one, which wasn't used.
+ * @return True if the programmer reported the result, even if some bytes failed.
+ */
+bool uploadImage(SerialPort& port, uint8_t& seq, const std::vector<uint8_t>& image, const UploadOptions& options, UploadResult& result);
+
+/**
+ * How long the programmer may need for a VERIFY of @param length addresses. It reads about 70000 addresses per second
+ * (board_benchmark), the estimate has a margin of three times that. Nothing is sent while the blocks match.
+ */
+uint32_t verifyDurationMs(const uint16_t& length);
+
+/**
+ * Sends VERIFY and receives the VERIFY_MAP frames until VERIFY_END.
+ * VERIFY is sent again only while nothing at all came back, once per verifyDurationMs(), so a long range isn't started again
+ * while the programmer still reads the first one.
+ * @param image One of the programmer's images or VERIFY_IMAGE_NONE for only the CRC32.
+ * @param waitMs How long to wait for the answer in addition to verifyDurationMs().
+ * @return False if the programmer doesn't answer or refuses the request (NAK).
+ */
+bool requestVerify(SerialPort& port, const uint8_t& seq, const uint16_t& address, const uint16_t& length, const uint8_t& image,
+                   const int& waitMs, VerifyAnswer& answer);
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef SAMPLE_PROGRAMS_H
+#define SAMPLE_PROGRAMS_H
+
+#include <stdint.h>
+#include <vector>
+
+#include <CPUEmulator.h>
+#include <InstructionSet.h>
+
+/**
+ * Programs for the emulator. Used by the benchmark and to compare the microcode before and after a change.
+ * Each RAM byte is {Instruction (4 bits)}{Address or value (4 bits)}.
+ * Each program has its expected result, so a microcode, which breaks both the old and the new images the same way, is found too.
+ * The result is what the microcode really does, the programs don't change the instruction set.
+ */
+
+#define PROGRAM(code, operand) (((code) << 4) | (operand))
+
+/**
+ * The program halts after @param outputs values on the output register. The first one is @param firstOutput and the last one @param lastOutput.
+ * @param busContentions The steps with more than one output to the bus, which the emulator must flag.
+ */
+struct SampleResult {
+    uint16_t outputs;
+    uint8_t firstOutput;
+    uint8_t lastOutput;
+    uint16_t busContentions;
+};
+
+struct SampleProgram {
+    const char* name;
+    SampleResult expected;
+    uint8_t ram[CPU_RAM_SIZE];
+};
+
+const SampleProgram SAMPLE_PROGRAMS[] = {
+
+        /**
+         * Outputs 7.
+         */
+        {"output", {1, 7, 7, 0},
+                   {PROGRAM(LDI_INSTRUCTION_CODE, 7),
+                    PROGRAM(OUT_INSTRUCTION_CODE, 0),
+                    PROGRAM(HLT_INSTRUCTION_CODE, 0)}},
+
+        /**
+         * Adds 28 and 14 in the address 13 and outputs it.
+         */
+        {"add", {1, 42, 42, 0},
+                {PROGRAM(LDA_INSTRUCTION_CODE, 14),
+                 PROGRAM(LDB_INSTRUCTION_CODE, 15),
+                 PROGRAM(ADD_INSTRUCTION_CODE, 13),
+                 PROGRAM(LDA_INSTRUCTION_CODE, 13),
+                 PROGRAM(OUT_INSTRUCTION_CODE, 0),
+                 PROGRAM(HLT_INSTRUCTION_CODE, 0),
+                 0, 0, 0, 0, 0, 0, 0, 0, 28, 14}},
+
+        /**
+         * Counts from 1 up to 255 and 0 in the address 15 (256 outputs). Stops on the carry.
+         */
+        {"count", {256, 1, 0, 0},
+                  {PROGRAM(LDI_INSTRUCTION_CODE, 0),
+                   PROGRAM(STA_INSTRUCTION_CODE, 15),
+                   PROGRAM(LDA_INSTRUCTION_CODE, 15),
+                   PROGRAM(LDB_INSTRUCTION_CODE, 14),
+                   PROGRAM(ADD_INSTRUCTION_CODE, 15),
+                   PROGRAM(LDA_INSTRUCTION_CODE, 15),
+                   PROGRAM(OUT_INSTRUCTION_CODE, 0),
+                   PROGRAM(JC_INSTRUCTION_CODE, 9),
+                   PROGRAM(JMP_INSTRUCTION_CODE, 2),
+                   PROGRAM(HLT_INSTRUCTION_CODE, 0),
+                   0, 0, 0, 0, 1, 0}},
+
+        /**
+         * 50 - 8. SUB enables RO and EO in the same step like programSecondEEPROM() always did, so the bus has two outputs,
+         * nothing loads B and A gets the empty bus. The emulator must flag the contention and the output is 0, not 42.
+         */
+        {"subtract", {1, 0, 0, 1},
+                     {PROGRAM(LDA_INSTRUCTION_CODE, 14),
+                      PROGRAM(SUB_INSTRUCTION_CODE, 15),
+                      PROGRAM(OUT_INSTRUCTION_CODE, 0),
+                      PROGRAM(HLT_INSTRUCTION_CODE, 0),
+                      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 50, 8}}
+};
+
+#define SAMPLE_PROGRAM_COUNT (sizeof(SAMPLE_PROGRAMS) / sizeof(SAMPLE_PROGRAMS[0]))
+
+/**
+ * True if the @param cpu halted with the expected result of the @param program.
+ */
+inline bool hasExpectedResult(const CPUEmulator& cpu, const SampleProgram& program) {
+
+    const std::vector<uint8_t>& outputs = cpu.getOutputs();
+
+    return cpu.getState().halted && outputs.size() == program.expected.outputs && !outputs.empty() &&
+           outputs.front() == program.expected.firstOutput && outputs.back() == program.expected.lastOutput &&
+           cpu.getBusContentions() == program.expected.busContentions;
+}
+
+#endif
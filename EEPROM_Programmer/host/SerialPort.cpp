@@ -0,0 +1,243 @@
+#include "SerialPort.h"
+
+#include <PackedImage.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+static speed_t toSpeed(const uint32_t& baudRate) {
+
+    switch (baudRate) {
+        case 9600:
+            return B9600;
+        case 19200:
+            return B19200;
+        case 38400:
+            return B38400;
+        case 57600:
+            return B57600;
+        case 115200:
+            return B115200;
+        case 230400:
+            return B230400;
+#ifdef B500000
+        case 500000:
+            return B500000;
+#endif
+#ifdef B1000000
+        case 1000000:
+            return B1000000;
+#endif
+        default:
+            return 0;
+    }
+}
+
+SerialPort::SerialPort() : fd(-1) {
+}
+
+SerialPort::~SerialPort() {
+    close();
+}
+
+bool SerialPort::open(const std::string& path, const uint32_t& baudRate) {
+
+    close();
+
+    speed_t speed = toSpeed(baudRate);
+
+    if (speed == 0)
+        return false;
+
+    fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+    if (fd < 0)
+        return false;
+
+    termios options;
+
+    if (tcgetattr(fd, &options) != 0) {
+        close();
+        return false;
+    }
+
+    cfmakeraw(&options);
+    options.c_cflag |= CLOCAL | CREAD;
+    options.c_cflag &= ~CSTOPB;
+#ifdef CRTSCTS
+    options.c_cflag &= ~CRTSCTS;
+#endif
+    options.c_cc[VMIN] = 0;
+    options.c_cc[VTIME] = 0;
+    cfsetispeed(&options, speed);
+    cfsetospeed(&options, speed);
+
+    if (tcsetattr(fd, TCSANOW, &options) != 0) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void SerialPort::close() {
+
+    if (fd >= 0)
+        ::close(fd);
+
+    fd = -1;
+}
+
+bool SerialPort::isOpen() const {
+    return fd >= 0;
+}
+
+bool SerialPort::write(const uint8_t* bytes, const size_t& length) {
+
+    size_t written = 0;
+
+    while (written < length) {
+        ssize_t result = ::write(fd, bytes + written, length - written);
+
+        if (result > 0) {
+            written += result;
+            continue;
+        }
+
+        /**
+         * For example EIO, when the other side of a pseudo terminal is closed. Then poll() returns at once and the loop would never end.
+         */
+        if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            return false;
+
+        pollfd waitFor = {fd, POLLOUT, 0};
+
+        if (::poll(&waitFor, 1, 1000) <= 0)
+            return false;
+    }
+
+    return true;
+}
+
+int SerialPort::readByte(const int& timeoutMs) {
+
+    uint8_t byte;
+
+    if (::read(fd, &byte, 1) == 1)
+        return byte;
+
+    pollfd waitFor = {fd, POLLIN, 0};
+
+    if (::poll(&waitFor, 1, timeoutMs) <= 0)
+        return -1;
+
+    if (::read(fd, &byte, 1) == 1)
+        return byte;
+
+    return -1;
+}
+
+void SerialPort::flushInput() {
+    tcflush(fd, TCIFLUSH);
+}
+
+int SerialPort::getFd() const {
+    return fd;
+}
+
+uint64_t hostMillis() {
+    return hostMicros() / 1000;
+}
+
+uint64_t hostMicros() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool sendFrame(SerialPort& port, const uint8_t& type, const uint8_t& seq, const uint8_t* payload, const uint8_t& length) {
+    uint8_t out[FRAME_MAX_LENGTH];
+    uint8_t outLength = encodeFrame(type, seq, payload, length, out);
+    return port.write(out, outLength);
+}
+
+bool receiveFrame(SerialPort& port, FrameDecoder& decoder, Frame& frame, const int& timeoutMs) {
+
+    uint64_t deadline = hostMillis() + timeoutMs;
+
+    while (true) {
+        int64_t remaining = (int64_t) deadline - (int64_t) hostMillis();
+
+        if (remaining <= 0)
+            return false;
+
+        int byte = port.readByte(remaining);
+
+        if (byte < 0)
+            continue;
+
+        if (decoder.feed(byte) == FRAME_COMPLETE) {
+            frame = decoder.getFrame();
+            return true;
+        }
+    }
+}
+
+bool exchangeFrame(SerialPort& port, FrameDecoder& decoder, const uint8_t& type, const uint8_t& seq,
+                   const uint8_t* payload, const uint8_t& length, const uint8_t& expectedType, Frame& answer,
+                   const int& answerTimeoutMs, const int& attempts) {
+
+    for (int attempt = 0; attempt < attempts; ++attempt) {
+
+        if (!sendFrame(port, type, seq, payload, length))
+            return false;
+
+        uint64_t deadline = hostMillis() + answerTimeoutMs;
+
+        while (true) {
+            int64_t remaining = (int64_t) deadline - (int64_t) hostMillis();
+
+            if (remaining <= 0 || !receiveFrame(port, decoder, answer, remaining))
+                break;
+
+            if (answer.seq != seq)
+                continue;
+
+            if (answer.type == expectedType)
+                return true;
+
+            if (answer.type == FRAME_NAK)
+                break;
+        }
+
+        decoder.reset();
+    }
+
+    return false;
+}
+
+uint8_t fillDataFrame(const uint8_t* image, const uint32_t& length, const uint16_t& address, const bool& packed, const int16_t& skipValue,
+                      uint8_t* payload, uint8_t& payloadLength, uint32_t& consumed) {
+
+    uint16_t rawLength = length < FRAME_MAX_DATA ? length : FRAME_MAX_DATA;
+    writeUint16(payload, address);
+
+    if (packed) {
+        uint16_t packedLength;
+        consumed = packImageChunk(image, length, skipValue, payload + 2, FRAME_MAX_DATA, packedLength);
+
+        if (consumed > rawLength || (consumed == rawLength && packedLength < rawLength)) {
+            payloadLength = 2 + packedLength;
+            return FRAME_DATA_PACKED;
+        }
+    }
+
+    memcpy(payload + 2, image, rawLength);
+    payloadLength = 2 + rawLength;
+    consumed = rawLength;
+    return FRAME_DATA;
+}
@@ -0,0 +1,86 @@
+#ifndef SERIAL_PORT_H
+#define SERIAL_PORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <SerialProtocol.h>
+
+/**
+ * Raw serial port on the host (Linux / POSIX).
+ * The port is in raw mode, 8N1, without flow control.
+ */
+class SerialPort {
+
+public:
+
+    SerialPort();
+
+    ~SerialPort();
+
+    /**
+     * Opens a serial device (/dev/ttyUSB0) or a pseudo terminal (/dev/pts/3).
+     * @param baudRate One of the standard rates (9600 ... 1000000).
+     */
+    bool open(const std::string& path, const uint32_t& baudRate);
+
+    void close();
+
+    bool isOpen() const;
+
+    bool write(const uint8_t* bytes, const size_t& length);
+
+    /**
+     * @return The byte or -1 if nothing came in @param timeoutMs.
+     */
+    int readByte(const int& timeoutMs);
+
+    /**
+     * Discards everything that was received and not read yet.
+     */
+    void flushInput();
+
+    int getFd() const;
+
+private:
+
+    int fd;
+};
+
+/**
+ * Milliseconds from a fixed point in time. Only for measuring intervals.
+ */
+uint64_t hostMillis();
+
+uint64_t hostMicros();
+
+/**
+ * Sends a frame of the serial protocol.
+ */
+bool sendFrame(SerialPort& port, const uint8_t& type, const uint8_t& seq, const uint8_t* payload, const uint8_t& length);
+
+/**
+ * Waits until a whole valid frame is received. Broken frames and bytes outside of frames are skipped.
+ * @return False if no frame came in @param timeoutMs.
+ */
+bool receiveFrame(SerialPort& port, FrameDecoder& decoder, Frame& frame, const int& timeoutMs);
+
+/**
+ * Sends the frame and waits for an answer with the same sequence number and one of the expected types.
+ * A NAK or a timeout sends the frame again, up to @param attempts times.
+ * @param answerTimeoutMs How long to wait for an answer after each send.
+ */
+bool exchangeFrame(SerialPort& port, FrameDecoder& decoder, const uint8_t& type, const uint8_t& seq,
+                   const uint8_t* payload, const uint8_t& length, const uint8_t& expectedType, Frame& answer,
+                   const int& answerTimeoutMs, const int& attempts);
+
+/**
+ * Fills the payload of the next upload frame with the @param image from @param address (the address is the first 2 bytes).
+ * With @param packed the records of PackedImage.h are used, unless a plain DATA frame would cover more addresses (bytes without runs).
+ * @param consumed How many bytes of the image the frame covers.
+ * @return FRAME_DATA or FRAME_DATA_PACKED
+ */
+uint8_t fillDataFrame(const uint8_t* image, const uint32_t& length, const uint16_t& address, const bool& packed, const int16_t& skipValue,
+                      uint8_t* payload, uint8_t& payloadLength, uint32_t& consumed);
+
+#endif
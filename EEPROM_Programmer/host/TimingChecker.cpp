@@ -0,0 +1,151 @@
+#include "TimingChecker.h"
+
+#include <cstdio>
+
+const char* WRITE_TIMING_NAMES[WRITE_TIMING_COUNT] = {"tAS", "tAH", "tWP", "tWPH", "tDS", "tOES"};
+
+/**
+ * Time of the last edge of a signal. known is false until the edge is seen in the trace.
+ */
+struct Edge {
+    bool known;
+    uint64_t ns;
+
+    void set(const uint64_t& time) {
+        known = true;
+        ns = time;
+    }
+};
+
+static void measure(WriteTimingReport& report, const EEPROMWriteTiming& timing, const uint8_t& parameter, const Edge& from, const uint64_t& ns) {
+
+    if (!from.known)
+        return;
+
+    uint64_t actualNs = ns - from.ns;
+
+    if (report.measured[parameter] == 0 || actualNs < report.smallestNs[parameter])
+        report.smallestNs[parameter] = actualNs;
+
+    report.measured[parameter]++;
+
+    if (actualNs < timing.minimumNs[parameter]) {
+        TimingViolation violation = {ns, parameter, actualNs, false};
+        report.violations.push_back(violation);
+    }
+}
+
+static void violate(WriteTimingReport& report, const uint8_t& parameter, const uint64_t& ns) {
+    TimingViolation violation = {ns, parameter, 0, true};
+    report.violations.push_back(violation);
+}
+
+WriteTimingReport checkWriteTiming(const std::vector<TimedPinEvent>& events, const EEPROMWriteTiming& timing) {
+
+    WriteTimingReport report;
+    report.writes = 0;
+
+    for (uint8_t i = 0; i < WRITE_TIMING_COUNT; ++i) {
+        report.measured[i] = 0;
+        report.smallestNs[i] = 0;
+    }
+
+    Edge addressChanged = {false, 0};
+    Edge dataChanged = {false, 0};
+    Edge outputDisabled = {false, 0};
+    Edge writeFalling = {false, 0};
+    Edge writeRising = {false, 0};
+    uint8_t outputEnable = PIN_TRACE_NONE;
+    bool dataDriven = false;
+    bool writing = false;
+    bool addressHeld = false;
+
+    for (size_t i = 0; i < events.size(); ++i) {
+        const TimedPinEvent& event = events[i];
+
+        switch (event.signal) {
+
+            case PIN_TRACE_RCLK:
+                if (!event.value)
+                    break;
+
+                if (addressHeld)
+                    measure(report, timing, WRITE_TIMING_AH, writeFalling, event.ns);
+
+                addressHeld = false;
+                addressChanged.set(event.ns);
+                break;
+
+            case PIN_TRACE_OE:
+                outputEnable = event.value;
+
+                if (outputEnable)
+                    outputDisabled.set(event.ns);
+                break;
+
+            case PIN_TRACE_IO:
+            case PIN_TRACE_IO_RELEASED:
+                dataDriven = event.signal == PIN_TRACE_IO;
+                dataChanged.set(event.ns);
+                break;
+
+            case PIN_TRACE_WE:
+                if (!event.value && !writing) {
+                    writing = true;
+                    report.writes++;
+
+                    measure(report, timing, WRITE_TIMING_AS, addressChanged, event.ns);
+                    measure(report, timing, WRITE_TIMING_WPH, writeRising, event.ns);
+
+                    if (outputEnable == LOW)
+                        violate(report, WRITE_TIMING_OES, event.ns);
+                    else
+                        measure(report, timing, WRITE_TIMING_OES, outputDisabled, event.ns);
+
+                    writeFalling.set(event.ns);
+                    addressHeld = true;
+                } else if (event.value && writing) {
+                    writing = false;
+
+                    measure(report, timing, WRITE_TIMING_WP, writeFalling, event.ns);
+
+                    if (dataDriven)
+                        measure(report, timing, WRITE_TIMING_DS, dataChanged, event.ns);
+                    else if (dataChanged.known)
+                        violate(report, WRITE_TIMING_DS, event.ns);
+
+                    writeRising.set(event.ns);
+                } else if (event.value) {
+                    writeRising.set(event.ns);
+                }
+                break;
+        }
+    }
+
+    return report;
+}
+
+void printWriteTimingReport(const WriteTimingReport& report, const EEPROMWriteTiming& timing, const size_t& maxViolations) {
+
+    printf("Writes: %u, timing violations: %zu\n", report.writes, report.violations.size());
+    printf("%-10s %10s %12s %10s\n", "Parameter", "Min (ns)", "Smallest", "Measured");
+
+    for (uint8_t i = 0; i < WRITE_TIMING_COUNT; ++i) {
+        if (report.measured[i] == 0)
+            printf("%-10s %10u %12s %10u\n", WRITE_TIMING_NAMES[i], timing.minimumNs[i], "-", 0);
+        else
+            printf("%-10s %10u %12llu %10u\n", WRITE_TIMING_NAMES[i], timing.minimumNs[i], (unsigned long long) report.smallestNs[i], report.measured[i]);
+    }
+
+    for (size_t i = 0; i < report.violations.size() && i < maxViolations; ++i) {
+        const TimingViolation& violation = report.violations[i];
+
+        if (violation.wrongLevel && violation.parameter == WRITE_TIMING_OES)
+            printf("Violation at %llu ns: OE is active while WE falls\n", (unsigned long long) violation.ns);
+        else if (violation.wrongLevel)
+            printf("Violation at %llu ns: the data bus is not driven while WE rises\n", (unsigned long long) violation.ns);
+        else
+            printf("Violation at %llu ns: %s is %llu ns, the minimum is %u ns\n", (unsigned long long) violation.ns,
+                   WRITE_TIMING_NAMES[violation.parameter], (unsigned long long) violation.actualNs, timing.minimumNs[violation.parameter]);
+    }
+}
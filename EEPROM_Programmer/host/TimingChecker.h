@@ -0,0 +1,79 @@
+#ifndef TIMING_CHECKER_H
+#define TIMING_CHECKER_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "PinTraceFiles.h"
+
+/**
+ * Checks a pin trace against the EEPROM's write timing (WE controlled write):
+ *
+ *              tAS    tAH
+ * Address  ==X=====|=====X=========== (changes on the rising edge of RCLK)
+ * OE       --------|----------------- (must be HIGH before WE falls - tOES)
+ * WE       --------\_____________/---
+ *                  |<--- tWP --->|<- tWPH (until the next falling edge)
+ * IO       ====X=================X=== (driven by the programmer)
+ *              |<---- tDS ------>|
+ *
+ * The address and the data are latched by the EEPROM on the falling and rising edge of WE.
+ * The propagation delay of the 74HC595 (~20ns) is not in the trace, it only makes tAS shorter and tAH longer.
+ */
+
+#define WRITE_TIMING_AS 0
+#define WRITE_TIMING_AH 1
+#define WRITE_TIMING_WP 2
+#define WRITE_TIMING_WPH 3
+#define WRITE_TIMING_DS 4
+#define WRITE_TIMING_OES 5
+#define WRITE_TIMING_COUNT 6
+
+/**
+ * The minimums in nanoseconds, indexed by WRITE_TIMING_*.
+ */
+struct EEPROMWriteTiming {
+    uint32_t minimumNs[WRITE_TIMING_COUNT];
+};
+
+/**
+ * AT28C16 datasheet, 5V.
+ */
+constexpr EEPROMWriteTiming AT28C16_WRITE_TIMING = {{10, 50, 100, 50, 50, 10}};
+
+extern const char* WRITE_TIMING_NAMES[WRITE_TIMING_COUNT];
+
+/**
+ * @param ns Time of the edge, where the parameter was measured.
+ * @param wrongLevel The signal was in a wrong state (OE active or the data bus not driven during the write), so there is no actualNs.
+ */
+struct TimingViolation {
+    uint64_t ns;
+    uint8_t parameter;
+    uint64_t actualNs;
+    bool wrongLevel;
+};
+
+/**
+ * @param measured Number of measurements of each parameter.
+ * @param smallestNs The smallest measured value of each parameter. It shows how much the timing can still be pushed.
+ */
+struct WriteTimingReport {
+    uint32_t writes;
+    uint32_t measured[WRITE_TIMING_COUNT];
+    uint64_t smallestNs[WRITE_TIMING_COUNT];
+    std::vector<TimingViolation> violations;
+};
+
+/**
+ * The trace can start in the middle of the activity (the ring buffer of the Nano), thus a parameter is measured
+ * only when both of its edges are in the trace.
+ */
+WriteTimingReport checkWriteTiming(const std::vector<TimedPinEvent>& events, const EEPROMWriteTiming& timing = AT28C16_WRITE_TIMING);
+
+/**
+ * Prints the smallest measured values and the first @param maxViolations violations.
+ */
+void printWriteTimingReport(const WriteTimingReport& report, const EEPROMWriteTiming& timing = AT28C16_WRITE_TIMING, const size_t& maxViolations = 10);
+
+#endif
@@ -0,0 +1,549 @@
+/**
+ * Runs the programmer's drivers (ShiftRegister, EEPROMProgrammer) on the simulated board (SimulatedBoard.h)
+ * and reports the pin toggles and the simulated time of the Nano per written or read byte, and the reads per second of the readback.
+ * The numbers are deterministic, so they can be compared between two versions of the drivers.
+ *
+ * Usage:
+ * board_benchmark [--chip NAME] [--spi] [--write-cycle-us N] [--write-pulse-us N] [--clock-mhz N] [--max-write-us X] [--max-read-us X]
+ *                 [--trace out.vcd] [--trace-limit N] [--dual] [--perf]
+ *
+ * --chip The simulated EEPROM - 28C16 (default), 28C64 or 28C256. The bigger ones are also written a page at a time.
+ * --spi The shift registers are driven by the hardware SPI instead of bit bang.
+ * --write-cycle-us The internal write cycle of the simulated EEPROM (tWC). Default the chip's maximum (ChipProfile.h).
+ * --write-pulse-us The WE pulse of the programmer. Default EEPROM_WRITE_PULSE_US.
+ * --clock-mhz The CPU clock of the simulated Nano. Default 16. A faster one shows where the timing would break.
+ * --max-write-us, --max-read-us Exit with 1 if a polled write (range read) takes more simulated microseconds per byte. For CI.
+ * --trace The pins are traced (TracingHAL.h) and saved as VCD. The trace is checked against the AT28C16's write timing
+ *         and a violation exits with 1.
+ * --trace-limit How many events are traced from the start. Default 100000.
+ * --dual A second chip is attached (the second socket of EEPROMProgrammer) and both of them are written one after another
+ *        and then together with programEEPROMPairBytes(). The second OE is right above the first one, so the 28C256 would need a third register.
+ * --perf The operations of the drivers are measured (ProfilingHAL.h) and printed at the end as CSV, the same as perf_stats
+ *        prints for the Nano. The measurement itself costs some simulated cycles (micros() of the long operations).
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <SimulatedBoard.h>
+#include <ShiftRegister.h>
+#include <EEPROMProgrammer.h>
+#include <TracingHAL.h>
+#include <ProfilingHAL.h>
+
+#include "PerfReport.h"
+#include "PinTraceFiles.h"
+#include "TimingChecker.h"
+
+/**
+ * The wiring of the programmer (main.cpp).
+ */
+#define EEPROM_WE_PIN 13
+#define EEPROM_SECOND_WE_PIN 14
+#define SHIFT_REGISTER_SER_PIN 2
+#define SHIFT_REGISTER_RCLK_PIN 3
+#define SHIFT_REGISTER_SR_CLK_PIN 4
+#define SHIFT_REGISTER_CHAIN_LENGTH 2
+
+#define READ_CHUNK_LENGTH 32
+#define FALLBACK_LENGTH 256
+#define FALLBACK_TIMEOUT_US 1000
+#define DEFAULT_TRACE_LIMIT 100000
+
+static void printUsage() {
+    fprintf(stderr, "Usage: board_benchmark [--chip NAME] [--spi] [--write-cycle-us N] [--write-pulse-us N] [--clock-mhz N] [--max-write-us X] [--max-read-us X]\n"
+                    "                       [--trace out.vcd] [--trace-limit N] [--dual] [--perf]\n");
+}
+
+static SimulatedBoardCounters difference(const SimulatedBoardCounters& after, const SimulatedBoardCounters& before) {
+    SimulatedBoardCounters counters = {after.cycles - before.cycles,
+                                       after.pinToggles - before.pinToggles,
+                                       after.shiftClocks - before.shiftClocks,
+                                       after.latches - before.latches,
+                                       after.dataBusWrites - before.dataBusWrites,
+                                       after.dataBusReads - before.dataBusReads,
+                                       after.writePulses - before.writePulses,
+                                       after.inhibitedWrites - before.inhibitedWrites,
+                                       after.busContentions - before.busContentions};
+    return counters;
+}
+
+/**
+ * The same bytes on each run, which are different from the erased 0xFF (most of them).
+ */
+static std::vector<uint8_t> generateImage(const uint32_t& size) {
+
+    std::vector<uint8_t> image(size);
+    uint32_t seed = 0x2816;
+
+    for (size_t i = 0; i < image.size(); ++i) {
+        seed = seed * 1103515245 + 12345;
+        image[i] = seed >> 16;
+    }
+
+    return image;
+}
+
+static bool eepromMatches(SimulatedEEPROM& eeprom, const std::vector<uint8_t>& image) {
+
+    for (size_t address = 0; address < image.size(); ++address) {
+        if (eeprom.peek(address) != image[address])
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Writes, which the EEPROM didn't take - loaded too late (tBLC) or outside of the loaded page.
+ */
+static uint32_t eepromErrors(const SimulatedEEPROM& eeprom) {
+    return eeprom.getIgnoredWrites() + eeprom.getPageBoundaryErrors();
+}
+
+/**
+ * @param eepromErrors The difference of eepromErrors() during the scenario.
+ * @return Simulated microseconds per byte.
+ */
+static double printScenario(const SimulatedBoard& board, const char* name, const SimulatedBoardCounters& counters, const uint32_t& eepromErrors,
+                            const uint32_t& size, const bool& ok) {
+
+    double usPerByte = board.cyclesToMicros(counters.cycles) / size;
+
+    printf("%-24s %10.1f %10.2f %12.1f %8u %12u %8s\n", name, (double) counters.pinToggles / size, usPerByte,
+           board.cyclesToMicros(counters.cycles) / 1000, counters.dataBusReads, counters.busContentions + counters.inhibitedWrites + eepromErrors,
+           ok && eepromErrors == 0 ? "ok" : "FAILED");
+
+    return usPerByte;
+}
+
+/**
+ * The expected data of verifyEEPROMRange().
+ */
+struct VectorImage {
+    const std::vector<uint8_t>& data;
+
+    uint8_t operator()(const uint16_t& address) const {
+        return data[address];
+    }
+};
+
+struct BenchmarkOptions {
+    ChipProfile chip;
+    bool spi;
+    bool dual;
+    int writePulseUs;
+    double maxWriteUs;
+    double maxReadUs;
+};
+
+/**
+ * Runs all of the scenarios through the @param hal, which is the simulated @param board or the tracing HAL around it.
+ * @return False if the EEPROM's content is wrong or a limit was exceeded.
+ */
+template<typename HAL>
+static bool runScenarios(HAL& hal, SimulatedBoard& board, const BenchmarkOptions& options) {
+
+    SimulatedEEPROM& eeprom = board.getEEPROM();
+
+    ShiftRegister<HAL> bitBang(hal, SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN, SHIFT_REGISTER_CHAIN_LENGTH);
+    ShiftRegister<HAL> hardwareSpi(hal, SHIFT_REGISTER_RCLK_PIN, SHIFT_REGISTER_CHAIN_LENGTH);
+
+    WriteCycleConfig polling = {WRITE_CYCLE_DATA_POLLING | WRITE_CYCLE_TOGGLE_BIT, WRITE_CYCLE_DEFAULT_TIMEOUT_US, WRITE_CYCLE_DEFAULT_FALLBACK_DELAY_MS};
+    uint16_t fixedDelayMs = std::max<uint16_t>(WRITE_CYCLE_DEFAULT_FALLBACK_DELAY_MS, writeCycleDelayMs(options.chip));
+    WriteCycleConfig fixedDelay = {WRITE_CYCLE_FIXED_DELAY, WRITE_CYCLE_DEFAULT_TIMEOUT_US, fixedDelayMs};
+
+    EEPROMProgrammer<HAL> programmer(hal, options.spi ? hardwareSpi : bitBang, EEPROM_WE_PIN, polling, PROGRAMMING_FULL, options.chip);
+
+    if (options.dual)
+        programmer.setSecondSocket(EEPROM_SECOND_WE_PIN, options.chip.outputEnableBit + 1);
+
+    programmer.begin();
+
+    if (options.writePulseUs >= 0)
+        programmer.setWritePulseUs(options.writePulseUs);
+
+    uint32_t size = chipSize(options.chip);
+    std::vector<uint8_t> image = generateImage(size);
+    std::vector<uint8_t> buffer(size);
+    SimulatedBoardCounters before;
+    uint32_t errorsBefore;
+    bool ok = true;
+
+    printf("%-24s %10s %10s %12s %8s %12s %8s\n", "Scenario", "Toggles/B", "us/B", "Total ms", "Reads", "Bus errors", "Result");
+
+    /**
+     * Full write of an erased chip, the end of each write cycle is polled.
+     */
+    before = board.getCounters();
+    errorsBefore = eepromErrors(eeprom);
+    programmer.beginProgramming();
+
+    for (uint32_t address = 0; address < size; ++address)
+        programmer.programEEPROMAddressData(address, image[address]);
+
+    bool written = programmer.getStats().failed == 0 && eepromMatches(eeprom, image);
+    double writeUs = printScenario(board, "write, polling", difference(board.getCounters(), before), eepromErrors(eeprom) - errorsBefore, size, written);
+    ok = ok && written;
+
+    /**
+     * The same a page at a time (one write cycle for up to 64 bytes). Only the 28C64 and 28C256 have it.
+     */
+    if (hasPageWrite(options.chip)) {
+        eeprom.fill(0xFF);
+        before = board.getCounters();
+        errorsBefore = eepromErrors(eeprom);
+        programmer.beginProgramming();
+
+        for (uint32_t address = 0; address < size;)
+            address += programmer.programEEPROMBytes(address, &image[address], options.chip.pageSize);
+
+        written = programmer.getStats().failed == 0 && eepromMatches(eeprom, image);
+        printScenario(board, "write, page", difference(board.getCounters(), before), eepromErrors(eeprom) - errorsBefore, size, written);
+        ok = ok && written;
+    }
+
+    /**
+     * The same without blocking, like the serial upload (SerialSession.h). During the write cycle the next address is prepared
+     * in the shift registers, so after it only RCLK is pulsed. The last byte of each cycle is verified by the polling itself.
+     * Each poll, which finds the chip still busy, is a chance for the loop() to do something else (Scheduler.h).
+     */
+    eeprom.fill(0xFF);
+    before = board.getCounters();
+    errorsBefore = eepromErrors(eeprom);
+    programmer.beginProgramming();
+    uint32_t freePolls = 0;
+    uint32_t writeCyclesBefore = eeprom.getWriteCycles();
+
+    for (uint32_t address = 0; address < size;) {
+        uint8_t count = programmer.startEEPROMBytes(address, &image[address], options.chip.pageSize);
+        bool prepared = false;
+
+        while (!programmer.pollEEPROMBytes()) {
+            freePolls++;
+
+            if (!prepared && address + count < size) {
+                programmer.prepareEEPROMBytes(address + count);
+                prepared = true;
+            }
+        }
+
+        address += count;
+    }
+
+    written = programmer.getStats().failed == 0 && eepromMatches(eeprom, image);
+    printScenario(board, "write, pipelined", difference(board.getCounters(), before), eepromErrors(eeprom) - errorsBefore, size, written);
+    printf("%-24s %10.1f free polls per write cycle\n", "", (double) freePolls / (eeprom.getWriteCycles() - writeCyclesBefore));
+    ok = ok && written;
+
+    /**
+     * Two chips (for example the two halves of the microcode). First each one on its own, then both on the same address setup
+     * with overlapping write cycles. The image of the second chip is the first one reversed.
+     */
+    if (options.dual) {
+        SimulatedEEPROM& second = board.getEEPROM(EEPROM_SOCKET_SECOND);
+        std::vector<uint8_t> secondImage(image.rbegin(), image.rend());
+        const std::vector<uint8_t>* images[2] = {&image, &secondImage};
+
+        eeprom.fill(0xFF);
+        second.fill(0xFF);
+        before = board.getCounters();
+        errorsBefore = eepromErrors(eeprom) + eepromErrors(second);
+        programmer.beginProgramming();
+
+        for (uint8_t socket = 0; socket < 2; ++socket) {
+            programmer.selectSocket(socket);
+
+            for (uint32_t address = 0; address < size;)
+                address += programmer.programEEPROMBytes(address, &(*images[socket])[address], options.chip.pageSize);
+        }
+
+        programmer.selectSocket(EEPROM_SOCKET_FIRST);
+        written = programmer.getStats().failed == 0 && eepromMatches(eeprom, image) && eepromMatches(second, secondImage);
+        printScenario(board, "write 2 chips, one by one", difference(board.getCounters(), before),
+                      eepromErrors(eeprom) + eepromErrors(second) - errorsBefore, size, written);
+        ok = ok && written;
+
+        eeprom.fill(0xFF);
+        second.fill(0xFF);
+        before = board.getCounters();
+        errorsBefore = eepromErrors(eeprom) + eepromErrors(second);
+        programmer.beginProgramming();
+
+        for (uint32_t address = 0; address < size;)
+            address += programmer.programEEPROMPairBytes(address, &image[address], &secondImage[address], options.chip.pageSize);
+
+        written = programmer.getStats().failed == 0 && programmer.getStats().written == 2 * size && eepromMatches(eeprom, image) &&
+                  eepromMatches(second, secondImage);
+        printScenario(board, "write 2 chips, pair", difference(board.getCounters(), before),
+                      eepromErrors(eeprom) + eepromErrors(second) - errorsBefore, size, written);
+        ok = ok && written;
+    }
+
+    /**
+     * The same with the old fixed delay after each byte.
+     */
+    eeprom.fill(0xFF);
+    programmer.setWriteCycleConfig(fixedDelay);
+    before = board.getCounters();
+    errorsBefore = eepromErrors(eeprom);
+    programmer.beginProgramming();
+
+    for (uint32_t address = 0; address < size; ++address)
+        programmer.programEEPROMAddressData(address, image[address]);
+
+    written = programmer.getStats().failed == 0 && eepromMatches(eeprom, image);
+    printScenario(board, "write, fixed delay", difference(board.getCounters(), before), eepromErrors(eeprom) - errorsBefore, size, written);
+    ok = ok && written;
+
+    /**
+     * A chip without DATA# polling and toggle bit, whose write cycle is longer than the polling timeout. Each pipelined write
+     * must time out, fall back to the fixed delay and still verify, so it takes between the timeout and the timeout plus the delay
+     * (and the overhead of a polled write). Only the first bytes, because each one takes milliseconds.
+     * They hold the complement of the image first, so the old data never looks like the written one.
+     */
+    uint32_t fallbackLength = std::min<uint32_t>(size, FALLBACK_LENGTH);
+    WriteCycleConfig timingOut = {polling.methods, FALLBACK_TIMEOUT_US, fixedDelayMs};
+    uint32_t writeCycleUs = eeprom.getWriteCycleUs();
+
+    for (uint32_t address = 0; address < fallbackLength; ++address)
+        programmer.programEEPROMAddressData(address, ~image[address]);
+
+    programmer.setWriteCycleConfig(timingOut);
+    eeprom.setDataPolling(false);
+    eeprom.setToggleBit(false);
+    eeprom.setWriteCycleUs((uint32_t) fixedDelayMs * 1000);
+    before = board.getCounters();
+    errorsBefore = eepromErrors(eeprom);
+    programmer.beginProgramming();
+
+    for (uint32_t address = 0; address < fallbackLength; ++address) {
+        programmer.startEEPROMBytes(address, &image[address], 1);
+
+        while (!programmer.pollEEPROMBytes()) {
+        }
+    }
+
+    SimulatedBoardCounters fallbackCounters = difference(board.getCounters(), before);
+    double fallbackUs = board.cyclesToMicros(fallbackCounters.cycles) / fallbackLength;
+    written = programmer.getStats().failed == 0 && eepromMatches(eeprom, image) && fallbackUs >= FALLBACK_TIMEOUT_US &&
+              fallbackUs <= FALLBACK_TIMEOUT_US + fixedDelayMs * 1000 + writeUs;
+    printScenario(board, "write, timeout fallback", fallbackCounters, eepromErrors(eeprom) - errorsBefore, fallbackLength, written);
+    ok = ok && written;
+
+    eeprom.setDataPolling(true);
+    eeprom.setToggleBit(true);
+    eeprom.setWriteCycleUs(writeCycleUs);
+
+    /**
+     * Programming the same image again. Each byte is only read.
+     */
+    programmer.setWriteCycleConfig(polling);
+    programmer.setProgrammingMode(PROGRAMMING_DIFFERENTIAL);
+    before = board.getCounters();
+    errorsBefore = eepromErrors(eeprom);
+    programmer.beginProgramming();
+
+    for (uint32_t address = 0; address < size; ++address)
+        programmer.programEEPROMAddressData(address, image[address]);
+
+    written = programmer.getStats().skipped == size && eepromMatches(eeprom, image);
+    printScenario(board, "rewrite, differential", difference(board.getCounters(), before), eepromErrors(eeprom) - errorsBefore, size, written);
+    ok = ok && written;
+
+    /**
+     * Dump in chunks like the "dump" command.
+     */
+    before = board.getCounters();
+    errorsBefore = eepromErrors(eeprom);
+
+    for (uint32_t address = 0; address < size; address += READ_CHUNK_LENGTH)
+        programmer.readEEPROMRange(address, &buffer[address], READ_CHUNK_LENGTH);
+
+    bool read = buffer == image;
+    double readUs = printScenario(board, "read, range", difference(board.getCounters(), before), eepromErrors(eeprom) - errorsBefore, size, read);
+    ok = ok && read;
+
+    before = board.getCounters();
+    errorsBefore = eepromErrors(eeprom);
+
+    for (uint32_t address = 0; address < size; ++address)
+        buffer[address] = programmer.readEEPROMAddress(address);
+
+    read = buffer == image;
+    double singleUs = printScenario(board, "read, single", difference(board.getCounters(), before), eepromErrors(eeprom) - errorsBefore, size, read);
+    ok = ok && read;
+
+    /**
+     * Verification pass (VERIFY command). The whole chip is read in a tight loop and compared with the image.
+     * Only the pins are simulated, the CRC32 costs about 6us more per byte on the Nano.
+     */
+    VectorImage expected = {image};
+    std::vector<uint8_t> bitmap(size / 8);
+    uint32_t crc = 0xFFFFFFFF;
+    before = board.getCounters();
+    errorsBefore = eepromErrors(eeprom);
+
+    bool verified = programmer.verifyEEPROMRange(0, size, expected, &bitmap[0], crc) == 0 && crc == crc32(&image[0], size);
+    double verifyUs = printScenario(board, "verify, crc32", difference(board.getCounters(), before), eepromErrors(eeprom) - errorsBefore, size, verified);
+    ok = ok && verified;
+    printf("%-24s %10.0f reads per second (range), %.0f (single), %.0f (verify)\n", "", 1000000 / readUs, 1000000 / singleUs, 1000000 / verifyUs);
+
+    /**
+     * Checking a chip, which already holds the image, with its fingerprint (ImageFingerprint.h) instead of programming it again.
+     * The record takes the last bytes of the chip, so the image is the rest of it.
+     */
+    ImageFingerprint fingerprint = {(uint16_t) (size - IMAGE_FINGERPRINT_LENGTH), fingerprintBytes(&image[0], size - IMAGE_FINGERPRINT_LENGTH)};
+    bool stored = programmer.programImageFingerprint(fingerprint);
+    before = board.getCounters();
+    errorsBefore = eepromErrors(eeprom);
+
+    bool current = stored && programmer.isImageCurrent(fingerprint);
+    printScenario(board, "check, fingerprint", difference(board.getCounters(), before), eepromErrors(eeprom) - errorsBefore, size, current);
+    ok = ok && current;
+
+    printf("Write cycles: %u, ignored writes: %u, page boundary errors: %u\n", eeprom.getWriteCycles(), eeprom.getIgnoredWrites(),
+           eeprom.getPageBoundaryErrors());
+    printf("Pin toggles: SER %llu, SRCLK %llu, RCLK %llu, WE %llu\n", (unsigned long long) board.getPinToggles(SHIFT_REGISTER_SER_PIN),
+           (unsigned long long) board.getPinToggles(SHIFT_REGISTER_SR_CLK_PIN), (unsigned long long) board.getPinToggles(SHIFT_REGISTER_RCLK_PIN),
+           (unsigned long long) board.getPinToggles(EEPROM_WE_PIN));
+
+    if (options.maxWriteUs > 0 && writeUs > options.maxWriteUs) {
+        printf("Regression: write takes %.2f us per byte, the limit is %.2f us\n", writeUs, options.maxWriteUs);
+        ok = false;
+    }
+
+    if (options.maxReadUs > 0 && readUs > options.maxReadUs) {
+        printf("Regression: read takes %.2f us per byte, the limit is %.2f us\n", readUs, options.maxReadUs);
+        ok = false;
+    }
+
+    return ok && eepromErrors(eeprom) == 0;
+}
+
+/**
+ * Runs the scenarios through the @param hal directly or, with a @param tracePath, through the tracing HAL around it.
+ * @return The exit code.
+ */
+template<typename HAL>
+static int runBenchmark(HAL& hal, SimulatedBoard& board, const BenchmarkOptions& options, const std::string& tracePath, const size_t& traceLimit) {
+
+    if (tracePath.empty())
+        return runScenarios(hal, board, options) ? 0 : 1;
+
+    SimulatedPinTrace trace = {board, traceLimit, std::vector<TimedPinEvent>()};
+    TracingHAL<HAL, SimulatedPinTrace> tracingHal(hal, trace, SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN,
+                                                  EEPROM_WE_PIN, options.chip.outputEnableBit);
+    tracingHal.begin();
+
+    bool ok = runScenarios(tracingHal, board, options);
+
+    if (!writeVCD(tracePath, trace.events)) {
+        fprintf(stderr, "Can't save the trace.\n");
+        return 1;
+    }
+
+    printf("Trace: %zu events saved in %s\n", trace.events.size(), tracePath.c_str());
+
+    WriteTimingReport report = checkWriteTiming(trace.events);
+    printWriteTimingReport(report);
+
+    return ok && report.violations.empty() ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+
+    BenchmarkOptions options = {CHIP_28C16, false, false, -1, 0, 0};
+    bool perf = false;
+    uint32_t writeCycleUs = 0;
+    uint32_t clockMhz = 16;
+    std::string tracePath;
+    size_t traceLimit = DEFAULT_TRACE_LIMIT;
+
+    for (int i = 1; i < argc; ++i) {
+
+        if (strcmp(argv[i], "--chip") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+
+            if (strcmp(name, CHIP_28C16.name) == 0)
+                options.chip = CHIP_28C16;
+            else if (strcmp(name, CHIP_28C64.name) == 0)
+                options.chip = CHIP_28C64;
+            else if (strcmp(name, CHIP_28C256.name) == 0)
+                options.chip = CHIP_28C256;
+            else {
+                printUsage();
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--spi") == 0)
+            options.spi = true;
+        else if (strcmp(argv[i], "--write-cycle-us") == 0 && i + 1 < argc)
+            writeCycleUs = atol(argv[++i]);
+        else if (strcmp(argv[i], "--write-pulse-us") == 0 && i + 1 < argc)
+            options.writePulseUs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--clock-mhz") == 0 && i + 1 < argc)
+            clockMhz = atol(argv[++i]);
+        else if (strcmp(argv[i], "--max-write-us") == 0 && i + 1 < argc)
+            options.maxWriteUs = atof(argv[++i]);
+        else if (strcmp(argv[i], "--max-read-us") == 0 && i + 1 < argc)
+            options.maxReadUs = atof(argv[++i]);
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (strcmp(argv[i], "--trace-limit") == 0 && i + 1 < argc)
+            traceLimit = atol(argv[++i]);
+        else if (strcmp(argv[i], "--dual") == 0)
+            options.dual = true;
+        else if (strcmp(argv[i], "--perf") == 0)
+            perf = true;
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (clockMhz == 0 || (options.dual && options.chip.outputEnableBit + 1 >= 8 * SHIFT_REGISTER_CHAIN_LENGTH)) {
+        printUsage();
+        return 2;
+    }
+
+    if (writeCycleUs == 0)
+        writeCycleUs = options.chip.writeCycleUs;
+
+    SimulatedEEPROM eeprom(chipSize(options.chip), writeCycleUs);
+    eeprom.setPageMode(options.chip.pageSize, options.chip.byteLoadCycleUs);
+    SimulatedBoardPins pins = {SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN, EEPROM_WE_PIN, SHIFT_REGISTER_CHAIN_LENGTH,
+                               options.chip.outputEnableBit};
+    SimulatedBoardTiming timing = SIMULATED_NANO_TIMING;
+    timing.clockHz = clockMhz * 1000000;
+    SimulatedBoard board(eeprom, pins, timing);
+    SimulatedEEPROM second(chipSize(options.chip), writeCycleUs);
+    second.setPageMode(options.chip.pageSize, options.chip.byteLoadCycleUs);
+
+    if (options.dual)
+        board.attachSecondEEPROM(second, EEPROM_SECOND_WE_PIN, options.chip.outputEnableBit + 1);
+
+    printf("Chip: %s%s, shift registers: %s, clock: %u MHz, write cycle: %u us, %u bytes\n", options.dual ? "2 x " : "", options.chip.name,
+           options.spi ? "hardware SPI" : "bit bang", clockMhz, writeCycleUs, chipSize(options.chip));
+
+    if (!perf)
+        return runBenchmark(board, board, options, tracePath, traceLimit);
+
+    PerfCounters counters;
+    ProfilingHAL<SimulatedBoard> profilingHal(board, counters, timing.clockHz);
+    profilingHal.begin();
+
+    int result = runBenchmark(profilingHal, board, options, tracePath, traceLimit);
+    std::vector<PerfReportLine> lines;
+
+    for (uint8_t operation = 0; operation < PERF_OPERATIONS; ++operation) {
+        PerfReportLine line = {operation, counters.get(operation)};
+        lines.push_back(line);
+    }
+
+    printPerfReport(lines, timing.clockHz);
+    return result;
+}
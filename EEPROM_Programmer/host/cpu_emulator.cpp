@@ -0,0 +1,114 @@
+/**
+ * Runs a program on the emulated 8-bit computer with the microcode EEPROM images.
+ *
+ * Usage:
+ * cpu_emulator <program.bin> [--first first.bin --second second.bin] [--max-steps N] [--trace]
+ *
+ * program.bin Up to 16 bytes, which are loaded in the RAM.
+ * --first, --second The images of the microcode EEPROMs (for example read with eeprom_dump).
+ *   Without them the images generated from InstructionSet.h are used.
+ * --max-steps Stops after that many microsteps if the program doesn't halt. Default 100000.
+ * --trace Prints the control word, the bus and the registers after each microstep.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <CPUEmulator.h>
+
+#include "MicrocodeFiles.h"
+
+#define DEFAULT_MAX_STEPS 100000
+
+static void printUsage() {
+    fprintf(stderr, "Usage: cpu_emulator <program.bin> [--first first.bin --second second.bin] [--max-steps N] [--trace]\n");
+}
+
+static void printState(const CPUState& state, const uint16_t& controlWord) {
+    printf("CW %04X | BUS %02X | A %02X | B %02X | IR %02X | MAR %X | PC %X | OUT %3u | FLAGS %u | STEP %u\n",
+           controlWord, state.bus, state.a, state.b, state.ir, state.mar, state.pc, state.out, state.flags, state.step);
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 2) {
+        printUsage();
+        return 2;
+    }
+
+    std::string programPath = argv[1];
+    std::string firstPath;
+    std::string secondPath;
+    uint64_t maxSteps = DEFAULT_MAX_STEPS;
+    bool trace = false;
+
+    for (int i = 2; i < argc; ++i) {
+
+        if (strcmp(argv[i], "--first") == 0 && i + 1 < argc)
+            firstPath = argv[++i];
+        else if (strcmp(argv[i], "--second") == 0 && i + 1 < argc)
+            secondPath = argv[++i];
+        else if (strcmp(argv[i], "--max-steps") == 0 && i + 1 < argc)
+            maxSteps = strtoull(argv[++i], 0, 0);
+        else if (strcmp(argv[i], "--trace") == 0)
+            trace = true;
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    std::vector<uint8_t> first;
+    std::vector<uint8_t> second;
+    std::vector<uint8_t> program;
+
+    if (!loadMicrocodeImages(firstPath, secondPath, first, second)) {
+        fprintf(stderr, "Can't load the microcode images.\n");
+        return 1;
+    }
+
+    if (!readBinaryFile(programPath, program) || program.empty() || program.size() > CPU_RAM_SIZE) {
+        fprintf(stderr, "Can't load %s (1 up to %u bytes).\n", programPath.c_str(), CPU_RAM_SIZE);
+        return 1;
+    }
+
+    CPUEmulator cpu(&first[0], &second[0], first.size());
+    cpu.loadProgram(&program[0], program.size());
+    cpu.reset();
+
+    if (trace) {
+        while (cpu.getMicrosteps() < maxSteps) {
+            const CPUState& state = cpu.getState();
+            uint16_t controlWord = cpu.getControlWord((state.flags << MICROCODE_FLAGS_SHIFT) | (state.step << MICROCODE_CODE_BITS) | (state.ir >> 4));
+            bool running = cpu.clock();
+            printState(cpu.getState(), controlWord);
+
+            if (!running)
+                break;
+        }
+    } else {
+        cpu.run(maxSteps);
+    }
+
+    const std::vector<uint8_t>& outputs = cpu.getOutputs();
+
+    printf("Output:");
+
+    for (size_t i = 0; i < outputs.size(); ++i)
+        printf(" %u", outputs[i]);
+
+    printf("\n%s after %llu microsteps, %llu instructions\n", cpu.getState().halted ? "Halted" : "Stopped",
+           (unsigned long long) cpu.getMicrosteps(), (unsigned long long) cpu.getInstructions());
+
+    if (cpu.getBusContentions() > 0) {
+        uint16_t address = cpu.getFirstContentionAddress();
+        printf("Bus contention in %llu microsteps. First: instruction %u, step %u, flags %u\n",
+               (unsigned long long) cpu.getBusContentions(), microinstructionCode(address), microinstructionStep(address), microinstructionFlags(address));
+        return 3;
+    }
+
+    return 0;
+}
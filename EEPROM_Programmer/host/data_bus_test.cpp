@@ -0,0 +1,105 @@
+/**
+ * Checks the port mapping of the data bus (DataBus.h) against the pin by pin helpers, which main.cpp used before it.
+ * The ATmega328's PORTD/PORTB registers are modelled as bytes, written with the same masked writes as ArduinoHAL,
+ * and compared with digitalWriteBetween() and digitalReadBetween() on the Nano's pins 0 - 13.
+ * The pins outside of the data bus have other values on each run, so a write, which touches them, is found too.
+ */
+
+#include <DataBus.h>
+
+#include "HostTest.h"
+
+#define NANO_DIGITAL_PINS 14
+
+/**
+ * The ATmega328's PORTD (pins 0 - 7) and PORTB (pins 8 - 13).
+ */
+struct NanoPorts {
+    uint8_t portD;
+    uint8_t portB;
+
+    bool pin(const uint8_t& number) const {
+        return number < 8 ? (portD >> number) & 0b1 : (portB >> (number - 8)) & 0b1;
+    }
+
+    void setPin(const uint8_t& number, const bool& value) {
+        uint8_t& port = number < 8 ? portD : portB;
+        uint8_t mask = 0b1 << (number < 8 ? number : number - 8);
+        port = value ? port | mask : port & ~mask;
+    }
+};
+
+/**
+ * ArduinoHAL::writeDataBus() on the ATmega328.
+ */
+static void writePorts(NanoPorts& ports, const uint8_t& data) {
+    ports.portD = (ports.portD & ~DATA_BUS_PORTD_MASK) | dataBusPortD(data);
+    ports.portB = (ports.portB & ~DATA_BUS_PORTB_MASK) | dataBusPortB(data);
+}
+
+/**
+ * The loop of the former digitalWriteBetween() of main.cpp.
+ */
+static void digitalWriteBetween(NanoPorts& ports, const unsigned int& startPin, const unsigned int& endPin, const unsigned int& value) {
+
+    unsigned int bitIndex = 0;
+
+    for (unsigned int pin = endPin; pin >= startPin; --pin) {
+        ports.setPin(pin, ((0b1 << bitIndex) & value) > 0);
+        bitIndex++;
+    }
+}
+
+/**
+ * The loop of the former digitalReadBetween() of main.cpp.
+ */
+static unsigned int digitalReadBetween(const NanoPorts& ports, const unsigned int& startPin, const unsigned int& endPin) {
+
+    unsigned int data = 0;
+
+    for (unsigned int pin = startPin; pin <= endPin; ++pin)
+        data = (data << 1) | ports.pin(pin);
+
+    return data;
+}
+
+/**
+ * Values of the other pins. Only the upper two bits of PORTB are not Nano pins (the crystal).
+ */
+static const NanoPorts BACKGROUNDS[] = {{0x00, 0x00}, {0xFF, 0xFF}, {0b01010101, 0b10101010}, {0b00011111, 0b11100000}};
+
+int main() {
+
+    for (const NanoPorts& background : BACKGROUNDS) {
+        for (uint16_t value = 0; value < 256; ++value) {
+            NanoPorts masked = background;
+            NanoPorts pinByPin = background;
+
+            writePorts(masked, value);
+            digitalWriteBetween(pinByPin, DATA_BUS_FIRST_PIN, DATA_BUS_LAST_PIN, value);
+
+            for (uint8_t pin = 0; pin < NANO_DIGITAL_PINS; ++pin)
+                CHECK_EQUAL(masked.pin(pin), pinByPin.pin(pin));
+
+            CHECK_EQUAL(masked.portB >> 6, background.portB >> 6);
+            CHECK_EQUAL(dataBusFromPorts(masked.portD, masked.portB), value);
+            CHECK_EQUAL(dataBusFromPorts(masked.portD, masked.portB), digitalReadBetween(masked, DATA_BUS_FIRST_PIN, DATA_BUS_LAST_PIN));
+        }
+    }
+
+    for (uint16_t value = 0; value < 256; ++value)
+        CHECK_EQUAL(reverseBits(reverseBits(value)), value);
+
+    CHECK_EQUAL(reverseBits(0b00000001), 0b10000000);
+    CHECK_EQUAL(reverseBits(0b11010010), 0b01001011);
+
+    /**
+     * I/O7 is pin 5 (PD5), I/O0 is pin 12 (PB4).
+     */
+    CHECK_EQUAL(dataBusPortD(0b10000000), 0b00100000);
+    CHECK_EQUAL(dataBusPortB(0b10000000), 0);
+    CHECK_EQUAL(dataBusPortD(0b00000001), 0);
+    CHECK_EQUAL(dataBusPortB(0b00000001), 0b00010000);
+
+    return testResult();
+}
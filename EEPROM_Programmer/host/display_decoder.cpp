@@ -0,0 +1,158 @@
+/**
+ * Checks and saves the display decoder image (DisplayDecoder.h), which the programmer writes with programEEPROM8BitsSegmentDecoder().
+ * Each address is turned back into the character of its segments and compared with printf() of the value in that mode.
+ * The signed mode must be the same as the old decoder, which computed the digits for each byte while writing it.
+ *
+ * Usage:
+ * display_decoder [--save decoder.bin] [--size N] [--show value]
+ *
+ * --save Saves the image. It can be uploaded with eeprom_upload.
+ * --size Bytes of the image to save, for example 2048 for the 28C16 (only the first two modes). All modes by default.
+ * --show Prints how the value looks in each mode.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include <DisplayDecoder.h>
+
+static const char DISPLAY_CHARACTERS[] = "0123456789AbCdEF";
+
+static void printUsage() {
+    fprintf(stderr, "Usage: display_decoder [--save decoder.bin] [--size N] [--show value]\n");
+}
+
+/**
+ * @return '?' if the segments are not a known character.
+ */
+static char segmentsCharacter(const uint8_t& segments) {
+
+    if (segments == DISPLAY_SEGMENTS_BLANK)
+        return ' ';
+
+    if (segments == DISPLAY_SEGMENTS_MINUS)
+        return '-';
+
+    for (uint8_t i = 0; i < 16; ++i) {
+        if (DISPLAY_SEGMENTS[i] == segments)
+            return DISPLAY_CHARACTERS[i];
+    }
+
+    return '?';
+}
+
+/**
+ * The four digits from the image as they are placed on the display: sign, hundreds, tens, ones.
+ */
+static std::string displayText(const uint8_t& value, const uint8_t& mode) {
+
+    static const uint8_t DIGITS[4] = {DISPLAY_DIGIT_SIGN, DISPLAY_DIGIT_HUNDREDS, DISPLAY_DIGIT_TENS, DISPLAY_DIGIT_ONES};
+    std::string text;
+
+    for (uint8_t i = 0; i < 4; ++i)
+        text += segmentsCharacter(DisplayDecoderImage::image[displayDecoderAddress(value, DIGITS[i], mode)]);
+
+    return text;
+}
+
+static std::string expectedText(const uint8_t& value, const uint8_t& mode) {
+
+    char text[8];
+
+    if (mode == DISPLAY_MODE_SIGNED)
+        snprintf(text, sizeof(text), "%c%03d", (int8_t) value < 0 ? '-' : ' ', abs((int8_t) value));
+    else if (mode == DISPLAY_MODE_UNSIGNED)
+        snprintf(text, sizeof(text), " %03u", value);
+    else if (mode == DISPLAY_MODE_HEX)
+        snprintf(text, sizeof(text), "  %c%c", DISPLAY_CHARACTERS[value >> 4], DISPLAY_CHARACTERS[value & 0x0F]);
+    else
+        snprintf(text, sizeof(text), " %3u", value);
+
+    return text;
+}
+
+/**
+ * The data of the old programEEPROM8BitsSegmentDecoder() at the @param address of the signed mode.
+ */
+static uint8_t oldDecoderData(const uint16_t& address) {
+
+    int number = (int8_t) (address & 0xFF);
+    int positive = abs(number);
+    uint8_t combination = (address >> 8) & 0b11;
+
+    if (combination == 0b00)
+        return DISPLAY_SEGMENTS[(positive / 100) % 10];
+
+    if (combination == 0b10)
+        return DISPLAY_SEGMENTS[(positive / 10) % 10];
+
+    if (combination == 0b01)
+        return DISPLAY_SEGMENTS[positive % 10];
+
+    return number >= 0 ? DISPLAY_SEGMENTS_BLANK : DISPLAY_SEGMENTS_MINUS;
+}
+
+int main(int argc, char** argv) {
+
+    static const char* MODE_NAMES[4] = {"Signed", "Unsigned", "Hex", "Unsigned no 0"};
+    std::string savePath;
+    uint32_t size = DISPLAY_DECODER_IMAGE_SIZE;
+    int show = -1;
+
+    for (int i = 1; i < argc; ++i) {
+
+        if (strcmp(argv[i], "--save") == 0 && i + 1 < argc)
+            savePath = argv[++i];
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+            size = strtoul(argv[++i], 0, 0);
+        else if (strcmp(argv[i], "--show") == 0 && i + 1 < argc)
+            show = strtol(argv[++i], 0, 0) & 0xFF;
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (size == 0 || size > DISPLAY_DECODER_IMAGE_SIZE) {
+        fprintf(stderr, "The size must be 1 - %u.\n", (unsigned) DISPLAY_DECODER_IMAGE_SIZE);
+        return 2;
+    }
+
+    uint32_t mismatches = 0;
+
+    for (uint16_t mode = 0; mode < (1 << DISPLAY_MODE_BITS); ++mode) {
+        for (uint16_t value = 0; value <= 0xFF; ++value) {
+            if (displayText(value, mode) != expectedText(value, mode)) {
+                if (mismatches++ < 10)
+                    printf("%-14s %3u: '%s' instead of '%s'\n", MODE_NAMES[mode], value, displayText(value, mode).c_str(), expectedText(value, mode).c_str());
+            }
+        }
+    }
+
+    for (uint16_t address = 0; address < (1 << DISPLAY_MODE_SHIFT); ++address) {
+        if (DisplayDecoderImage::image[address] != oldDecoderData(address) && mismatches++ < 10)
+            printf("Signed address 0x%03X: 0x%02X instead of the old 0x%02X\n", address, DisplayDecoderImage::image[address], oldDecoderData(address));
+    }
+
+    if (show >= 0) {
+        for (uint8_t mode = 0; mode < (1 << DISPLAY_MODE_BITS); ++mode)
+            printf("%-14s '%s'\n", MODE_NAMES[mode], displayText(show, mode).c_str());
+    }
+
+    printf("Image: %u bytes, %u modes, %u mismatches\n", (unsigned) DISPLAY_DECODER_IMAGE_SIZE, 1 << DISPLAY_MODE_BITS, mismatches);
+
+    if (!savePath.empty()) {
+        std::ofstream file(savePath.c_str(), std::ios::binary);
+        file.write((const char*) DisplayDecoderImage::image, size);
+
+        if (!file) {
+            fprintf(stderr, "Can't save the image.\n");
+            return 1;
+        }
+    }
+
+    return mismatches == 0 ? 0 : 1;
+}
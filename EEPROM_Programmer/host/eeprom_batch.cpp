@@ -0,0 +1,252 @@
+/**
+ * Programs a batch of EEPROMs with several programmers at the same time, for example the two microcode chips and the display decoder.
+ * Each programmer (serial port) gets its image from the manifest and is served by its own thread, so the chips are written in parallel
+ * and the batch takes as long as the slowest one. After the upload the whole range is read back (VERIFY, only the CRC32 is sent)
+ * and compared with the image. At the end all results are printed as one report.
+ *
+ * Usage:
+ * eeprom_batch <manifest> [--packed] [--skip N] [--baud N] [--wait-ms N] [--no-verify]
+ *
+ * Manifest - one programmer per line, # starts a comment:
+ * <port> <image> [address] [length]
+ * /dev/ttyUSB0 first
+ * /dev/ttyUSB1 second
+ * /dev/ttyUSB2 decoder 0 2048
+ * /dev/ttyUSB3 program.bin 0x100
+ *
+ * The image is a file, or one of the images built in the host tools: first, second (MicrocodeImage) and decoder (DisplayDecoderImage).
+ * The length cuts the image, for example the decoder to the size of a 28C16.
+ * --packed, --skip, --baud, --wait-ms Same as eeprom_upload, for all programmers.
+ * --no-verify Trust the RESULT of the upload (the programmer already reads back each written byte).
+ * The pseudo terminals of nano_standin work as well, so the batch can be tried without hardware.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <DisplayDecoder.h>
+#include <Microcode.h>
+#include <PackedImage.h>
+
+#include "MicrocodeFiles.h"
+#include "ProgrammerClient.h"
+
+#define DEFAULT_BAUD_RATE 1000000
+#define DEFAULT_WAIT_MS 5000
+
+/**
+ * The answer to VERIFY may come that much after the programmer has read the range. requestVerify() adds the time
+ * for the reading (verifyDurationMs()), so a 32 KB chip gets its 1.5 seconds more.
+ */
+#define VERIFY_WAIT_MS 1000
+
+static void printUsage() {
+    fprintf(stderr, "Usage: eeprom_batch <manifest> [--packed] [--skip N] [--baud N] [--wait-ms N] [--no-verify]\n");
+}
+
+/**
+ * A line of the manifest and the result of its programmer. @param error is empty if everything went fine.
+ */
+struct BatchJob {
+    std::string port;
+    std::string imageName;
+    std::vector<uint8_t> image;
+    uint32_t address;
+    UploadResult upload;
+    bool verified;
+    uint32_t crc;
+    std::string error;
+};
+
+static bool loadImage(const std::string& name, std::vector<uint8_t>& image) {
+
+    if (name == "first" || name == "second") {
+        std::vector<uint8_t> first;
+        std::vector<uint8_t> second;
+        loadMicrocodeImages("", "", first, second);
+        image = name == "first" ? first : second;
+        return true;
+    }
+
+    if (name == "decoder") {
+        image.assign(DisplayDecoderImage::image, DisplayDecoderImage::image + DISPLAY_DECODER_IMAGE_SIZE);
+        return true;
+    }
+
+    return readBinaryFile(name, image);
+}
+
+static bool readManifest(const std::string& path, std::vector<BatchJob>& jobs) {
+
+    std::ifstream file(path.c_str());
+    std::string line;
+    int lineNumber = 0;
+
+    if (!file) {
+        fprintf(stderr, "Can't read %s\n", path.c_str());
+        return false;
+    }
+
+    while (std::getline(file, line)) {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream fields(line);
+        std::string port;
+        std::string imageName;
+        std::string address;
+        std::string length;
+
+        if (!(fields >> port))
+            continue;
+
+        BatchJob job = BatchJob();
+        fields >> imageName >> address >> length;
+        job.port = port;
+        job.imageName = imageName;
+        job.address = address.empty() ? 0 : strtoul(address.c_str(), 0, 0);
+
+        if (imageName.empty() || !loadImage(imageName, job.image)) {
+            fprintf(stderr, "%s:%d: Can't load the image '%s'.\n", path.c_str(), lineNumber, imageName.c_str());
+            return false;
+        }
+
+        if (!length.empty() && strtoul(length.c_str(), 0, 0) < job.image.size())
+            job.image.resize(strtoul(length.c_str(), 0, 0));
+
+        if (job.image.empty() || job.image.size() > 0xFFFF || job.address + job.image.size() > 0x10000) {
+            fprintf(stderr, "%s:%d: The image doesn't fit in the address space.\n", path.c_str(), lineNumber);
+            return false;
+        }
+
+        jobs.push_back(job);
+    }
+
+    return true;
+}
+
+/**
+ * The whole work of one programmer, run in its own thread. Only the @param job is touched.
+ */
+static void runJob(BatchJob& job, const UploadOptions& options, const uint32_t& baudRate, const bool& verify) {
+
+    SerialPort port;
+
+    if (!port.open(job.port, baudRate)) {
+        job.error = "Can't open the port.";
+        return;
+    }
+
+    UploadOptions jobOptions = options;
+    jobOptions.address = job.address;
+    uint8_t seq = 0;
+
+    if (!uploadImage(port, seq, job.image, jobOptions, job.upload)) {
+        job.error = job.upload.error;
+        return;
+    }
+
+    if (job.upload.failed > 0)
+        job.error = std::to_string(job.upload.failed) + " bytes failed.";
+
+    if (!verify)
+        return;
+
+    VerifyAnswer answer;
+
+    if (!requestVerify(port, seq, job.address, job.image.size(), VERIFY_IMAGE_NONE, VERIFY_WAIT_MS, answer)) {
+        job.error = "Can't verify the range.";
+        return;
+    }
+
+    job.verified = true;
+    job.crc = answer.crc;
+
+    if (answer.crc != ~crc32(&job.image[0], job.image.size()) && job.error.empty())
+        job.error = "The CRC32 differs from the image.";
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 2) {
+        printUsage();
+        return 2;
+    }
+
+    std::string manifestPath = argv[1];
+    UploadOptions options = {0, false, PACKED_NO_SKIP, DEFAULT_WAIT_MS};
+    uint32_t baudRate = DEFAULT_BAUD_RATE;
+    bool verify = true;
+
+    for (int i = 2; i < argc; ++i) {
+
+        if (strcmp(argv[i], "--packed") == 0)
+            options.packed = true;
+        else if (strcmp(argv[i], "--skip") == 0 && i + 1 < argc)
+            options.skipValue = strtoul(argv[++i], 0, 0) & 0xFF;
+        else if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc)
+            baudRate = strtoul(argv[++i], 0, 0);
+        else if (strcmp(argv[i], "--wait-ms") == 0 && i + 1 < argc)
+            options.waitMs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--no-verify") == 0)
+            verify = false;
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    std::vector<BatchJob> jobs;
+
+    if (!readManifest(manifestPath, jobs))
+        return 1;
+
+    if (jobs.empty()) {
+        fprintf(stderr, "The manifest has no programmers.\n");
+        return 1;
+    }
+
+    /**
+     * The jobs are not resized anymore, so each thread can hold a reference to its own.
+     */
+    std::vector<std::thread> threads;
+    uint64_t start = hostMillis();
+
+    for (size_t i = 0; i < jobs.size(); ++i)
+        threads.push_back(std::thread(runJob, std::ref(jobs[i]), std::cref(options), std::cref(baudRate), std::cref(verify)));
+
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+
+    uint64_t totalMs = hostMillis() - start;
+    uint64_t sequentialMs = 0;
+    size_t failedJobs = 0;
+
+    printf("%-16s %-16s %6s %8s %7s %7s %7s %9s  %s\n", "Port", "Image", "Bytes", "ms", "Written", "Skipped", "Failed", "CRC32", "Result");
+
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const BatchJob& job = jobs[i];
+        char crc[16] = "-";
+
+        if (job.verified)
+            snprintf(crc, sizeof(crc), "%08X", job.crc);
+
+        printf("%-16s %-16s %6zu %8llu %7u %7u %7u %9s  %s\n", job.port.c_str(), job.imageName.c_str(), job.image.size(),
+               (unsigned long long) job.upload.milliseconds, job.upload.written, job.upload.skipped, job.upload.failed, crc,
+               job.error.empty() ? "ok" : job.error.c_str());
+
+        sequentialMs += job.upload.milliseconds;
+        failedJobs += !job.error.empty();
+    }
+
+    printf("%zu programmers, %zu failed. Total %llu ms (%llu ms one after another)\n", jobs.size(), failedJobs,
+           (unsigned long long) totalMs, (unsigned long long) sequentialMs);
+
+    return failedJobs == 0 ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+/**
+ * Reads a range of the EEPROM through the programmer and saves it as a binary file.
+ *
+ * Usage:
+ * eeprom_dump <port> <out.bin> [--address N] [--length N] [--format bin|hex] [--baud N] [--wait-ms N]
+ *
+ * --address, --length The range to read. Default is the whole AT28C16 (0, 2048).
+ * --format bin - DUMP_DATA frames with CRC16 each (default, fastest).
+ *          hex - Intel HEX records with checksum each, the same text that can be saved from the serial monitor.
+ * The whole range is checked with the CRC16 from the DUMP_END frame.
+ * A part, which is lost or has a wrong checksum is requested again.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <IntelHex.h>
+
+#include "SerialPort.h"
+
+#define DEFAULT_BAUD_RATE 1000000
+#define DEFAULT_WAIT_MS 5000
+#define REQUEST_RETRY_MS 250
+#define INACTIVITY_TIMEOUT_MS 1000
+#define MAX_PASSES 10
+
+static void printUsage() {
+    fprintf(stderr, "Usage: eeprom_dump <port> <out.bin> [--address N] [--length N] [--format bin|hex] [--baud N] [--wait-ms N]\n");
+}
+
+/**
+ * Collects the received bytes in the image. Only bytes, which continue the already received part are accepted.
+ */
+struct DumpState {
+    std::vector<uint8_t>& image;
+    uint32_t address;
+    uint32_t received;
+    uint16_t passCrc;
+    bool ended;
+    uint16_t endCrc;
+    uint16_t endLength;
+
+    void accept(const uint16_t& chunkAddress, const uint8_t* data, const uint8_t& length) {
+
+        if (chunkAddress != address + received || received + length > image.size())
+            return;
+
+        memcpy(&image[received], data, length);
+        passCrc = crc16(data, length, passCrc);
+        received += length;
+    }
+};
+
+/**
+ * Asks for the range, which is still missing and receives it until DUMP_END.
+ * @return True if something was received.
+ */
+static bool runPass(SerialPort& port, DumpState& state, const uint8_t& format, const uint8_t& seq, const int& waitMs) {
+
+    uint32_t passStart = state.received;
+    uint8_t payload[5];
+    writeUint16(payload, state.address + state.received);
+    writeUint16(payload + 2, state.image.size() - state.received);
+    payload[4] = format;
+
+    FrameDecoder decoder;
+    std::string line;
+    bool answered = false;
+
+    state.passCrc = 0xFFFF;
+    state.ended = false;
+
+    sendFrame(port, FRAME_DUMP, seq, payload, sizeof(payload));
+    uint64_t lastActivity = hostMillis();
+    uint64_t lastRequest = lastActivity;
+    uint64_t giveUp = lastActivity + waitMs;
+
+    while (!state.ended) {
+        int byte = port.readByte(10);
+        uint64_t now = hostMillis();
+
+        if (byte < 0) {
+            if (!answered && now >= giveUp)
+                return false;
+
+            if (answered && now - lastActivity > INACTIVITY_TIMEOUT_MS)
+                return state.received > passStart;
+
+            if (!answered && now - lastRequest > REQUEST_RETRY_MS) {
+                sendFrame(port, FRAME_DUMP, seq, payload, sizeof(payload));
+                lastRequest = now;
+            }
+
+            continue;
+        }
+
+        lastActivity = now;
+
+        if (byte == '\r' || byte == '\n') {
+            IntelHexRecord record;
+            size_t recordStart = line.find(':');
+
+            if (format == DUMP_FORMAT_INTEL_HEX && recordStart != std::string::npos &&
+                decodeIntelHexRecord(line.c_str() + recordStart, record) && record.type == INTEL_HEX_DATA) {
+                state.accept(record.address, record.data, record.length);
+                answered = true;
+            }
+
+            line.clear();
+        } else if (byte < 0x80) {
+            line += (char) byte;
+        }
+
+        if (decoder.feed(byte) != FRAME_COMPLETE)
+            continue;
+
+        const Frame& frame = decoder.getFrame();
+
+        if (frame.seq != seq)
+            continue;
+
+        if (frame.type == FRAME_DUMP_DATA && frame.length >= 2) {
+            state.accept(readUint16(frame.payload), frame.payload + 2, frame.length - 2);
+            answered = true;
+        } else if (frame.type == FRAME_DUMP_END && frame.length >= 4) {
+            state.endLength = readUint16(frame.payload);
+            state.endCrc = readUint16(frame.payload + 2);
+            state.ended = true;
+            answered = true;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 3) {
+        printUsage();
+        return 2;
+    }
+
+    std::string portPath = argv[1];
+    std::string outPath = argv[2];
+    uint32_t address = 0;
+    uint32_t length = 2048;
+    uint8_t format = DUMP_FORMAT_BINARY;
+    uint32_t baudRate = DEFAULT_BAUD_RATE;
+    int waitMs = DEFAULT_WAIT_MS;
+
+    for (int i = 3; i + 1 < argc; i += 2) {
+
+        if (strcmp(argv[i], "--address") == 0)
+            address = strtoul(argv[i + 1], 0, 0);
+        else if (strcmp(argv[i], "--length") == 0)
+            length = strtoul(argv[i + 1], 0, 0);
+        else if (strcmp(argv[i], "--format") == 0)
+            format = strcmp(argv[i + 1], "hex") == 0 ? DUMP_FORMAT_INTEL_HEX : DUMP_FORMAT_BINARY;
+        else if (strcmp(argv[i], "--baud") == 0)
+            baudRate = strtoul(argv[i + 1], 0, 0);
+        else if (strcmp(argv[i], "--wait-ms") == 0)
+            waitMs = atoi(argv[i + 1]);
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (length == 0 || length > 0xFFFF || address + length > 0x10000) {
+        fprintf(stderr, "The range doesn't fit in the address space.\n");
+        return 1;
+    }
+
+    SerialPort port;
+
+    if (!port.open(portPath, baudRate)) {
+        fprintf(stderr, "Can't open %s at %u baud.\n", portPath.c_str(), baudRate);
+        return 1;
+    }
+
+    std::vector<uint8_t> image(length);
+    DumpState state = {image, address, 0, 0xFFFF, false, 0, 0};
+    uint64_t start = hostMillis();
+    bool complete = false;
+
+    for (uint8_t pass = 0; pass < MAX_PASSES && !complete; ++pass) {
+        uint32_t passStart = state.received;
+
+        if (!runPass(port, state, format, pass, pass == 0 ? waitMs : INACTIVITY_TIMEOUT_MS)) {
+            fprintf(stderr, "The programmer doesn't answer.\n");
+            return 1;
+        }
+
+        /**
+         * The CRC from DUMP_END covers everything asked in this pass.
+         * If a part was lost the CRCs doesn't match and the next pass asks for the rest.
+         */
+        bool passComplete = state.ended && state.received == image.size() &&
+                            state.endLength == image.size() - passStart && state.endCrc == state.passCrc;
+
+        if (passComplete)
+            complete = true;
+        else if (state.received == image.size())
+            state.received = passStart;
+    }
+
+    if (!complete) {
+        fprintf(stderr, "Can't read the whole range without errors.\n");
+        return 1;
+    }
+
+    std::ofstream file(outPath.c_str(), std::ios::binary);
+    file.write((const char*) &image[0], image.size());
+
+    if (!file) {
+        fprintf(stderr, "Can't write %s\n", outPath.c_str());
+        return 1;
+    }
+
+    double seconds = (hostMillis() - start) / 1000.0;
+    printf("Read %zu bytes in %.3f s, CRC16 %04X\n", image.size(), seconds, crc16(&image[0], image.size()));
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * Uploads a binary image to the EEPROM programmer over the serial protocol. See SerialProtocol.h
+ *
+ * Usage:
+ * eeprom_upload <port> <image.bin> [--address N] [--packed] [--skip N] [--baud N] [--wait-ms N]
+ *
+ * --address Where the first byte of the image is written. Default 0.
+ * --packed The image is sent in DATA_PACKED frames (PackedImage.h). The runs of the same byte take 2 bytes instead of up to 66.
+ *           The parts without runs are still sent as plain DATA frames, which cover more addresses.
+ * --skip With --packed the runs of that byte are not written at all (for example 0xFF for an erased chip).
+ * --baud Must be the same as the programmer's BAUD_RATE. Default 1000000.
+ * --wait-ms How long to wait for the programmer to answer the first frame. Opening the port resets the Arduino Nano,
+ *   so it needs some time before it starts listening. Default 5000.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <PackedImage.h>
+
+#include "ProgrammerClient.h"
+
+#define DEFAULT_BAUD_RATE 1000000
+#define DEFAULT_WAIT_MS 5000
+
+static void printUsage() {
+    fprintf(stderr, "Usage: eeprom_upload <port> <image.bin> [--address N] [--packed] [--skip N] [--baud N] [--wait-ms N]\n");
+}
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& bytes) {
+
+    std::ifstream file(path.c_str(), std::ios::binary);
+
+    if (!file)
+        return false;
+
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 3) {
+        printUsage();
+        return 2;
+    }
+
+    std::string portPath = argv[1];
+    std::string imagePath = argv[2];
+    uint32_t address = 0;
+    uint32_t baudRate = DEFAULT_BAUD_RATE;
+    int waitMs = DEFAULT_WAIT_MS;
+    bool packed = false;
+    int16_t skipValue = PACKED_NO_SKIP;
+
+    for (int i = 3; i < argc; ++i) {
+
+        if (strcmp(argv[i], "--address") == 0 && i + 1 < argc)
+            address = strtoul(argv[++i], 0, 0);
+        else if (strcmp(argv[i], "--packed") == 0)
+            packed = true;
+        else if (strcmp(argv[i], "--skip") == 0 && i + 1 < argc)
+            skipValue = strtoul(argv[++i], 0, 0) & 0xFF;
+        else if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc)
+            baudRate = strtoul(argv[++i], 0, 0);
+        else if (strcmp(argv[i], "--wait-ms") == 0 && i + 1 < argc)
+            waitMs = atoi(argv[++i]);
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    std::vector<uint8_t> image;
+
+    if (!readFile(imagePath, image) || image.empty() || address + image.size() > 0x10000) {
+        fprintf(stderr, "Can't read %s or it doesn't fit in the address space.\n", imagePath.c_str());
+        return 1;
+    }
+
+    SerialPort port;
+
+    if (!port.open(portPath, baudRate)) {
+        fprintf(stderr, "Can't open %s at %u baud.\n", portPath.c_str(), baudRate);
+        return 1;
+    }
+
+    UploadOptions options = {address, packed, skipValue, waitMs};
+    UploadResult result;
+    uint8_t seq = 0;
+
+    if (!uploadImage(port, seq, image, options, result)) {
+        fprintf(stderr, "%s\n", result.error.c_str());
+        return 1;
+    }
+
+    double seconds = result.milliseconds / 1000.0;
+
+    printf("Uploaded %zu bytes in %.2f s (%.0f B/s)\n", image.size(), seconds, image.size() / seconds);
+    printf("Sent %zu frames (%zu bytes)\n", result.frames, result.sentBytes);
+    printf("Written: %u Skipped: %u Verified: %u Failed: %u\n", result.written, result.skipped, result.verified, result.failed);
+
+    return result.failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+/**
+ * Checks the content of the EEPROM through the programmer without dumping it (VERIFY in SerialProtocol.h).
+ *
+ * Usage:
+ * eeprom_verify <port> (--image in.bin | --device-image N) [--address N] [--length N] [--baud N] [--wait-ms N]
+ *
+ * --image The expected content is a file on the host. The programmer only sends the CRC32 of the range.
+ *         If it differs, the CRC32 of each half is asked again until the mismatching addresses are found.
+ * --device-image The expected content is one of the programmer's images (1 - first, 2 - second microcode, see main.cpp).
+ *                The programmer compares them itself and sends the bitmap of the mismatching addresses.
+ * --address, --length The range. The length is the whole file by default and must be given with --device-image.
+ * Prints the mismatching ranges and exits with 1 if there are any. eeprom_upload rewrites only them (differential programming).
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "MicrocodeFiles.h"
+#include "ProgrammerClient.h"
+
+#define DEFAULT_BAUD_RATE 1000000
+#define DEFAULT_WAIT_MS 5000
+#define INACTIVITY_TIMEOUT_MS 1000
+
+static void printUsage() {
+    fprintf(stderr, "Usage: eeprom_verify <port> (--image in.bin | --device-image N) [--address N] [--length N] [--baud N] [--wait-ms N]\n");
+}
+
+/**
+ * Finds the addresses, where the chip differs from the @param image, only by asking for CRC32s.
+ * A range with the same CRC32 is skipped, the others are split in halves down to single bytes.
+ * @param address The address of image[0] on the chip.
+ */
+static bool locateMismatches(SerialPort& port, uint8_t& seq, const std::vector<uint8_t>& image, const uint16_t& address,
+                             const uint16_t& offset, const uint16_t& length, std::vector<uint16_t>& mismatches) {
+
+    VerifyAnswer answer;
+
+    if (!requestVerify(port, seq++, address + offset, length, VERIFY_IMAGE_NONE, INACTIVITY_TIMEOUT_MS, answer))
+        return false;
+
+    if (answer.crc == ~crc32(&image[offset], length))
+        return true;
+
+    if (length == 1) {
+        mismatches.push_back(address + offset);
+        return true;
+    }
+
+    return locateMismatches(port, seq, image, address, offset, length / 2, mismatches) &&
+           locateMismatches(port, seq, image, address, offset + length / 2, length - length / 2, mismatches);
+}
+
+/**
+ * Prints the consecutive mismatching addresses as ranges.
+ */
+static void printMismatches(const std::vector<uint16_t>& mismatches) {
+
+    for (size_t i = 0; i < mismatches.size();) {
+        size_t end = i + 1;
+
+        while (end < mismatches.size() && mismatches[end] == mismatches[end - 1] + 1)
+            end++;
+
+        if (end - i == 1)
+            printf("Mismatch: 0x%04X\n", mismatches[i]);
+        else
+            printf("Mismatch: 0x%04X - 0x%04X (%zu bytes)\n", mismatches[i], mismatches[end - 1], end - i);
+
+        i = end;
+    }
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 2) {
+        printUsage();
+        return 2;
+    }
+
+    std::string portPath = argv[1];
+    std::string imagePath;
+    uint8_t deviceImage = VERIFY_IMAGE_NONE;
+    uint32_t address = 0;
+    uint32_t length = 0;
+    uint32_t baudRate = DEFAULT_BAUD_RATE;
+    int waitMs = DEFAULT_WAIT_MS;
+
+    for (int i = 2; i + 1 < argc; i += 2) {
+
+        if (strcmp(argv[i], "--image") == 0)
+            imagePath = argv[i + 1];
+        else if (strcmp(argv[i], "--device-image") == 0)
+            deviceImage = strtoul(argv[i + 1], 0, 0);
+        else if (strcmp(argv[i], "--address") == 0)
+            address = strtoul(argv[i + 1], 0, 0);
+        else if (strcmp(argv[i], "--length") == 0)
+            length = strtoul(argv[i + 1], 0, 0);
+        else if (strcmp(argv[i], "--baud") == 0)
+            baudRate = strtoul(argv[i + 1], 0, 0);
+        else if (strcmp(argv[i], "--wait-ms") == 0)
+            waitMs = atoi(argv[i + 1]);
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (argc % 2 != 0 || imagePath.empty() == (deviceImage == VERIFY_IMAGE_NONE)) {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<uint8_t> image;
+
+    if (!imagePath.empty()) {
+        if (!readBinaryFile(imagePath, image)) {
+            fprintf(stderr, "Can't read %s\n", imagePath.c_str());
+            return 1;
+        }
+
+        if (length == 0 || length > image.size())
+            length = image.size();
+    }
+
+    if (length == 0 || length > 0xFFFF || address + length > 0x10000) {
+        fprintf(stderr, "The range doesn't fit in the address space.%s\n", imagePath.empty() ? " Set it with --length." : "");
+        return 1;
+    }
+
+    SerialPort port;
+
+    if (!port.open(portPath, baudRate)) {
+        fprintf(stderr, "Can't open %s at %u baud.\n", portPath.c_str(), baudRate);
+        return 1;
+    }
+
+    uint64_t start = hostMillis();
+    uint8_t seq = 0;
+    VerifyAnswer answer;
+
+    if (!requestVerify(port, seq++, address, length, deviceImage, waitMs, answer)) {
+        if (answer.nak != 0)
+            fprintf(stderr, "The programmer refused the request (NAK %u).\n", answer.nak);
+
+        fprintf(stderr, "Can't verify the range.\n");
+        return 1;
+    }
+
+    std::vector<uint16_t> mismatches = answer.mismatches;
+
+    if (!imagePath.empty() && answer.crc != ~crc32(&image[0], length) && !locateMismatches(port, seq, image, address, 0, length, mismatches)) {
+        fprintf(stderr, "Can't locate the mismatches.\n");
+        return 1;
+    }
+
+    printMismatches(mismatches);
+    printf("Verified %u bytes from 0x%04X in %llu ms: CRC32 %08X, %zu mismatches\n", length, address,
+           (unsigned long long) (hostMillis() - start), answer.crc, mismatches.size());
+
+    return mismatches.empty() ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+/**
+ * Runs the sample programs (SamplePrograms.h) on the emulated computer and reports the speed of the emulator
+ * and the steps with a bus contention. Exits with 1 if a program doesn't give its expected result (see SampleResult).
+ *
+ * Usage:
+ * emulator_benchmark [--first first.bin --second second.bin] [--seconds N] [--strict]
+ *
+ * --first, --second The images of the microcode EEPROMs. Without them the images generated from InstructionSet.h are used.
+ * --seconds How long each program is run again and again for the measurement. Default 1.
+ * --strict Exit with 1 if there is a bus contention. For CI.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <CPUEmulator.h>
+
+#include "MicrocodeFiles.h"
+#include "SamplePrograms.h"
+
+#define MAX_PROGRAM_STEPS 1000000
+
+static void printUsage() {
+    fprintf(stderr, "Usage: emulator_benchmark [--first first.bin --second second.bin] [--seconds N] [--strict]\n");
+}
+
+static double secondsSince(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Checks each step of the microcode, also the ones the sample programs doesn't reach.
+ * @return Number of the steps with more than one output to the bus.
+ */
+static uint32_t printStaticContentions(const CPUEmulator& cpu, const uint32_t& imageSize) {
+
+    uint32_t contentions = 0;
+
+    for (uint32_t address = 0; address < imageSize; ++address) {
+        uint16_t controlWord = cpu.getControlWord(address);
+
+        if (CPUEmulator::countBusOutputs(controlWord) <= 1)
+            continue;
+
+        printf("Bus contention: instruction %u, step %u, flags %u, outputs %04X\n", microinstructionCode(address),
+               microinstructionStep(address), microinstructionFlags(address), controlWord & CPU_BUS_OUTPUTS);
+        contentions++;
+    }
+
+    return contentions;
+}
+
+int main(int argc, char** argv) {
+
+    std::string firstPath;
+    std::string secondPath;
+    double seconds = 1;
+    bool strict = false;
+
+    for (int i = 1; i < argc; ++i) {
+
+        if (strcmp(argv[i], "--first") == 0 && i + 1 < argc)
+            firstPath = argv[++i];
+        else if (strcmp(argv[i], "--second") == 0 && i + 1 < argc)
+            secondPath = argv[++i];
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "--strict") == 0)
+            strict = true;
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    std::vector<uint8_t> first;
+    std::vector<uint8_t> second;
+
+    if (!loadMicrocodeImages(firstPath, secondPath, first, second)) {
+        fprintf(stderr, "Can't load the microcode images.\n");
+        return 1;
+    }
+
+    CPUEmulator cpu(&first[0], &second[0], first.size());
+    uint32_t contentions = printStaticContentions(cpu, first.size());
+    uint64_t totalMicrosteps = 0;
+    double totalSeconds = 0;
+    bool expected = true;
+
+    printf("%-10s %8s %12s %6s %11s %14s %8s\n", "Program", "Outputs", "Microsteps", "CPI", "Contentions", "Microsteps/s", "Result");
+
+    for (size_t i = 0; i < SAMPLE_PROGRAM_COUNT; ++i) {
+        const SampleProgram& program = SAMPLE_PROGRAMS[i];
+
+        cpu.loadProgram(program.ram, CPU_RAM_SIZE);
+        cpu.reset();
+        cpu.run(MAX_PROGRAM_STEPS);
+
+        uint64_t microsteps = cpu.getMicrosteps();
+        uint64_t instructions = cpu.getInstructions();
+        uint64_t busContentions = cpu.getBusContentions();
+        size_t outputs = cpu.getOutputs().size();
+        bool programExpected = hasExpectedResult(cpu, program);
+
+        /**
+         * The program is loaded again each time, because it changes the RAM.
+         */
+        uint64_t benchmarkMicrosteps = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        double elapsed = 0;
+
+        while (elapsed < seconds) {
+            for (int repeat = 0; repeat < 100; ++repeat) {
+                cpu.loadProgram(program.ram, CPU_RAM_SIZE);
+                cpu.reset();
+                benchmarkMicrosteps += cpu.run(MAX_PROGRAM_STEPS);
+            }
+
+            elapsed = secondsSince(start);
+        }
+
+        totalMicrosteps += benchmarkMicrosteps;
+        totalSeconds += elapsed;
+
+        printf("%-10s %8zu %12llu %6.2f %11llu %14.0f %8s\n", program.name, outputs, (unsigned long long) microsteps,
+               instructions ? (double) microsteps / instructions : 0.0, (unsigned long long) busContentions, benchmarkMicrosteps / elapsed,
+               programExpected ? "ok" : "WRONG");
+
+        contentions += busContentions;
+        expected = expected && programExpected;
+    }
+
+    printf("Total: %.0f microsteps/s\n", totalMicrosteps / totalSeconds);
+
+    return !expected || (strict && contentions > 0) ? 1 : 0;
+}
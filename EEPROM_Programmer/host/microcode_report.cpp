@@ -0,0 +1,184 @@
+/**
+ * Compares the microcode with fixed steps and the optimized one (see MICROCODE_STEP_RESET in Microcode.h).
+ * Prints the steps of each instruction, then runs the sample programs (SamplePrograms.h) on the emulator with both
+ * and checks that they give the same result in less cycles and that the result is the expected one of the program.
+ * At the end prints the fingerprints of the images (ImageFingerprint.h). Exits with 1 if a check fails.
+ *
+ * Usage:
+ * microcode_report [--save-first first.bin --save-second second.bin] [--save-packed PackedMicrocode.h]
+ *
+ * --save-first, --save-second Saves the images, which the programmer writes (MicrocodeImage). They can be uploaded with eeprom_upload.
+ * --save-packed Saves both images packed (PackedImage.h) as PROGMEM arrays for programPackedEEPROM() in main.cpp.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <CPUEmulator.h>
+#include <PackedImage.h>
+
+#include "SamplePrograms.h"
+
+#define MAX_PROGRAM_STEPS 1000000
+
+static const char* INSTRUCTION_NAMES[16] = {"LDA", "LDB", "ADD", "SUB", "STA", "LDI", "JMP", "OUT",
+                                            "HLT", "JC", "JZ", "-", "-", "-", "-", "-"};
+
+static void printUsage() {
+    fprintf(stderr, "Usage: microcode_report [--save-first first.bin --save-second second.bin] [--save-packed PackedMicrocode.h]\n");
+}
+
+static bool saveImage(const std::string& path, const uint8_t* image) {
+
+    std::ofstream file(path.c_str(), std::ios::binary);
+    file.write((const char*) image, MICROCODE_IMAGE_SIZE);
+
+    return (bool) file;
+}
+
+static void writePackedArray(FILE* file, const char* name, const uint8_t* image) {
+
+    std::vector<uint8_t> packed(packedImageBound(MICROCODE_IMAGE_SIZE));
+    uint32_t length = packImage(image, MICROCODE_IMAGE_SIZE, PACKED_NO_SKIP, &packed[0]);
+
+    fprintf(file, "    const uint16_t %sLength = %u;\n\n", name, length);
+    fprintf(file, "    const uint8_t %s[] PROGMEM = {", name);
+
+    for (uint32_t i = 0; i < length; ++i)
+        fprintf(file, "%s0x%02X", i == 0 ? "\n        " : i % 16 == 0 ? ",\n        " : ", ", packed[i]);
+
+    fprintf(file, "\n    };\n");
+}
+
+/**
+ * The header has no dependencies, thus it can be copied in the src folder of the sketch as it is.
+ */
+static bool savePackedImages(const std::string& path) {
+
+    FILE* file = fopen(path.c_str(), "w");
+
+    if (!file)
+        return false;
+
+    fprintf(file, "#ifndef PACKED_MICROCODE_H\n#define PACKED_MICROCODE_H\n\n");
+    fprintf(file, "/**\n * Generated by microcode_report --save-packed. The microcode images (MicrocodeImage) packed with packImage().\n */\n\n");
+    fprintf(file, "namespace PackedMicrocode {\n\n");
+    writePackedArray(file, "first", MicrocodeImage::first);
+    fprintf(file, "\n");
+    writePackedArray(file, "second", MicrocodeImage::second);
+    fprintf(file, "}\n\n#endif\n");
+
+    return fclose(file) == 0;
+}
+
+static void printInstructionSteps() {
+
+    printf("%-12s %6s %6s\n", "Instruction", "Before", "After");
+
+    for (size_t i = 0; i < INSTRUCTION_COUNT; ++i) {
+        const Instruction& instruction = INSTRUCTIONS[i];
+        const char* name = INSTRUCTION_NAMES[instruction.code];
+
+        if (instruction.condition == INSTRUCTION_ALWAYS) {
+            printf("%-12s %6u %6u\n", name, instructionSteps(instruction.code, 0, false), instructionSteps(instruction.code, 0, true));
+            continue;
+        }
+
+        printf("%-4s %-7s %6u %6u\n", name, "taken", instructionSteps(instruction.code, instruction.condition, false),
+               instructionSteps(instruction.code, instruction.condition, true));
+        printf("%-4s %-7s %6u %6u\n", name, "not", instructionSteps(instruction.code, 0, false), instructionSteps(instruction.code, 0, true));
+    }
+}
+
+int main(int argc, char** argv) {
+
+    std::string firstPath;
+    std::string secondPath;
+    std::string packedPath;
+
+    for (int i = 1; i < argc; ++i) {
+
+        if (strcmp(argv[i], "--save-first") == 0 && i + 1 < argc)
+            firstPath = argv[++i];
+        else if (strcmp(argv[i], "--save-second") == 0 && i + 1 < argc)
+            secondPath = argv[++i];
+        else if (strcmp(argv[i], "--save-packed") == 0 && i + 1 < argc)
+            packedPath = argv[++i];
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    printInstructionSteps();
+
+    CPUEmulator fixedSteps(FixedStepsMicrocodeImage::first, FixedStepsMicrocodeImage::second, MICROCODE_IMAGE_SIZE);
+    CPUEmulator optimized(OptimizedMicrocodeImage::first, OptimizedMicrocodeImage::second, MICROCODE_IMAGE_SIZE);
+    uint64_t totalBefore = 0;
+    uint64_t totalAfter = 0;
+    bool same = true;
+
+    printf("\n%-10s %12s %12s %10s %10s %8s\n", "Program", "Cycles", "Cycles", "CPI", "CPI", "Result");
+    printf("%-10s %12s %12s %10s %10s %8s\n", "", "before", "after", "before", "after", "");
+
+    for (size_t i = 0; i < SAMPLE_PROGRAM_COUNT; ++i) {
+        const SampleProgram& program = SAMPLE_PROGRAMS[i];
+
+        fixedSteps.loadProgram(program.ram, CPU_RAM_SIZE);
+        fixedSteps.reset();
+        fixedSteps.run(MAX_PROGRAM_STEPS);
+
+        optimized.loadProgram(program.ram, CPU_RAM_SIZE);
+        optimized.reset();
+        optimized.run(MAX_PROGRAM_STEPS);
+
+        /**
+         * The result is the output and the RAM. The registers may differ, for example the bus value on HLT.
+         */
+        bool programSame = fixedSteps.getOutputs() == optimized.getOutputs() &&
+                           memcmp(fixedSteps.getState().ram, optimized.getState().ram, CPU_RAM_SIZE) == 0 &&
+                           fixedSteps.getState().halted == optimized.getState().halted;
+        bool programExpected = hasExpectedResult(fixedSteps, program) && hasExpectedResult(optimized, program);
+
+        printf("%-10s %12llu %12llu %10.2f %10.2f %8s\n", program.name,
+               (unsigned long long) fixedSteps.getMicrosteps(), (unsigned long long) optimized.getMicrosteps(),
+               (double) fixedSteps.getMicrosteps() / fixedSteps.getInstructions(), (double) optimized.getMicrosteps() / optimized.getInstructions(),
+               !programSame ? "DIFFERS" : programExpected ? "same" : "WRONG");
+
+        totalBefore += fixedSteps.getMicrosteps();
+        totalAfter += optimized.getMicrosteps();
+        same = same && programSame && programExpected;
+    }
+
+    printf("Total: %llu -> %llu cycles (%.1f%% less)\n", (unsigned long long) totalBefore, (unsigned long long) totalAfter,
+           100.0 * (totalBefore - totalAfter) / totalBefore);
+
+    /**
+     * The fingerprints, which the programmer stores on the chips (ImageFingerprint.h). The compile time ones must match the images.
+     */
+    uint32_t firstFingerprint = fingerprintBytes(MicrocodeImage::first, MICROCODE_IMAGE_SIZE);
+    uint32_t secondFingerprint = fingerprintBytes(MicrocodeImage::second, MICROCODE_IMAGE_SIZE);
+    bool fingerprintsSame = firstFingerprint == microcodeFingerprint(false) && secondFingerprint == microcodeFingerprint(true);
+
+    printf("Fingerprints: first 0x%08X, second 0x%08X%s\n", firstFingerprint, secondFingerprint, fingerprintsSame ? "" : " (DIFFERS from the compile time ones)");
+    same = same && fingerprintsSame;
+
+    /**
+     * Mostly the zeros of the unused steps and instructions.
+     */
+    std::vector<uint8_t> packed(packedImageBound(MICROCODE_IMAGE_SIZE));
+    printf("Packed: first %u bytes, second %u bytes (of %u)\n", packImage(MicrocodeImage::first, MICROCODE_IMAGE_SIZE, PACKED_NO_SKIP, &packed[0]),
+           packImage(MicrocodeImage::second, MICROCODE_IMAGE_SIZE, PACKED_NO_SKIP, &packed[0]), (unsigned) MICROCODE_IMAGE_SIZE);
+
+    if ((!firstPath.empty() && !saveImage(firstPath, MicrocodeImage::first)) ||
+        (!secondPath.empty() && !saveImage(secondPath, MicrocodeImage::second)) ||
+        (!packedPath.empty() && !savePackedImages(packedPath))) {
+        fprintf(stderr, "Can't save the images.\n");
+        return 1;
+    }
+
+    return same ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+/**
+ * Checks the generated microcode images (Microcode.h) against the bytes, which the hand-written programFirstEEPROM() and
+ * programSecondEEPROM() of the original main.cpp wrote. The 90 address/value pairs below are copied from them, so they don't depend
+ * on InstructionSet.h and a change of the table or of the generator, which changes the old instructions, fails here.
+ *
+ * - The image without the optimization (FixedStepsMicrocodeImage) must hold exactly the old bytes, in each variant of the flags.
+ * - The optimized image (OptimizedMicrocodeImage) must keep the old fetch and every control signal of the old steps.
+ *   Only the empty steps are removed, the others may be merged, and RS ends the instruction.
+ */
+
+#include <Microcode.h>
+
+#include "HostTest.h"
+
+/**
+ * 0b00000{Step 3 bits}{Code 4 Bits}
+ */
+struct LegacyByte {
+    uint16_t address;
+    uint8_t data;
+};
+
+#define LEGACY_STEPS 5
+#define LEGACY_FETCH_STEPS 2
+#define LEGACY_INSTRUCTIONS 9
+#define LEGACY_RS 0b00000001
+
+static const LegacyByte LEGACY_FIRST_EEPROM[] = {
+        {0x000, 0b01000000}, {0x010, 0b00010100}, {0x020, 0b01001000}, {0x030, 0b00010010}, {0x040, 0b00000000},
+        {0x001, 0b01000000}, {0x011, 0b00010100}, {0x021, 0b01001000}, {0x031, 0b00010000}, {0x041, 0b00000000},
+        {0x002, 0b01000000}, {0x012, 0b00010100}, {0x022, 0b01001000}, {0x032, 0b00100000}, {0x042, 0b00000000},
+        {0x003, 0b01000000}, {0x013, 0b00010100}, {0x023, 0b01001000}, {0x033, 0b00010000}, {0x043, 0b00000010},
+        {0x004, 0b01000000}, {0x014, 0b00010100}, {0x024, 0b01001000}, {0x034, 0b00100001}, {0x044, 0b00000000},
+        {0x005, 0b01000000}, {0x015, 0b00010100}, {0x025, 0b00001010}, {0x035, 0b00000000}, {0x045, 0b00000000},
+        {0x006, 0b01000000}, {0x016, 0b00010100}, {0x026, 0b00001000}, {0x036, 0b00000000}, {0x046, 0b00000000},
+        {0x007, 0b01000000}, {0x017, 0b00010100}, {0x027, 0b00000001}, {0x037, 0b00000000}, {0x047, 0b00000000},
+        {0x008, 0b01000000}, {0x018, 0b00010100}, {0x028, 0b10000000}, {0x038, 0b00000000}, {0x048, 0b00000000}
+};
+
+static const LegacyByte LEGACY_SECOND_EEPROM[] = {
+        {0x000, 0b00000100}, {0x010, 0b00001000}, {0x020, 0b00000000}, {0x030, 0b00000000}, {0x040, 0b00000000},
+        {0x001, 0b00000100}, {0x011, 0b00001000}, {0x021, 0b00000000}, {0x031, 0b00100000}, {0x041, 0b00000000},
+        {0x002, 0b00000100}, {0x012, 0b00001000}, {0x022, 0b00000000}, {0x032, 0b10000000}, {0x042, 0b00000000},
+        {0x003, 0b00000100}, {0x013, 0b00001000}, {0x023, 0b00000000}, {0x033, 0b11000000}, {0x043, 0b00000000},
+        {0x004, 0b00000100}, {0x014, 0b00001000}, {0x024, 0b00000000}, {0x034, 0b00000000}, {0x044, 0b00000000},
+        {0x005, 0b00000100}, {0x015, 0b00001000}, {0x025, 0b00000000}, {0x035, 0b00000000}, {0x045, 0b00000000},
+        {0x006, 0b00000100}, {0x016, 0b00001000}, {0x026, 0b00000010}, {0x036, 0b00000000}, {0x046, 0b00000000},
+        {0x007, 0b00000100}, {0x017, 0b00001000}, {0x027, 0b00010000}, {0x037, 0b00000000}, {0x047, 0b00000000},
+        {0x008, 0b00000100}, {0x018, 0b00001000}, {0x028, 0b00000000}, {0x038, 0b00000000}, {0x048, 0b00000000}
+};
+
+static_assert(sizeof(LEGACY_FIRST_EEPROM) / sizeof(LegacyByte) + sizeof(LEGACY_SECOND_EEPROM) / sizeof(LegacyByte) == 90,
+              "The original functions wrote 90 bytes");
+
+static uint16_t legacyAddress(const uint8_t& step, const uint8_t& code) {
+    return (step << 4) | code;
+}
+
+/**
+ * The old control word of the step. Both chips wrote the same addresses in the same order.
+ */
+static uint16_t legacyControlWord(const uint8_t& step, const uint8_t& code) {
+
+    for (uint8_t i = 0; i < LEGACY_STEPS * LEGACY_INSTRUCTIONS; ++i) {
+        if (LEGACY_FIRST_EEPROM[i].address == legacyAddress(step, code))
+            return (LEGACY_FIRST_EEPROM[i].data << 8) | LEGACY_SECOND_EEPROM[i].data;
+    }
+
+    return 0;
+}
+
+static void testFixedSteps() {
+
+    for (uint8_t flags = 0; flags < (1 << FLAG_BITS); ++flags) {
+        for (uint8_t i = 0; i < LEGACY_STEPS * LEGACY_INSTRUCTIONS; ++i) {
+            CHECK_EQUAL(LEGACY_FIRST_EEPROM[i].address, LEGACY_SECOND_EEPROM[i].address);
+
+            uint16_t address = (flags << MICROCODE_FLAGS_SHIFT) | LEGACY_FIRST_EEPROM[i].address;
+            CHECK_EQUAL(FixedStepsMicrocodeImage::first[address], LEGACY_FIRST_EEPROM[i].data);
+            CHECK_EQUAL(FixedStepsMicrocodeImage::second[address], LEGACY_SECOND_EEPROM[i].data);
+        }
+    }
+}
+
+static void testOptimized() {
+
+    for (uint8_t flags = 0; flags < (1 << FLAG_BITS); ++flags) {
+        for (uint8_t code = 0; code < LEGACY_INSTRUCTIONS; ++code) {
+            uint16_t legacySignals = 0;
+            uint16_t signals = 0;
+            int resetStep = -1;
+
+            for (uint8_t step = 0; step < (1 << MICROCODE_STEP_BITS); ++step) {
+                uint16_t address = microinstructionAddress(step, code, flags);
+                uint16_t word = (OptimizedMicrocodeImage::first[address] << 8) | OptimizedMicrocodeImage::second[address];
+
+                if (step < LEGACY_FETCH_STEPS) {
+                    CHECK_EQUAL(word, legacyControlWord(step, code));
+                    continue;
+                }
+
+                if (step < LEGACY_STEPS)
+                    legacySignals |= legacyControlWord(step, code);
+
+                if (resetStep >= 0) {
+                    CHECK_EQUAL(word, 0);
+                    continue;
+                }
+
+                signals |= word & ~LEGACY_RS;
+
+                if (word & LEGACY_RS)
+                    resetStep = step;
+            }
+
+            CHECK(resetStep >= LEGACY_FETCH_STEPS && resetStep < LEGACY_STEPS);
+            CHECK_EQUAL(signals, legacySignals);
+        }
+    }
+}
+
+int main() {
+    testFixedSteps();
+    testOptimized();
+    return testResult();
+}
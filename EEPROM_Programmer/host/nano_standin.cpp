@@ -0,0 +1,337 @@
+/**
+ * Stand-in for the Arduino Nano programmer on a Linux host.
+ * Creates a pseudo terminal, prints its path and answers the serial protocol exactly like the programmer,
+ * but the bytes are written to a SimulatedEEPROM. That way the host tools can be tested end to end without hardware.
+ *
+ * Usage:
+ * nano_standin [--size N] [--write-cycle-us N] [--no-polling] [--image out.bin] [--verify-image in.bin] [--once]
+ *
+ * --size Number of addresses of the simulated chip. Default 2048 (AT28C16).
+ * --write-cycle-us Length of the simulated write cycle. The time is real, so the upload takes as long as with the real chip.
+ * --no-polling The simulated chip doesn't support DATA# Polling and Toggle Bit, thus each write waits the fallback delay.
+ * --image The content of the simulated chip is saved there on exit.
+ * --verify-image Acts as the programmer's image 1 for VERIFY (like the microcode in the Nano's flash).
+ * --once Exit after the first finished upload.
+ */
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <PerfCounters.h>
+#include <SerialSession.h>
+#include <SimulatedEEPROM.h>
+#include <WriteCycle.h>
+
+#include "MicrocodeFiles.h"
+#include "SerialPort.h"
+
+static volatile sig_atomic_t running = 1;
+
+static void stop(int) {
+    running = 0;
+}
+
+/**
+ * Same as the Arduino's EEPROMWriteCycleBus, but the time is the real time of the host.
+ */
+struct RealTimeWriteCycleBus {
+    SimulatedEEPROM& eeprom;
+    uint64_t startUs;
+    uint32_t address;
+
+    uint8_t readData() {
+        return eeprom.read(address, micros());
+    }
+
+    uint32_t micros() {
+        return hostMicros() - startUs;
+    }
+
+    void delayMilliseconds(const uint16_t& ms) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+};
+
+/**
+ * The Device of the SerialSession. The serial port is the master side of the pseudo terminal.
+ * The stand-in has no pins, so only SERIAL and WRITE_WAIT of its performance counters are measured, in microseconds of the host
+ * (its clock is 1 MHz in STATS_END).
+ */
+struct StandInDevice {
+    int fd;
+    SimulatedEEPROM& eeprom;
+    uint64_t startUs;
+    WriteCycleConfig writeCycleConfig;
+    std::vector<uint8_t> verifyImage;
+    uint8_t pending[256];
+    int pendingLength;
+    int pendingIndex;
+    WriteCyclePoller writeCyclePoller;
+    uint16_t pendingAddress;
+    uint8_t pendingData;
+    bool pendingWritten;
+    PerfCounters perfCounters;
+    uint64_t writeStartUs;
+
+    int available() {
+
+        if (pendingIndex < pendingLength)
+            return pendingLength - pendingIndex;
+
+        ssize_t result = ::read(fd, pending, sizeof(pending));
+        pendingIndex = 0;
+        pendingLength = result > 0 ? result : 0;
+
+        return pendingLength;
+    }
+
+    int read() {
+        return pendingIndex < pendingLength ? pending[pendingIndex++] : -1;
+    }
+
+    void write(const uint8_t* bytes, const uint8_t& length) {
+
+        uint8_t written = 0;
+        uint64_t startUs = hostMicros();
+
+        while (written < length) {
+            ssize_t result = ::write(fd, bytes + written, length - written);
+
+            if (result > 0)
+                written += result;
+        }
+
+        perfCounters.record(PERF_SERIAL, hostMicros() - startUs);
+    }
+
+    uint32_t millis() {
+        return (hostMicros() - startUs) / 1000;
+    }
+
+    /**
+     * Same as the programmer's startEEPROMBytes() in differential mode. Only a single byte per call (no page write).
+     */
+    uint8_t startBytes(const uint16_t& address, const uint8_t* data, const uint8_t& length) {
+
+        (void) length;
+        RealTimeWriteCycleBus bus = {eeprom, startUs, address};
+        pendingAddress = address;
+        pendingData = data[0];
+        pendingWritten = eeprom.read(address, bus.micros()) != data[0];
+
+        if (pendingWritten) {
+            eeprom.write(address, data[0], bus.micros());
+            writeCyclePoller.begin(bus.micros(), data[0], writeCycleConfig);
+            writeStartUs = hostMicros();
+        }
+
+        return 1;
+    }
+
+    bool pollBytes(uint8_t* results) {
+
+        RealTimeWriteCycleBus bus = {eeprom, startUs, pendingAddress};
+
+        if (!writeCyclePoller.poll(bus))
+            return false;
+
+        if (!pendingWritten) {
+            results[0] = PROGRAM_BYTE_SKIPPED;
+        } else {
+            perfCounters.record(PERF_WRITE_WAIT, hostMicros() - writeStartUs);
+            results[0] = eeprom.read(pendingAddress, bus.micros()) == pendingData ? PROGRAM_BYTE_WRITTEN : PROGRAM_BYTE_FAILED;
+        }
+
+        return true;
+    }
+
+    /**
+     * The stand-in has no shift registers.
+     */
+    void prepareBytes(const uint16_t& address) {
+        (void) address;
+    }
+
+    void readBytes(const uint16_t& address, uint8_t* buffer, const uint8_t& length) {
+
+        uint32_t nowUs = hostMicros() - startUs;
+
+        for (uint8_t i = 0; i < length; ++i)
+            buffer[i] = eeprom.read(address + i, nowUs);
+    }
+
+    uint16_t verifyImageSize(const uint8_t& image) {
+        return image == 1 ? verifyImage.size() : 0;
+    }
+
+    uint16_t verifyBytes(const uint8_t& image, const uint16_t& address, const uint16_t& length, uint8_t* bitmap, uint32_t& crc) {
+
+        uint32_t nowUs = hostMicros() - startUs;
+        uint16_t mismatches = 0;
+
+        for (uint16_t i = 0; i < length; ++i) {
+            uint8_t data = eeprom.read(address + i, nowUs);
+            crc = crc32Update(crc, data);
+
+            if (image != VERIFY_IMAGE_NONE && data != verifyImage[address + i]) {
+                bitmap[i >> 3] |= 0x80 >> (i & 7);
+                mismatches++;
+            }
+        }
+
+        return mismatches;
+    }
+
+    /**
+     * The stand-in has no pins, so its trace is always empty. The pins are traced by board_benchmark --trace.
+     */
+    uint16_t traceLength() {
+        return 0;
+    }
+
+    uint32_t traceOverwritten() {
+        return 0;
+    }
+
+    void readTraceEvent(const uint16_t& index, uint8_t* out) {
+        (void) index;
+        (void) out;
+    }
+
+    void clearTrace() {
+    }
+
+    uint8_t perfOperations() {
+        return PERF_OPERATIONS;
+    }
+
+    void readPerfCounter(const uint8_t& operation, uint8_t* out) {
+        encodePerfCounter(perfCounters.get(operation), out);
+    }
+
+    uint32_t perfClockHz() {
+        return 1000000;
+    }
+
+    void clearPerfCounters() {
+        perfCounters.clear();
+    }
+};
+
+static bool saveImage(const std::string& path, SimulatedEEPROM& eeprom) {
+
+    std::ofstream file(path.c_str(), std::ios::binary);
+
+    for (uint32_t address = 0; address < eeprom.getSize(); ++address)
+        file.put(eeprom.peek(address));
+
+    return (bool) file;
+}
+
+int main(int argc, char** argv) {
+
+    uint32_t size = 2048;
+    uint32_t writeCycleUs = 1000;
+    bool polling = true;
+    bool once = false;
+    std::string imagePath;
+    std::string verifyImagePath;
+
+    for (int i = 1; i < argc; ++i) {
+
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+            size = strtoul(argv[++i], 0, 0);
+        else if (strcmp(argv[i], "--write-cycle-us") == 0 && i + 1 < argc)
+            writeCycleUs = strtoul(argv[++i], 0, 0);
+        else if (strcmp(argv[i], "--image") == 0 && i + 1 < argc)
+            imagePath = argv[++i];
+        else if (strcmp(argv[i], "--verify-image") == 0 && i + 1 < argc)
+            verifyImagePath = argv[++i];
+        else if (strcmp(argv[i], "--no-polling") == 0)
+            polling = false;
+        else if (strcmp(argv[i], "--once") == 0)
+            once = true;
+        else {
+            fprintf(stderr, "Usage: nano_standin [--size N] [--write-cycle-us N] [--no-polling] [--image out.bin] [--verify-image in.bin] [--once]\n");
+            return 2;
+        }
+    }
+
+    std::vector<uint8_t> verifyImage;
+
+    if (!verifyImagePath.empty() && (!readBinaryFile(verifyImagePath, verifyImage) || verifyImage.size() > 0xFFFF)) {
+        fprintf(stderr, "Can't read %s\n", verifyImagePath.c_str());
+        return 1;
+    }
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        perror("posix_openpt");
+        return 1;
+    }
+
+    std::string slavePath = ptsname(master);
+
+    /**
+     * The slave is kept open, so the master doesn't get an error when the host tool closes it.
+     * It is also switched to raw mode, otherwise the terminal would echo the frames back.
+     */
+    int slave = open(slavePath.c_str(), O_RDWR | O_NOCTTY);
+    termios options;
+    tcgetattr(slave, &options);
+    cfmakeraw(&options);
+    tcsetattr(slave, TCSANOW, &options);
+
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    SimulatedEEPROM eeprom(size, writeCycleUs);
+    eeprom.setDataPolling(polling);
+    eeprom.setToggleBit(polling);
+
+    StandInDevice device = {master, eeprom, hostMicros(),
+                            {WRITE_CYCLE_DATA_POLLING | WRITE_CYCLE_TOGGLE_BIT, WRITE_CYCLE_DEFAULT_TIMEOUT_US, WRITE_CYCLE_DEFAULT_FALLBACK_DELAY_MS},
+                            verifyImage, {}, 0, 0, WriteCyclePoller(), 0, 0, false, PerfCounters(), 0};
+    SerialSession<StandInDevice> session(device);
+
+    printf("%s\n", slavePath.c_str());
+    fflush(stdout);
+
+    while (running) {
+        session.poll();
+
+        if (once && session.isFinished())
+            break;
+
+        if (device.pendingIndex >= device.pendingLength)
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    /**
+     * Lets the host read the last frame before the pseudo terminal is closed.
+     */
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    eeprom.isBusy(device.millis() * 1000 + 1000000);
+
+    if (!imagePath.empty() && !saveImage(imagePath, eeprom)) {
+        fprintf(stderr, "Can't save %s\n", imagePath.c_str());
+        return 1;
+    }
+
+    close(slave);
+    close(master);
+    return 0;
+}
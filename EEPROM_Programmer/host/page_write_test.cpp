@@ -0,0 +1,237 @@
+/**
+ * Checks the chip profiles (ChipProfile.h) and the page write of the 28C64 and 28C256:
+ * - The simulated chip (SimulatedEEPROM.h) - The loads within tBLC are written with a single write cycle. A load after tBLC
+ *   is ignored, because the write cycle has already started. A byte from another page is written in the loaded page.
+ * - EEPROMProgrammer on the simulated board - Every page is written with one write cycle and without any error of the chip,
+ *   also when the Nano is too slow to load the next byte within tBLC and the page must be split.
+ */
+
+#include <vector>
+
+#include <ShiftRegister.h>
+#include <EEPROMProgrammer.h>
+#include <SimulatedBoard.h>
+
+#include "HostTest.h"
+
+/**
+ * The wiring of the programmer (main.cpp).
+ */
+#define EEPROM_WE_PIN 13
+#define SHIFT_REGISTER_SER_PIN 2
+#define SHIFT_REGISTER_RCLK_PIN 3
+#define SHIFT_REGISTER_SR_CLK_PIN 4
+#define SHIFT_REGISTER_CHAIN_LENGTH 2
+
+static void testProfiles() {
+
+    CHECK_EQUAL(chipSize(CHIP_28C16), 2048);
+    CHECK_EQUAL(chipSize(CHIP_28C64), 8192);
+    CHECK_EQUAL(chipSize(CHIP_28C256), 32768);
+    CHECK(!hasPageWrite(CHIP_28C16));
+    CHECK(hasPageWrite(CHIP_28C64) && hasPageWrite(CHIP_28C256));
+
+    for (uint16_t address = 0; address < 256; ++address) {
+        CHECK_EQUAL(bytesToPageEnd(CHIP_28C16, address), 1);
+        CHECK_EQUAL(bytesToPageEnd(CHIP_28C64, address), 64 - address % 64);
+    }
+
+    CHECK_EQUAL(bytesToPageEnd(CHIP_28C256, 0x7FFF), 1);
+    CHECK_EQUAL(writeCycleDelayMs(CHIP_28C64), 11);
+}
+
+static SimulatedEEPROM pageChip(const ChipProfile& chip) {
+
+    SimulatedEEPROM eeprom(chipSize(chip), chip.writeCycleUs);
+    eeprom.setPageMode(chip.pageSize, chip.byteLoadCycleUs);
+
+    return eeprom;
+}
+
+static void testPageLoads() {
+
+    SimulatedEEPROM eeprom = pageChip(CHIP_28C64);
+    uint32_t nowUs = 0;
+
+    for (uint8_t i = 0; i < 4; ++i) {
+        CHECK(eeprom.write(128 + i, i + 1, nowUs));
+        nowUs += 100;
+    }
+
+    /**
+     * Nothing is written until tBLC after the last load.
+     */
+    CHECK(!eeprom.isBusy(nowUs - 100 + CHIP_28C64.byteLoadCycleUs - 1));
+    CHECK_EQUAL(eeprom.getWriteCycles(), 0);
+    CHECK(eeprom.isBusy(nowUs - 100 + CHIP_28C64.byteLoadCycleUs));
+    CHECK_EQUAL(eeprom.getWriteCycles(), 1);
+
+    nowUs += CHIP_28C64.byteLoadCycleUs + CHIP_28C64.writeCycleUs;
+    CHECK(!eeprom.isBusy(nowUs));
+
+    for (uint8_t i = 0; i < 4; ++i)
+        CHECK_EQUAL(eeprom.peek(128 + i), i + 1);
+
+    CHECK_EQUAL(eeprom.getWrites(), 4);
+    CHECK_EQUAL(eeprom.getIgnoredWrites(), 0);
+    CHECK_EQUAL(eeprom.getPageBoundaryErrors(), 0);
+}
+
+/**
+ * A load later than tBLC comes during the write cycle of the previous ones.
+ */
+static void testLateLoad() {
+
+    SimulatedEEPROM eeprom = pageChip(CHIP_28C256);
+
+    CHECK(eeprom.write(0, 0x11, 0));
+    CHECK(!eeprom.write(1, 0x22, CHIP_28C256.byteLoadCycleUs));
+    CHECK_EQUAL(eeprom.getIgnoredWrites(), 1);
+    CHECK_EQUAL(eeprom.getWriteCycles(), 1);
+
+    CHECK(!eeprom.isBusy(CHIP_28C256.byteLoadCycleUs + CHIP_28C256.writeCycleUs));
+    CHECK_EQUAL(eeprom.peek(0), 0x11);
+    CHECK_EQUAL(eeprom.peek(1), 0xFF);
+}
+
+/**
+ * The page address of the first load is used for all of them.
+ */
+static void testPageBoundary() {
+
+    SimulatedEEPROM eeprom = pageChip(CHIP_28C64);
+
+    CHECK(eeprom.write(62, 0x62, 0));
+    CHECK(eeprom.write(63, 0x63, 10));
+    CHECK(eeprom.write(64, 0x64, 20));
+    CHECK_EQUAL(eeprom.getPageBoundaryErrors(), 1);
+
+    CHECK(!eeprom.isBusy(20 + CHIP_28C64.byteLoadCycleUs + CHIP_28C64.writeCycleUs));
+    CHECK_EQUAL(eeprom.getWriteCycles(), 1);
+    CHECK_EQUAL(eeprom.peek(62), 0x62);
+    CHECK_EQUAL(eeprom.peek(63), 0x63);
+    CHECK_EQUAL(eeprom.peek(0), 0x64);
+    CHECK_EQUAL(eeprom.peek(64), 0xFF);
+}
+
+/**
+ * OE starts the write cycle right away, so the polling doesn't wait for tBLC.
+ */
+static void testReadStartsWriteCycle() {
+
+    SimulatedEEPROM eeprom = pageChip(CHIP_28C64);
+
+    CHECK(eeprom.write(5, 0x0F, 0));
+    CHECK_EQUAL(eeprom.read(5, 1) & DATA_POLLING_BIT, DATA_POLLING_BIT & ~0x0F);
+    CHECK_EQUAL(eeprom.getWriteCycles(), 1);
+    CHECK(eeprom.isBusy(CHIP_28C64.writeCycleUs));
+    CHECK(!eeprom.isBusy(1 + CHIP_28C64.writeCycleUs));
+    CHECK_EQUAL(eeprom.read(5, 1 + CHIP_28C64.writeCycleUs), 0x0F);
+}
+
+static std::vector<uint8_t> generateImage(const uint32_t& size, uint32_t seed) {
+
+    std::vector<uint8_t> image(size);
+
+    for (size_t i = 0; i < image.size(); ++i) {
+        seed = seed * 1103515245 + 12345;
+        image[i] = seed >> 16;
+    }
+
+    return image;
+}
+
+/**
+ * Programs the whole chip a page at a time with programEEPROMBytes(), starting in the middle of a page.
+ * @param clockHz The Nano's clock. A slow one can't load the next byte within tBLC.
+ * @return The write cycles of the chip.
+ */
+static uint32_t testProgrammer(const ChipProfile& chip, const uint32_t& clockHz) {
+
+    SimulatedEEPROM eeprom = pageChip(chip);
+    SimulatedBoardPins pins = {SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN, EEPROM_WE_PIN,
+                               SHIFT_REGISTER_CHAIN_LENGTH, chip.outputEnableBit};
+    SimulatedBoardTiming timing = SIMULATED_NANO_TIMING;
+    timing.clockHz = clockHz;
+    SimulatedBoard board(eeprom, pins, timing);
+    ShiftRegister<SimulatedBoard> shiftRegister(board, SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN,
+                                                SHIFT_REGISTER_CHAIN_LENGTH);
+    WriteCycleConfig polling = {WRITE_CYCLE_DATA_POLLING | WRITE_CYCLE_TOGGLE_BIT, WRITE_CYCLE_DEFAULT_TIMEOUT_US, writeCycleDelayMs(chip)};
+    EEPROMProgrammer<SimulatedBoard> programmer(board, shiftRegister, EEPROM_WE_PIN, polling, PROGRAMMING_FULL, chip);
+
+    programmer.begin();
+
+    uint32_t size = chipSize(chip);
+    std::vector<uint8_t> image = generateImage(size, size);
+    uint8_t results[EEPROM_MAX_PAGE_SIZE];
+    uint32_t start = chip.pageSize / 2;
+    uint32_t address = start;
+
+    while (address < size + start) {
+        uint16_t wrapped = address % size;
+        uint32_t length = size + start - address;
+        uint8_t count = programmer.programEEPROMBytes(wrapped, &image[wrapped], length < 255 ? length : 255, results);
+
+        CHECK_EQUAL(count, bytesToPageEnd(chip, wrapped) < length ? bytesToPageEnd(chip, wrapped) : length);
+
+        for (uint8_t i = 0; i < count; ++i)
+            CHECK_EQUAL(results[i], PROGRAM_BYTE_WRITTEN);
+
+        address += count;
+    }
+
+    bool matches = true;
+
+    for (uint32_t i = 0; i < size; ++i)
+        matches = matches && eeprom.peek(i) == image[i];
+
+    CHECK(matches);
+    CHECK_EQUAL(programmer.getStats().written, size);
+    CHECK_EQUAL(programmer.getStats().failed, 0);
+    CHECK_EQUAL(eeprom.getWrites(), size);
+    CHECK_EQUAL(eeprom.getIgnoredWrites(), 0);
+    CHECK_EQUAL(eeprom.getPageBoundaryErrors(), 0);
+    CHECK_EQUAL(board.getCounters().inhibitedWrites, 0);
+    CHECK_EQUAL(board.getCounters().busContentions, 0);
+
+    uint32_t writeCycles = eeprom.getWriteCycles();
+
+    /**
+     * Differential - the same image loads nothing, a single changed byte is a single write cycle.
+     */
+    programmer.setProgrammingMode(PROGRAMMING_DIFFERENTIAL);
+    programmer.beginProgramming();
+    image[size / 2] ^= 0xFF;
+
+    for (address = 0; address < size; )
+        address += programmer.programEEPROMBytes(address, &image[address], size - address < 255 ? size - address : 255);
+
+    CHECK_EQUAL(programmer.getStats().written, 1);
+    CHECK_EQUAL(programmer.getStats().skipped, size - 1);
+    CHECK_EQUAL(eeprom.getWriteCycles(), writeCycles + 1);
+    CHECK_EQUAL(eeprom.peek(size / 2), image[size / 2]);
+
+    return writeCycles;
+}
+
+int main() {
+
+    testProfiles();
+    testPageLoads();
+    testLateLoad();
+    testPageBoundary();
+    testReadStartsWriteCycle();
+
+    /**
+     * The start in the middle of a page adds one page.
+     */
+    CHECK_EQUAL(testProgrammer(CHIP_28C64, SIMULATED_NANO_TIMING.clockHz), chipSize(CHIP_28C64) / CHIP_28C64.pageSize + 1);
+    CHECK_EQUAL(testProgrammer(CHIP_28C256, SIMULATED_NANO_TIMING.clockHz), chipSize(CHIP_28C256) / CHIP_28C256.pageSize + 1);
+
+    /**
+     * At 1 MHz a load takes longer than tBLC, so each byte is its own write cycle, but none of them is lost.
+     */
+    CHECK(testProgrammer(CHIP_28C64, 1000000) > chipSize(CHIP_28C64) / CHIP_28C64.pageSize + 1);
+
+    return testResult();
+}
@@ -0,0 +1,133 @@
+/**
+ * Downloads the performance counters of the programmer (PERF_COUNTERS in main.cpp) and prints them as CSV (PerfReport.h).
+ * board_benchmark --perf prints the same report for the simulated board.
+ *
+ * Usage:
+ * perf_stats <port> [--clear] [--baud N] [--wait-ms N]
+ *
+ * --clear The counters on the programmer are reset after the download, so the next one has only the new activity.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <PerfCounters.h>
+
+#include "PerfReport.h"
+#include "SerialPort.h"
+
+#define DEFAULT_BAUD_RATE 1000000
+#define DEFAULT_WAIT_MS 5000
+#define REQUEST_RETRY_MS 250
+#define INACTIVITY_TIMEOUT_MS 1000
+
+static void printUsage() {
+    fprintf(stderr, "Usage: perf_stats <port> [--clear] [--baud N] [--wait-ms N]\n");
+}
+
+/**
+ * Receives the STATS_DATA frames until STATS_END.
+ */
+static bool downloadStats(SerialPort& port, const bool& clear, const int& waitMs, std::vector<PerfReportLine>& lines, uint32_t& clockHz) {
+
+    uint8_t payload = clear ? 1 : 0;
+    FrameDecoder decoder;
+    bool answered = false;
+
+    sendFrame(port, FRAME_STATS, 0, &payload, 1);
+    uint64_t lastActivity = hostMillis();
+    uint64_t lastRequest = lastActivity;
+    uint64_t giveUp = lastActivity + waitMs;
+
+    while (true) {
+        int byte = port.readByte(10);
+        uint64_t now = hostMillis();
+
+        if (!answered && now >= giveUp)
+            return false;
+
+        if (answered && now - lastActivity > INACTIVITY_TIMEOUT_MS)
+            return false;
+
+        if (byte < 0) {
+            if (!answered && now - lastRequest > REQUEST_RETRY_MS) {
+                sendFrame(port, FRAME_STATS, 0, &payload, 1);
+                lastRequest = now;
+            }
+
+            continue;
+        }
+
+        if (decoder.feed(byte) != FRAME_COMPLETE)
+            continue;
+
+        lastActivity = now;
+
+        const Frame& frame = decoder.getFrame();
+
+        if (frame.seq != 0)
+            continue;
+
+        if (frame.type == FRAME_STATS_DATA && frame.length >= 1 + FRAME_PERF_COUNTER_LENGTH) {
+            answered = true;
+            PerfReportLine line = {frame.payload[0], decodePerfCounter(frame.payload + 1)};
+            lines.push_back(line);
+        } else if (frame.type == FRAME_STATS_END && frame.length >= 5) {
+            clockHz = readUint32(frame.payload + 1);
+            return frame.payload[0] == lines.size();
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 2) {
+        printUsage();
+        return 2;
+    }
+
+    std::string portPath = argv[1];
+    bool clear = false;
+    uint32_t baudRate = DEFAULT_BAUD_RATE;
+    int waitMs = DEFAULT_WAIT_MS;
+
+    for (int i = 2; i < argc; ++i) {
+
+        if (strcmp(argv[i], "--clear") == 0)
+            clear = true;
+        else if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc)
+            baudRate = strtoul(argv[++i], 0, 0);
+        else if (strcmp(argv[i], "--wait-ms") == 0 && i + 1 < argc)
+            waitMs = atoi(argv[++i]);
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    SerialPort port;
+
+    if (!port.open(portPath, baudRate)) {
+        fprintf(stderr, "Can't open %s at %u baud.\n", portPath.c_str(), baudRate);
+        return 1;
+    }
+
+    std::vector<PerfReportLine> lines;
+    uint32_t clockHz = 0;
+
+    if (!downloadStats(port, clear, waitMs, lines, clockHz)) {
+        fprintf(stderr, "Can't download the counters.\n");
+        return 1;
+    }
+
+    if (lines.empty()) {
+        fprintf(stderr, "The programmer has no counters. Is PERF_COUNTERS enabled in main.cpp?\n");
+        return 0;
+    }
+
+    printPerfReport(lines, clockHz);
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * Checks requestVerify() (ProgrammerClient.h) against a scripted programmer on a pseudo terminal:
+ * - A long range, which the programmer reads longer than the retry interval, is requested only once.
+ * - A lost VERIFY (for example while the Nano resets) is sent again and answered.
+ * - A VERIFY_MAP followed by a long run of matching blocks doesn't time out.
+ * The time is real, the test takes a few seconds.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <poll.h>
+#include <string>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+#include "HostTest.h"
+#include "ProgrammerClient.h"
+
+#define LONG_RANGE 32768
+#define SHORT_RANGE 256
+
+/**
+ * How the scripted programmer answers.
+ * @param ignoredRequests How many VERIFY frames are lost before the first one is answered.
+ * @param mapBeforeMs The VERIFY_MAP of the first block is sent after that time. -1 for no mismatches.
+ * @param endAfterMs VERIFY_END is sent that much after the VERIFY_MAP (or the answered VERIFY).
+ */
+struct Script {
+    int ignoredRequests;
+    int mapBeforeMs;
+    int endAfterMs;
+};
+
+static void sleepMs(const int& ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static void writeFrame(const int& fd, const uint8_t& type, const uint8_t& seq, const uint8_t* payload, const uint8_t& length) {
+    uint8_t out[FRAME_MAX_LENGTH];
+    uint8_t outLength = encodeFrame(type, seq, payload, length, out);
+    ssize_t written = write(fd, out, outLength);
+    (void) written;
+}
+
+/**
+ * Answers the first VERIFY after the ignored ones and counts the repeated ones, until the client is @param done
+ * and everything it sent was read.
+ * @return The number of the received VERIFY frames.
+ */
+static int runProgrammer(const int& fd, const Script& script, const std::atomic<bool>& done) {
+
+    FrameDecoder decoder;
+    int requests = 0;
+    bool answered = false;
+
+    while (true) {
+        bool finished = done;
+        pollfd descriptor = {fd, POLLIN, 0};
+
+        if (poll(&descriptor, 1, 10) <= 0) {
+            if (finished)
+                break;
+
+            continue;
+        }
+
+        uint8_t byte;
+
+        if (read(fd, &byte, 1) != 1 || decoder.feed(byte) != FRAME_COMPLETE)
+            continue;
+
+        const Frame& frame = decoder.getFrame();
+
+        if (frame.type != FRAME_VERIFY)
+            continue;
+
+        requests++;
+
+        if (answered || requests <= script.ignoredRequests)
+            continue;
+
+        answered = true;
+        uint8_t seq = frame.seq;
+        uint16_t length = readUint16(frame.payload + 2);
+
+        if (script.mapBeforeMs >= 0) {
+            sleepMs(script.mapBeforeMs);
+            uint8_t map[3] = {0, 0, 0b10000000};
+            writeFrame(fd, FRAME_VERIFY_MAP, seq, map, sizeof(map));
+        }
+
+        sleepMs(script.endAfterMs);
+
+        uint8_t end[8];
+        writeUint16(end, length);
+        writeUint16(end + 2, script.mapBeforeMs >= 0 ? 1 : 0);
+        writeUint32(end + 4, 0x12345678);
+        writeFrame(fd, FRAME_VERIFY_END, seq, end, sizeof(end));
+    }
+
+    return requests;
+}
+
+/**
+ * @return The number of the VERIFY frames, which the programmer received. -1 if the answer wasn't received.
+ */
+static int verifyWith(const Script& script, const uint16_t& length, const int& waitMs) {
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+        return -1;
+
+    std::string slavePath = ptsname(master);
+    int slave = open(slavePath.c_str(), O_RDWR | O_NOCTTY);
+    termios options;
+    tcgetattr(slave, &options);
+    cfmakeraw(&options);
+    tcsetattr(slave, TCSANOW, &options);
+
+    SerialPort port;
+    CHECK(port.open(slavePath, 1000000));
+
+    int requests = 0;
+    std::atomic<bool> done(false);
+    std::thread programmer([&]() { requests = runProgrammer(master, script, done); });
+
+    VerifyAnswer answer;
+    bool verified = requestVerify(port, 7, 0, length, VERIFY_IMAGE_NONE, waitMs, answer);
+
+    done = true;
+    programmer.join();
+    port.close();
+    close(slave);
+    close(master);
+
+    if (!verified)
+        return -1;
+
+    CHECK_EQUAL(answer.length, length);
+    CHECK_EQUAL(answer.crc, 0x12345678);
+    CHECK_EQUAL(answer.mismatches.size(), script.mapBeforeMs >= 0 ? 1 : 0);
+
+    return requests;
+}
+
+int main() {
+
+    CHECK_EQUAL(verifyDurationMs(0), 0);
+    CHECK(verifyDurationMs(LONG_RANGE) > 1000);
+    CHECK(verifyDurationMs(SHORT_RANGE) < 100);
+
+    /**
+     * The programmer reads 32 KB for 800 ms. The old client gave up after waitMs and with a longer waitMs sent VERIFY again
+     * every 250 ms, so the programmer would read the range four times.
+     */
+    Script slow = {0, -1, 800};
+    CHECK_EQUAL(verifyWith(slow, LONG_RANGE, 200), 1);
+    CHECK_EQUAL(verifyWith(slow, LONG_RANGE, 1000), 1);
+
+    Script lost = {1, -1, 0};
+    CHECK_EQUAL(verifyWith(lost, SHORT_RANGE, 1000), 2);
+
+    /**
+     * The mismatch is in the first block and the other blocks match for longer than INACTIVITY_TIMEOUT_MS.
+     */
+    Script gap = {0, 0, 1200};
+    CHECK_EQUAL(verifyWith(gap, LONG_RANGE, 200), 1);
+
+    return testResult();
+}
@@ -0,0 +1,375 @@
+/**
+ * Runs the programmer's SerialSession (SerialSession.h) against an EEPROM in memory, which fails the writes of chosen addresses.
+ * Checks every field of RESULT and the NAK answers to broken, unexpected and repeated frames.
+ */
+
+#include <deque>
+#include <vector>
+
+#include <SerialSession.h>
+
+#include "HostTest.h"
+
+#define TEST_EEPROM_SIZE 256
+
+/**
+ * The SerialSession's Device. A write cycle programs a single byte and takes one extra poll.
+ * A failing address keeps its old data, a byte with the right data is skipped (differential programming).
+ */
+struct TestDevice {
+    std::deque<uint8_t> input;
+    FrameDecoder decoder;
+    std::vector<Frame> answers;
+    std::vector<uint8_t> memory;
+    std::vector<bool> failing;
+    uint32_t nowMs;
+    uint16_t pendingAddress;
+    uint8_t pendingData;
+    bool pendingPolled;
+
+    TestDevice() : memory(TEST_EEPROM_SIZE, 0xFF), failing(TEST_EEPROM_SIZE, false), nowMs(0), pendingAddress(0), pendingData(0),
+                   pendingPolled(false) {
+    }
+
+    int available() {
+        return input.size();
+    }
+
+    int read() {
+        uint8_t byte = input.front();
+        input.pop_front();
+        return byte;
+    }
+
+    void write(const uint8_t* bytes, const uint8_t& length) {
+        for (uint8_t i = 0; i < length; ++i) {
+            if (decoder.feed(bytes[i]) == FRAME_COMPLETE)
+                answers.push_back(decoder.getFrame());
+        }
+    }
+
+    uint32_t millis() {
+        return nowMs;
+    }
+
+    uint8_t startBytes(const uint16_t& address, const uint8_t* data, const uint8_t& length) {
+        (void) length;
+        pendingAddress = address;
+        pendingData = data[0];
+        pendingPolled = false;
+        return 1;
+    }
+
+    bool pollBytes(uint8_t* results) {
+
+        if (!pendingPolled) {
+            pendingPolled = true;
+            return false;
+        }
+
+        if (memory[pendingAddress] == pendingData) {
+            results[0] = PROGRAM_BYTE_SKIPPED;
+        } else if (failing[pendingAddress]) {
+            results[0] = PROGRAM_BYTE_FAILED;
+        } else {
+            memory[pendingAddress] = pendingData;
+            results[0] = PROGRAM_BYTE_WRITTEN;
+        }
+
+        return true;
+    }
+
+    void prepareBytes(const uint16_t& address) {
+        (void) address;
+    }
+
+    void readBytes(const uint16_t& address, uint8_t* buffer, const uint8_t& length) {
+        for (uint8_t i = 0; i < length; ++i)
+            buffer[i] = memory[address + i];
+    }
+
+    uint16_t verifyImageSize(const uint8_t& image) {
+        (void) image;
+        return 0;
+    }
+
+    uint16_t verifyBytes(const uint8_t& image, const uint16_t& address, const uint16_t& length, uint8_t* bitmap, uint32_t& crc) {
+        (void) image;
+        (void) bitmap;
+        crc = crc32(&memory[address], length, crc);
+        return 0;
+    }
+
+    uint16_t traceLength() {
+        return 0;
+    }
+
+    uint32_t traceOverwritten() {
+        return 0;
+    }
+
+    void readTraceEvent(const uint16_t& index, uint8_t* out) {
+        (void) index;
+        (void) out;
+    }
+
+    void clearTrace() {
+    }
+
+    uint8_t perfOperations() {
+        return 0;
+    }
+
+    void readPerfCounter(const uint8_t& operation, uint8_t* out) {
+        (void) operation;
+        (void) out;
+    }
+
+    uint32_t perfClockHz() {
+        return 16000000;
+    }
+
+    void clearPerfCounters() {
+    }
+};
+
+/**
+ * Sends the frame to the session and polls it until it has nothing more to do.
+ * @param corruptAt A byte of the frame, which is flipped on the line. -1 for none.
+ * @param sentLength Only that many bytes of the frame are sent. -1 for all of them.
+ */
+static void send(TestDevice& device, SerialSession<TestDevice>& session, const uint8_t& type, const uint8_t& seq, const uint8_t* payload,
+                 const uint8_t& length, const int& corruptAt = -1, const int& sentLength = -1) {
+
+    uint8_t frame[FRAME_MAX_LENGTH];
+    uint8_t frameLength = encodeFrame(type, seq, payload, length, frame);
+
+    if (corruptAt >= 0)
+        frame[corruptAt] ^= 0b00010000;
+
+    for (uint8_t i = 0; i < (sentLength >= 0 ? sentLength : frameLength); ++i)
+        device.input.push_back(frame[i]);
+
+    do {
+        session.poll();
+    } while (session.isProgramming() || !device.input.empty());
+
+    session.poll();
+}
+
+static void sendData(TestDevice& device, SerialSession<TestDevice>& session, const uint8_t& seq, const uint16_t& address,
+                     const std::vector<uint8_t>& image, const uint8_t& length, const int& corruptAt = -1) {
+
+    uint8_t payload[FRAME_MAX_PAYLOAD];
+    writeUint16(payload, address);
+
+    for (uint8_t i = 0; i < length; ++i)
+        payload[2 + i] = image[address + i];
+
+    send(device, session, FRAME_DATA, seq, payload, 2 + length, corruptAt);
+}
+
+static void sendBegin(TestDevice& device, SerialSession<TestDevice>& session, const uint16_t& length) {
+    uint8_t payload[4];
+    writeUint16(payload, 0);
+    writeUint16(payload + 2, length);
+    send(device, session, FRAME_BEGIN, 0, payload, sizeof(payload));
+}
+
+/**
+ * Checks that the last answer has the @param type and @param seq (and the @param reason of a NAK).
+ */
+static void checkAnswer(const TestDevice& device, const uint8_t& type, const uint8_t& seq, const int& reason = -1) {
+
+    if (!CHECK(!device.answers.empty()))
+        return;
+
+    const Frame& answer = device.answers.back();
+    CHECK_EQUAL(answer.type, type);
+    CHECK_EQUAL(answer.seq, seq);
+
+    if (reason >= 0 && CHECK_EQUAL(answer.length, 1))
+        CHECK_EQUAL(answer.payload[0], reason);
+}
+
+static void checkResult(const TestDevice& device, const uint8_t& seq, const uint16_t& written, const uint16_t& skipped, const uint16_t& failed) {
+
+    checkAnswer(device, FRAME_RESULT, seq);
+
+    if (device.answers.empty() || !CHECK_EQUAL(device.answers.back().length, 8))
+        return;
+
+    const uint8_t* payload = device.answers.back().payload;
+    CHECK_EQUAL(readUint16(payload), written);
+    CHECK_EQUAL(readUint16(payload + 2), skipped);
+    CHECK_EQUAL(readUint16(payload + 4), written + skipped);
+    CHECK_EQUAL(readUint16(payload + 6), failed);
+}
+
+static std::vector<uint8_t> testImage() {
+
+    std::vector<uint8_t> image(TEST_EEPROM_SIZE);
+
+    for (uint16_t address = 0; address < TEST_EEPROM_SIZE; ++address)
+        image[address] = address * 7 + 1;
+
+    return image;
+}
+
+/**
+ * 64 bytes: 8 already hold the image (skipped), 5 fail and the rest is written.
+ */
+static void testResultWithFailures() {
+
+    TestDevice device;
+    SerialSession<TestDevice> session(device);
+    std::vector<uint8_t> image = testImage();
+
+    for (uint16_t address = 0; address < 8; ++address)
+        device.memory[address * 8] = image[address * 8];
+
+    const uint16_t FAILING[] = {1, 2, 30, 33, 63};
+
+    for (uint16_t address : FAILING)
+        device.failing[address] = true;
+
+    sendBegin(device, session, 64);
+    checkAnswer(device, FRAME_ACK, 0);
+
+    sendData(device, session, 1, 0, image, 32);
+    checkAnswer(device, FRAME_ACK, 1);
+    sendData(device, session, 2, 32, image, 32);
+    checkAnswer(device, FRAME_ACK, 2);
+
+    send(device, session, FRAME_END, 3, 0, 0);
+    checkResult(device, 3, 64 - 8 - 5, 8, 5);
+    CHECK(session.isFinished());
+    CHECK_EQUAL(session.getStats().naks, 0);
+
+    for (uint16_t address = 0; address < 64; ++address)
+        CHECK_EQUAL(device.memory[address] == image[address], !device.failing[address]);
+
+    /**
+     * A repeated END (the RESULT was lost) is answered with the same RESULT.
+     */
+    device.answers.clear();
+    send(device, session, FRAME_END, 3, 0, 0);
+    checkResult(device, 3, 64 - 8 - 5, 8, 5);
+}
+
+/**
+ * More failures than written bytes, where the old verified (written + skipped - failed) went below 0.
+ */
+static void testResultMostlyFailed() {
+
+    TestDevice device;
+    SerialSession<TestDevice> session(device);
+    std::vector<uint8_t> image = testImage();
+
+    for (uint16_t address = 2; address < 32; ++address)
+        device.failing[address] = true;
+
+    sendBegin(device, session, 32);
+    sendData(device, session, 1, 0, image, 32);
+    send(device, session, FRAME_END, 2, 0, 0);
+    checkResult(device, 2, 2, 0, 30);
+
+    /**
+     * A new upload starts with zeroed counters. Everything is skipped now, except of the failing addresses.
+     */
+    sendBegin(device, session, 32);
+    sendData(device, session, 1, 0, image, 32);
+    send(device, session, FRAME_END, 2, 0, 0);
+    checkResult(device, 2, 0, 2, 30);
+}
+
+static void testNaks() {
+
+    TestDevice device;
+    SerialSession<TestDevice> session(device);
+    std::vector<uint8_t> image = testImage();
+
+    /**
+     * DATA and END before BEGIN.
+     */
+    sendData(device, session, 1, 0, image, 16);
+    checkAnswer(device, FRAME_NAK, 1, NAK_NO_SESSION);
+    send(device, session, FRAME_END, 1, 0, 0);
+    checkAnswer(device, FRAME_NAK, 1, NAK_NO_SESSION);
+
+    sendBegin(device, session, 48);
+    checkAnswer(device, FRAME_ACK, 0);
+
+    /**
+     * A flipped bit in the payload and in the CRC. The NAK carries the expected SEQ.
+     */
+    sendData(device, session, 1, 0, image, 16, FRAME_HEADER_LENGTH + 5);
+    checkAnswer(device, FRAME_NAK, 1, NAK_CRC);
+    sendData(device, session, 1, 0, image, 16, FRAME_HEADER_LENGTH + 2 + 16);
+    checkAnswer(device, FRAME_NAK, 1, NAK_CRC);
+    CHECK_EQUAL(device.memory[0], 0xFF);
+
+    /**
+     * A length above the maximum payload.
+     */
+    uint8_t tooLong[FRAME_MAX_LENGTH];
+    encodeFrame(FRAME_DATA, 1, &image[0], FRAME_MAX_PAYLOAD, tooLong);
+    tooLong[3] = FRAME_MAX_PAYLOAD + 1;
+    device.input.insert(device.input.end(), tooLong, tooLong + FRAME_HEADER_LENGTH);
+    session.poll();
+    checkAnswer(device, FRAME_NAK, 1, NAK_LENGTH);
+
+    /**
+     * DATA without the address.
+     */
+    send(device, session, FRAME_DATA, 1, &image[0], 1);
+    checkAnswer(device, FRAME_NAK, 1, NAK_LENGTH);
+
+    /**
+     * Skipped SEQ, then the right one and the same one again (its ACK was lost). The repeat is only acknowledged.
+     */
+    sendData(device, session, 2, 16, image, 16);
+    checkAnswer(device, FRAME_NAK, 2, NAK_SEQUENCE);
+    sendData(device, session, 1, 0, image, 16);
+    checkAnswer(device, FRAME_ACK, 1);
+    sendData(device, session, 1, 0, image, 16);
+    checkAnswer(device, FRAME_ACK, 1);
+
+    /**
+     * A frame cut in the middle is dropped after FRAME_TIMEOUT_MS, the next one is received.
+     */
+    uint8_t payload[2 + 16];
+    writeUint16(payload, 16);
+
+    for (uint8_t i = 0; i < 16; ++i)
+        payload[2 + i] = image[16 + i];
+
+    size_t answers = device.answers.size();
+    send(device, session, FRAME_DATA, 2, payload, sizeof(payload), -1, 10);
+    CHECK_EQUAL(device.answers.size(), answers);
+    device.nowMs += FRAME_TIMEOUT_MS + 1;
+    send(device, session, FRAME_DATA, 2, payload, sizeof(payload));
+    checkAnswer(device, FRAME_ACK, 2);
+
+    /**
+     * END with a wrong SEQ, then the right one.
+     */
+    send(device, session, FRAME_END, 4, 0, 0);
+    checkAnswer(device, FRAME_NAK, 4, NAK_SEQUENCE);
+    send(device, session, FRAME_END, 3, 0, 0);
+    checkResult(device, 3, 32, 0, 0);
+
+    CHECK_EQUAL(session.getStats().naks, 6);
+
+    for (uint16_t address = 0; address < 32; ++address)
+        CHECK_EQUAL(device.memory[address], image[address]);
+
+    CHECK_EQUAL(device.memory[32], 0xFF);
+}
+
+int main() {
+    testResultWithFailures();
+    testResultMostlyFailed();
+    testNaks();
+    return testResult();
+}
@@ -0,0 +1,469 @@
+/**
+ * Checks the pin level model of the programmer's board (SimulatedBoard.h), on which board_benchmark measures the drivers:
+ * - The 74HC595 chain - SRCLK shifts SER in, the outputs change only on RCLK.
+ * - WE and OE - A WE pulse with OE inactive writes the data bus, with OE active it is inhibited. The Nano and the chips
+ *   driving the bus at the same time are counted as bus contentions.
+ * - The counters and the simulated time of each HAL call.
+ * - The drivers on top of it - ShiftRegister in both modes, a write and read back with EEPROMProgrammer and programEEPROMPairBytes()
+ *   with two chips, one of them already up to date in the differential mode.
+ */
+
+#include <ShiftRegister.h>
+#include <EEPROMProgrammer.h>
+#include <SimulatedBoard.h>
+
+#include "HostTest.h"
+
+/**
+ * The wiring of the programmer (main.cpp).
+ */
+#define EEPROM_WE_PIN 13
+#define EEPROM_SECOND_WE_PIN 14
+#define SHIFT_REGISTER_SER_PIN 2
+#define SHIFT_REGISTER_RCLK_PIN 3
+#define SHIFT_REGISTER_SR_CLK_PIN 4
+#define SHIFT_REGISTER_CHAIN_LENGTH 2
+
+#define OUTPUT_DISABLED (0b1 << 11)
+
+static const SimulatedBoardPins PINS = {SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN, EEPROM_WE_PIN,
+                                        SHIFT_REGISTER_CHAIN_LENGTH, 11};
+
+/**
+ * Shifts the 16 bits MSB first pin by pin, without the driver.
+ */
+static void shiftWord(SimulatedBoard& board, const uint16_t& word) {
+
+    for (int8_t bit = 15; bit >= 0; --bit) {
+        board.write(SHIFT_REGISTER_SER_PIN, (word >> bit) & 0b1);
+        board.write(SHIFT_REGISTER_SR_CLK_PIN, HIGH);
+        board.write(SHIFT_REGISTER_SR_CLK_PIN, LOW);
+    }
+}
+
+static void latch(SimulatedBoard& board) {
+    board.write(SHIFT_REGISTER_RCLK_PIN, HIGH);
+    board.write(SHIFT_REGISTER_RCLK_PIN, LOW);
+}
+
+static void pulseWriteEnable(SimulatedBoard& board, const uint8_t& pin) {
+    board.write(pin, LOW);
+    board.write(pin, HIGH);
+}
+
+static void testChain() {
+
+    Simulated74HC595Chain chain(2);
+
+    chain.clock(true);
+    chain.clock(false);
+    chain.clock(true);
+    CHECK_EQUAL(chain.getShiftRegister(), 0b101);
+    CHECK_EQUAL(chain.getOutputs(), 0);
+
+    chain.latch();
+    CHECK_EQUAL(chain.getOutputs(), 0b101);
+
+    /**
+     * The first bit leaves the 16 bit chain after 16 clocks.
+     */
+    for (uint8_t i = 0; i < 13; ++i)
+        chain.clock(false);
+
+    CHECK_EQUAL(chain.getShiftRegister(), 0b1010000000000000);
+    chain.clock(false);
+    CHECK_EQUAL(chain.getShiftRegister(), 0b0100000000000000);
+    CHECK_EQUAL(chain.getOutputs(), 0b101);
+
+    Simulated74HC595Chain full(4);
+
+    for (uint8_t i = 0; i < 32; ++i)
+        full.clock(true);
+
+    full.latch();
+    CHECK_EQUAL(full.getOutputs(), 0xFFFFFFFF);
+}
+
+static void testShiftAndLatch() {
+
+    SimulatedEEPROM eeprom;
+    SimulatedBoard board(eeprom, PINS);
+
+    shiftWord(board, 0x0123);
+    CHECK_EQUAL(board.getChain().getShiftRegister(), 0x0123);
+    CHECK_EQUAL(board.getChain().getOutputs(), 0);
+    CHECK_EQUAL(board.getAddress(), 0);
+    CHECK_EQUAL(board.getCounters().shiftClocks, 16);
+    CHECK_EQUAL(board.getCounters().latches, 0);
+
+    latch(board);
+    CHECK_EQUAL(board.getChain().getOutputs(), 0x0123);
+    CHECK_EQUAL(board.getAddress(), 0x0123);
+    CHECK(board.isOutputEnabled());
+    CHECK_EQUAL(board.getCounters().latches, 1);
+
+    /**
+     * A level, which doesn't change, is not a toggle and doesn't clock anything.
+     */
+    uint64_t toggles = board.getCounters().pinToggles;
+    board.write(SHIFT_REGISTER_SR_CLK_PIN, LOW);
+    board.write(SHIFT_REGISTER_RCLK_PIN, LOW);
+    CHECK_EQUAL(board.getCounters().pinToggles, toggles);
+    CHECK_EQUAL(board.getCounters().shiftClocks, 16);
+
+    shiftWord(board, OUTPUT_DISABLED | 0x0456);
+    CHECK_EQUAL(board.getAddress(), 0x0123);
+    latch(board);
+    CHECK_EQUAL(board.getAddress(), 0x0456);
+    CHECK(!board.isOutputEnabled());
+}
+
+static void testWriteEnable() {
+
+    SimulatedEEPROM eeprom;
+    SimulatedBoard board(eeprom, PINS);
+
+    /**
+     * After the reset the chain's outputs are 0, so OE is active until the first latch.
+     */
+    board.write(EEPROM_WE_PIN, HIGH);
+    shiftWord(board, OUTPUT_DISABLED | 0x0010);
+    latch(board);
+    board.setDataBusDirection(DATA_BUS_OUTPUT);
+    board.writeDataBus(0x5A);
+    pulseWriteEnable(board, EEPROM_WE_PIN);
+
+    CHECK_EQUAL(board.getCounters().writePulses, 1);
+    CHECK_EQUAL(board.getCounters().inhibitedWrites, 0);
+    CHECK_EQUAL(board.getCounters().busContentions, 0);
+    CHECK_EQUAL(eeprom.getWrites(), 1);
+
+    board.delayMilliseconds(2);
+    CHECK(!eeprom.isBusy(board.micros()));
+    CHECK_EQUAL(eeprom.peek(0x0010), 0x5A);
+
+    /**
+     * OE active while the bus is an output - the Nano and the chip drive it both. The WE pulse is inhibited.
+     */
+    board.writeDataBus(0xA5);
+    shiftWord(board, 0x0020);
+    latch(board);
+    CHECK_EQUAL(board.getCounters().busContentions, 1);
+
+    pulseWriteEnable(board, EEPROM_WE_PIN);
+    CHECK_EQUAL(board.getCounters().writePulses, 1);
+    CHECK_EQUAL(board.getCounters().inhibitedWrites, 1);
+    CHECK_EQUAL(eeprom.getWrites(), 1);
+
+    board.delayMilliseconds(2);
+    CHECK(!eeprom.isBusy(board.micros()));
+    CHECK_EQUAL(eeprom.peek(0x0020), 0xFF);
+
+    /**
+     * The contention is counted once, not on each call while it lasts.
+     */
+    board.writeDataBus(0x00);
+    CHECK_EQUAL(board.getCounters().busContentions, 1);
+
+    board.setDataBusDirection(DATA_BUS_INPUT);
+    shiftWord(board, 0x0010);
+    latch(board);
+    CHECK_EQUAL(board.readDataBus(), 0x5A);
+
+    /**
+     * Nothing drives the bus - no pull-ups, thus 0.
+     */
+    shiftWord(board, OUTPUT_DISABLED | 0x0010);
+    latch(board);
+    CHECK_EQUAL(board.readDataBus(), 0);
+    CHECK_EQUAL(board.getCounters().busContentions, 1);
+}
+
+/**
+ * Each chip has its own WE and OE. Both outputs enabled is a contention too.
+ */
+static void testSecondEEPROM() {
+
+    SimulatedEEPROM first;
+    SimulatedEEPROM second;
+    SimulatedBoard board(first, PINS);
+    board.attachSecondEEPROM(second, EEPROM_SECOND_WE_PIN, 12);
+
+    board.write(EEPROM_WE_PIN, HIGH);
+    board.write(EEPROM_SECOND_WE_PIN, HIGH);
+    shiftWord(board, (0b11 << 11) | 0x0007);
+    latch(board);
+    board.setDataBusDirection(DATA_BUS_OUTPUT);
+    board.writeDataBus(0x42);
+    pulseWriteEnable(board, EEPROM_SECOND_WE_PIN);
+    board.delayMilliseconds(2);
+
+    CHECK(!second.isBusy(board.micros()));
+    CHECK_EQUAL(second.peek(0x0007), 0x42);
+    CHECK_EQUAL(first.getWrites(), 0);
+    CHECK_EQUAL(board.getCounters().busContentions, 0);
+
+    /**
+     * Both outputs enabled - each bit is LOW if any of the chips pulls it LOW (the first one is erased, 0xFF).
+     */
+    board.setDataBusDirection(DATA_BUS_INPUT);
+    shiftWord(board, 0x0007);
+    latch(board);
+    CHECK_EQUAL(board.getCounters().busContentions, 1);
+    CHECK_EQUAL(board.readDataBus(), 0xFF & 0x42);
+
+    shiftWord(board, (0b1 << 11) | 0x0007);
+    latch(board);
+    CHECK_EQUAL(board.readDataBus(), 0x42);
+    CHECK_EQUAL(board.getCounters().busContentions, 1);
+}
+
+/**
+ * Each HAL call costs its cycles of SIMULATED_NANO_TIMING.
+ */
+static void testTiming() {
+
+    SimulatedEEPROM eeprom;
+    SimulatedBoard board(eeprom, PINS);
+
+    board.write(SHIFT_REGISTER_SER_PIN, HIGH);
+    CHECK_EQUAL(board.getCounters().cycles, SIMULATED_NANO_TIMING.pinWriteCycles);
+
+    board.readDataBus();
+    CHECK_EQUAL(board.getCounters().cycles, SIMULATED_NANO_TIMING.pinWriteCycles + SIMULATED_NANO_TIMING.dataBusReadCycles);
+
+    uint64_t before = board.getCounters().cycles;
+    board.delayMilliseconds(1);
+    CHECK_EQUAL(board.getCounters().cycles - before, SIMULATED_NANO_TIMING.clockHz / 1000);
+    CHECK_EQUAL(board.cyclesToMicros(SIMULATED_NANO_TIMING.clockHz), 1000000);
+}
+
+/**
+ * The driver shifts only a changed word and ignores the uint32_t functions on a chain longer than SHIFT_REGISTER_MAX_CHAIN_LENGTH.
+ */
+static void testShiftRegister(const bool& spi) {
+
+    SimulatedEEPROM eeprom;
+    SimulatedBoard board(eeprom, PINS);
+    ShiftRegister<SimulatedBoard> bitBang(board, SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN, SHIFT_REGISTER_CHAIN_LENGTH);
+    ShiftRegister<SimulatedBoard> hardwareSpi(board, SHIFT_REGISTER_RCLK_PIN, SHIFT_REGISTER_CHAIN_LENGTH);
+    ShiftRegister<SimulatedBoard>& shiftRegister = spi ? hardwareSpi : bitBang;
+
+    shiftRegister.begin();
+    shiftRegister.write(0x1234);
+    CHECK_EQUAL(board.getChain().getOutputs(), 0x1234);
+    CHECK_EQUAL(board.getCounters().shiftClocks, 16);
+    CHECK_EQUAL(board.getCounters().latches, 1);
+
+    shiftRegister.write(0x1234);
+    CHECK_EQUAL(board.getCounters().shiftClocks, 16);
+    CHECK_EQUAL(board.getCounters().latches, 1);
+
+    shiftRegister.shift(0x0ABC);
+    CHECK_EQUAL(board.getChain().getOutputs(), 0x1234);
+    shiftRegister.write(0x0ABC);
+    CHECK_EQUAL(board.getChain().getOutputs(), 0x0ABC);
+    CHECK_EQUAL(board.getCounters().shiftClocks, 32);
+    CHECK_EQUAL(board.getCounters().latches, 2);
+
+    const uint8_t bytes[] = {0x0F, 0xF0};
+    shiftRegister.write(bytes);
+    CHECK_EQUAL(board.getChain().getOutputs(), 0x0FF0);
+
+    shiftRegister.write(0x0080, LSBFIRST);
+    CHECK_EQUAL(board.getChain().getOutputs(), 0x0001);
+
+    SimulatedBoardPins longPins = PINS;
+    longPins.chainLength = SHIFT_REGISTER_MAX_CHAIN_LENGTH + 1;
+    SimulatedBoard longBoard(eeprom, longPins);
+    ShiftRegister<SimulatedBoard> longChain(longBoard, SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN,
+                                            SHIFT_REGISTER_MAX_CHAIN_LENGTH + 1);
+
+    longChain.begin();
+    longChain.write(0xFFFFFFFF);
+    CHECK_EQUAL(longBoard.getCounters().shiftClocks, 0);
+    CHECK_EQUAL(longBoard.getCounters().latches, 0);
+
+    const uint8_t longBytes[SHIFT_REGISTER_MAX_CHAIN_LENGTH + 1] = {0xAA, 0x01, 0x02, 0x03, 0x04};
+    longChain.write(longBytes);
+    CHECK_EQUAL(longBoard.getCounters().shiftClocks, 8 * (SHIFT_REGISTER_MAX_CHAIN_LENGTH + 1));
+    CHECK_EQUAL(longBoard.getChain().getOutputs(), 0x01020304);
+}
+
+/**
+ * A write and a read back through EEPROMProgrammer never fight over the bus or pulse WE with OE active.
+ */
+static void testProgrammer() {
+
+    SimulatedEEPROM eeprom;
+    SimulatedBoard board(eeprom, PINS);
+    ShiftRegister<SimulatedBoard> shiftRegister(board, SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN,
+                                                SHIFT_REGISTER_CHAIN_LENGTH);
+    WriteCycleConfig polling = {WRITE_CYCLE_DATA_POLLING | WRITE_CYCLE_TOGGLE_BIT, WRITE_CYCLE_DEFAULT_TIMEOUT_US, WRITE_CYCLE_DEFAULT_FALLBACK_DELAY_MS};
+    EEPROMProgrammer<SimulatedBoard> programmer(board, shiftRegister, EEPROM_WE_PIN, polling, PROGRAMMING_FULL);
+
+    programmer.begin();
+
+    for (uint16_t address = 0; address < 64; ++address)
+        CHECK_EQUAL(programmer.programEEPROMAddressData(address, address * 3), PROGRAM_BYTE_WRITTEN);
+
+    uint8_t buffer[64];
+    programmer.readEEPROMRange(0, buffer, sizeof(buffer));
+
+    for (uint16_t address = 0; address < 64; ++address) {
+        CHECK_EQUAL(buffer[address], (uint8_t) (address * 3));
+        CHECK_EQUAL(eeprom.peek(address), (uint8_t) (address * 3));
+    }
+
+    CHECK_EQUAL(board.getCounters().writePulses, 64);
+    CHECK_EQUAL(board.getCounters().inhibitedWrites, 0);
+    CHECK_EQUAL(board.getCounters().busContentions, 0);
+    CHECK_EQUAL(programmer.getStats().written, 64);
+    CHECK_EQUAL(programmer.getStats().failed, 0);
+}
+
+static SimulatedEEPROM pairChip(const ChipProfile& chip) {
+
+    SimulatedEEPROM eeprom(chipSize(chip), chip.writeCycleUs);
+
+    if (hasPageWrite(chip))
+        eeprom.setPageMode(chip.pageSize, chip.byteLoadCycleUs);
+
+    return eeprom;
+}
+
+/**
+ * Programs a different image to each chip with programEEPROMPairBytes().
+ * @return False if a result of @param firstResults or @param secondResults isn't @param firstExpected or @param secondExpected.
+ */
+static bool programPair(EEPROMProgrammer<SimulatedBoard>& programmer, const uint8_t* firstImage, const uint8_t* secondImage,
+                        const uint16_t& size, const uint8_t& firstExpected, const uint8_t& secondExpected) {
+
+    uint8_t firstResults[EEPROM_MAX_PAGE_SIZE];
+    uint8_t secondResults[EEPROM_MAX_PAGE_SIZE];
+    bool expected = true;
+
+    for (uint16_t address = 0; address < size; ) {
+        uint16_t rest = size - address;
+        uint8_t count = programmer.programEEPROMPairBytes(address, firstImage + address, secondImage + address, rest < 255 ? rest : 255,
+                                                         firstResults, secondResults);
+
+        if (count == 0)
+            return false;
+
+        for (uint8_t i = 0; i < count; ++i)
+            expected = expected && firstResults[i] == firstExpected && secondResults[i] == secondExpected;
+
+        address += count;
+    }
+
+    return expected;
+}
+
+/**
+ * Both chips get their own image on the shared address setup. Then in the differential mode only the first chip gets a new image,
+ * the second one, which is already up to date, isn't written at all.
+ */
+static void testPairProgrammer(const ChipProfile& chip) {
+
+    SimulatedEEPROM first = pairChip(chip);
+    SimulatedEEPROM second = pairChip(chip);
+    SimulatedBoardPins pins = {SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN, EEPROM_WE_PIN,
+                               SHIFT_REGISTER_CHAIN_LENGTH, chip.outputEnableBit};
+    SimulatedBoard board(first, pins);
+    board.attachSecondEEPROM(second, EEPROM_SECOND_WE_PIN, chip.outputEnableBit + 1);
+    ShiftRegister<SimulatedBoard> shiftRegister(board, SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN,
+                                                SHIFT_REGISTER_CHAIN_LENGTH);
+    WriteCycleConfig polling = {WRITE_CYCLE_DATA_POLLING | WRITE_CYCLE_TOGGLE_BIT, WRITE_CYCLE_DEFAULT_TIMEOUT_US, writeCycleDelayMs(chip)};
+    EEPROMProgrammer<SimulatedBoard> programmer(board, shiftRegister, EEPROM_WE_PIN, polling, PROGRAMMING_FULL, chip);
+
+    programmer.setSecondSocket(EEPROM_SECOND_WE_PIN, chip.outputEnableBit + 1);
+    programmer.begin();
+
+    const uint16_t size = 512;
+    uint8_t firstImage[size];
+    uint8_t secondImage[size];
+
+    for (uint16_t i = 0; i < size; ++i) {
+        firstImage[i] = i * 7;
+        secondImage[i] = ~(i * 13);
+    }
+
+    CHECK(programPair(programmer, firstImage, secondImage, size, PROGRAM_BYTE_WRITTEN, PROGRAM_BYTE_WRITTEN));
+
+    bool matches = true;
+
+    for (uint16_t i = 0; i < size; ++i)
+        matches = matches && first.peek(i) == firstImage[i] && second.peek(i) == secondImage[i];
+
+    CHECK(matches);
+    CHECK_EQUAL(programmer.getStats().written, 2 * size);
+    CHECK_EQUAL(programmer.getStats().failed, 0);
+    CHECK_EQUAL(first.getWrites(), size);
+    CHECK_EQUAL(second.getWrites(), size);
+    CHECK_EQUAL(board.getCounters().inhibitedWrites, 0);
+    CHECK_EQUAL(board.getCounters().busContentions, 0);
+
+    uint32_t secondWrites = second.getWrites();
+
+    programmer.setProgrammingMode(PROGRAMMING_DIFFERENTIAL);
+    programmer.beginProgramming();
+
+    for (uint16_t i = 0; i < size; ++i)
+        firstImage[i] ^= 0x5A;
+
+    CHECK(programPair(programmer, firstImage, secondImage, size, PROGRAM_BYTE_WRITTEN, PROGRAM_BYTE_SKIPPED));
+
+    matches = true;
+
+    for (uint16_t i = 0; i < size; ++i)
+        matches = matches && first.peek(i) == firstImage[i] && second.peek(i) == secondImage[i];
+
+    CHECK(matches);
+    CHECK_EQUAL(programmer.getStats().written, size);
+    CHECK_EQUAL(programmer.getStats().skipped, size);
+    CHECK_EQUAL(programmer.getStats().failed, 0);
+    CHECK_EQUAL(second.getWrites(), secondWrites);
+    CHECK_EQUAL(board.getCounters().inhibitedWrites, 0);
+    CHECK_EQUAL(board.getCounters().busContentions, 0);
+}
+
+/**
+ * Without setSecondSocket() nothing is written, so WE of the second socket isn't pulsed with the first chip selected.
+ */
+static void testPairWithoutSecondSocket() {
+
+    SimulatedEEPROM first;
+    SimulatedEEPROM second;
+    SimulatedBoard board(first, PINS);
+    board.attachSecondEEPROM(second, EEPROM_SECOND_WE_PIN, 12);
+    ShiftRegister<SimulatedBoard> shiftRegister(board, SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN,
+                                                SHIFT_REGISTER_CHAIN_LENGTH);
+    WriteCycleConfig polling = {WRITE_CYCLE_DATA_POLLING | WRITE_CYCLE_TOGGLE_BIT, WRITE_CYCLE_DEFAULT_TIMEOUT_US, WRITE_CYCLE_DEFAULT_FALLBACK_DELAY_MS};
+    EEPROMProgrammer<SimulatedBoard> programmer(board, shiftRegister, EEPROM_WE_PIN, polling, PROGRAMMING_FULL);
+
+    programmer.begin();
+
+    uint8_t data[4] = {1, 2, 3, 4};
+    CHECK_EQUAL(programmer.programEEPROMPairBytes(0, data, data, sizeof(data)), 0);
+    CHECK_EQUAL(board.getCounters().writePulses, 0);
+    CHECK_EQUAL(first.getWrites(), 0);
+    CHECK_EQUAL(second.getWrites(), 0);
+}
+
+int main() {
+
+    testChain();
+    testShiftAndLatch();
+    testWriteEnable();
+    testSecondEEPROM();
+    testTiming();
+    testShiftRegister(false);
+    testShiftRegister(true);
+    testProgrammer();
+    testPairProgrammer(CHIP_28C16);
+    testPairProgrammer(CHIP_28C64);
+    testPairWithoutSecondSocket();
+
+    return testResult();
+}
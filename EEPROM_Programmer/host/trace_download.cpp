@@ -0,0 +1,159 @@
+/**
+ * Downloads the pin trace of the programmer (PIN_TRACE in main.cpp), saves it as VCD and checks it against the AT28C16's write timing.
+ *
+ * Usage:
+ * trace_download <port> <out.vcd> [--clear] [--clock-mhz N] [--baud N] [--wait-ms N]
+ *
+ * --clear The trace on the programmer is emptied after the download, so the next one has only the new activity.
+ * --clock-mhz The CPU clock of the programmer, which is the unit of the timestamps. Default 16.
+ * Exits with 1 if a timing parameter is violated.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <PinTrace.h>
+
+#include "PinTraceFiles.h"
+#include "SerialPort.h"
+#include "TimingChecker.h"
+
+#define DEFAULT_BAUD_RATE 1000000
+#define DEFAULT_WAIT_MS 5000
+#define REQUEST_RETRY_MS 250
+#define INACTIVITY_TIMEOUT_MS 1000
+
+static void printUsage() {
+    fprintf(stderr, "Usage: trace_download <port> <out.vcd> [--clear] [--clock-mhz N] [--baud N] [--wait-ms N]\n");
+}
+
+/**
+ * Receives the TRACE_DATA frames until TRACE_END. The events must come in order, otherwise the download fails.
+ */
+static bool downloadTrace(SerialPort& port, const bool& clear, const int& waitMs, std::vector<PinTraceEvent>& events, uint16_t& overwritten) {
+
+    uint8_t payload = clear ? 1 : 0;
+    FrameDecoder decoder;
+    bool answered = false;
+
+    sendFrame(port, FRAME_TRACE, 0, &payload, 1);
+    uint64_t lastActivity = hostMillis();
+    uint64_t lastRequest = lastActivity;
+    uint64_t giveUp = lastActivity + waitMs;
+
+    while (true) {
+        int byte = port.readByte(10);
+        uint64_t now = hostMillis();
+
+        if (byte < 0) {
+            if (!answered && now >= giveUp)
+                return false;
+
+            if (answered && now - lastActivity > INACTIVITY_TIMEOUT_MS)
+                return false;
+
+            if (!answered && now - lastRequest > REQUEST_RETRY_MS) {
+                sendFrame(port, FRAME_TRACE, 0, &payload, 1);
+                lastRequest = now;
+            }
+
+            continue;
+        }
+
+        lastActivity = now;
+
+        if (decoder.feed(byte) != FRAME_COMPLETE)
+            continue;
+
+        const Frame& frame = decoder.getFrame();
+
+        if (frame.seq != 0)
+            continue;
+
+        if (frame.type == FRAME_TRACE_DATA && frame.length >= 2) {
+            answered = true;
+
+            if (readUint16(frame.payload) != events.size())
+                return false;
+
+            for (uint8_t offset = 2; offset + FRAME_TRACE_EVENT_LENGTH <= frame.length; offset += FRAME_TRACE_EVENT_LENGTH)
+                events.push_back(decodePinTraceEvent(frame.payload + offset));
+        } else if (frame.type == FRAME_TRACE_END && frame.length >= 4) {
+            overwritten = readUint16(frame.payload + 2);
+            return readUint16(frame.payload) == events.size();
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 3) {
+        printUsage();
+        return 2;
+    }
+
+    std::string portPath = argv[1];
+    std::string outPath = argv[2];
+    bool clear = false;
+    uint32_t clockMhz = 16;
+    uint32_t baudRate = DEFAULT_BAUD_RATE;
+    int waitMs = DEFAULT_WAIT_MS;
+
+    for (int i = 3; i < argc; ++i) {
+
+        if (strcmp(argv[i], "--clear") == 0)
+            clear = true;
+        else if (strcmp(argv[i], "--clock-mhz") == 0 && i + 1 < argc)
+            clockMhz = strtoul(argv[++i], 0, 0);
+        else if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc)
+            baudRate = strtoul(argv[++i], 0, 0);
+        else if (strcmp(argv[i], "--wait-ms") == 0 && i + 1 < argc)
+            waitMs = atoi(argv[++i]);
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (clockMhz == 0) {
+        printUsage();
+        return 2;
+    }
+
+    SerialPort port;
+
+    if (!port.open(portPath, baudRate)) {
+        fprintf(stderr, "Can't open %s at %u baud.\n", portPath.c_str(), baudRate);
+        return 1;
+    }
+
+    std::vector<PinTraceEvent> events;
+    uint16_t overwritten = 0;
+
+    if (!downloadTrace(port, clear, waitMs, events, overwritten)) {
+        fprintf(stderr, "Can't download the trace.\n");
+        return 1;
+    }
+
+    std::vector<TimedPinEvent> timed = unwrapPinTrace(events, clockMhz * 1000000);
+
+    if (!writeVCD(outPath, timed)) {
+        fprintf(stderr, "Can't write %s\n", outPath.c_str());
+        return 1;
+    }
+
+    printf("Trace: %zu events (%u older ones were overwritten) saved in %s\n", events.size(), overwritten, outPath.c_str());
+
+    if (events.empty()) {
+        printf("The trace is empty. Is PIN_TRACE enabled in main.cpp?\n");
+        return 0;
+    }
+
+    WriteTimingReport report = checkWriteTiming(timed);
+    printWriteTimingReport(report);
+
+    return report.violations.empty() ? 0 : 1;
+}
@@ -0,0 +1,377 @@
+/**
+ * Compares the upload of an image in plain DATA frames with DATA_PACKED frames (PackedImage.h).
+ * The whole upload is simulated: the host tool (one frame at a time, the next after the ACK), the serial line and
+ * the programmer's SerialSession with the drivers on the simulated board (SimulatedBoard.h). The total time includes the transfer
+ * and the burn, which overlap thanks to the double buffering. The numbers are deterministic.
+ *
+ * Only the pins and the serial line take simulated time. Reading the bytes from the UART and decoding the frames cost nothing.
+ *
+ * Usage:
+ * transfer_benchmark [--chip NAME] [--image in.bin] [--skip N] [--baud N] [--latency-us N]
+ *
+ * --chip The simulated EEPROM - 28C16 (default), 28C64 or 28C256.
+ * --image Only that image instead of the microcode of both EEPROMs and a random (incompressible) image of the chip's size.
+ * --skip The packed upload doesn't write the runs of that byte (see eeprom_upload --skip). The chip starts erased (0xFF).
+ * --baud Default 1000000, the programmer's BAUD_RATE.
+ * --latency-us From the last byte of the ACK until the host sends the next frame. USB serial adapters buffer the bytes
+ *              for up to a few milliseconds. Default 1000.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <SimulatedBoard.h>
+#include <ShiftRegister.h>
+#include <EEPROMProgrammer.h>
+#include <SerialSession.h>
+#include <PackedImage.h>
+#include <Microcode.h>
+
+#include "MicrocodeFiles.h"
+#include "SerialPort.h"
+
+/**
+ * The wiring of the programmer (main.cpp).
+ */
+#define EEPROM_WE_PIN 13
+#define SHIFT_REGISTER_SER_PIN 2
+#define SHIFT_REGISTER_RCLK_PIN 3
+#define SHIFT_REGISTER_SR_CLK_PIN 4
+#define SHIFT_REGISTER_CHAIN_LENGTH 2
+
+#define DEFAULT_BAUD_RATE 1000000
+#define DEFAULT_LATENCY_US 1000
+#define BITS_PER_BYTE 10
+
+/**
+ * How long the loop() sleeps when there is nothing to do (SERIAL_RECEIVE_INTERVAL_US in main.cpp).
+ */
+#define IDLE_INTERVAL_US 200
+
+/**
+ * An upload, which doesn't finish in that simulated time, is broken.
+ */
+#define MAX_UPLOAD_US 600000000.0
+
+static void printUsage() {
+    fprintf(stderr, "Usage: transfer_benchmark [--chip NAME] [--image in.bin] [--skip N] [--baud N] [--latency-us N]\n");
+}
+
+/**
+ * The SerialSession's Device. The serial port is the simulated line to the host, which answers each ACK with the next frame.
+ */
+struct SimulatedLink {
+    SimulatedBoard& board;
+    EEPROMProgrammer<SimulatedBoard>& programmer;
+    double byteUs;
+    double latencyUs;
+    std::vector<std::vector<uint8_t> > frames;
+    size_t nextFrame;
+    double lineFreeUs;
+    uint64_t sentBytes;
+    std::deque<std::pair<double, uint8_t> > incoming;
+    FrameDecoder hostDecoder;
+    bool finished;
+    Frame result;
+
+    double nowUs() const {
+        return board.cyclesToMicros(board.getCounters().cycles);
+    }
+
+    /**
+     * The host sends the next frame at @param atUs, but not before the previous one left the line.
+     */
+    void sendFrame(const size_t& index, const double& atUs) {
+
+        double timeUs = atUs > lineFreeUs ? atUs : lineFreeUs;
+
+        for (size_t i = 0; i < frames[index].size(); ++i) {
+            timeUs += byteUs;
+            incoming.push_back(std::make_pair(timeUs, frames[index][i]));
+        }
+
+        lineFreeUs = timeUs;
+        sentBytes += frames[index].size();
+    }
+
+    int available() {
+
+        double now = nowUs();
+        int count = 0;
+
+        while ((size_t) count < incoming.size() && incoming[count].first <= now)
+            count++;
+
+        return count;
+    }
+
+    int read() {
+        uint8_t byte = incoming.front().second;
+        incoming.pop_front();
+        return byte;
+    }
+
+    /**
+     * The answer reaches the host after its last byte. An ACK is followed by the next frame, a NAK by the same one again.
+     */
+    void write(const uint8_t* bytes, const uint8_t& length) {
+
+        double answeredUs = nowUs() + length * byteUs + latencyUs;
+
+        for (uint8_t i = 0; i < length; ++i) {
+            if (hostDecoder.feed(bytes[i]) != FRAME_COMPLETE)
+                continue;
+
+            const Frame& frame = hostDecoder.getFrame();
+
+            if (frame.type == FRAME_RESULT) {
+                result = frame;
+                finished = true;
+            } else if (frame.type == FRAME_ACK && nextFrame < frames.size()) {
+                sendFrame(nextFrame++, answeredUs);
+            } else if (frame.type == FRAME_NAK && nextFrame > 0) {
+                sendFrame(nextFrame - 1, answeredUs);
+            }
+        }
+    }
+
+    uint32_t millis() {
+        return nowUs() / 1000;
+    }
+
+    uint8_t startBytes(const uint16_t& address, const uint8_t* data, const uint8_t& length) {
+        return programmer.startEEPROMBytes(address, data, length);
+    }
+
+    bool pollBytes(uint8_t* results) {
+        return programmer.pollEEPROMBytes(results);
+    }
+
+    void prepareBytes(const uint16_t& address) {
+        programmer.prepareEEPROMBytes(address);
+    }
+
+    void readBytes(const uint16_t& address, uint8_t* buffer, const uint8_t& length) {
+        programmer.readEEPROMRange(address, buffer, length);
+    }
+
+    uint16_t verifyImageSize(const uint8_t& image) {
+        (void) image;
+        return 0;
+    }
+
+    uint16_t verifyBytes(const uint8_t& image, const uint16_t& address, const uint16_t& length, uint8_t* bitmap, uint32_t& crc) {
+        (void) image;
+        (void) bitmap;
+        crc = programmer.crc32EEPROMRange(address, length, crc);
+        return 0;
+    }
+
+    uint16_t traceLength() {
+        return 0;
+    }
+
+    uint32_t traceOverwritten() {
+        return 0;
+    }
+
+    void readTraceEvent(const uint16_t& index, uint8_t* out) {
+        (void) index;
+        (void) out;
+    }
+
+    void clearTrace() {
+    }
+
+    /**
+     * The counters of the simulated board are printed by board_benchmark --perf.
+     */
+    uint8_t perfOperations() {
+        return 0;
+    }
+
+    void readPerfCounter(const uint8_t& operation, uint8_t* out) {
+        (void) operation;
+        (void) out;
+    }
+
+    uint32_t perfClockHz() {
+        return SIMULATED_NANO_TIMING.clockHz;
+    }
+
+    void clearPerfCounters() {
+    }
+};
+
+static std::vector<uint8_t> frameBytes(const uint8_t& type, const uint8_t& seq, const uint8_t* payload, const uint8_t& length) {
+    uint8_t out[FRAME_MAX_LENGTH];
+    uint8_t outLength = encodeFrame(type, seq, payload, length, out);
+    return std::vector<uint8_t>(out, out + outLength);
+}
+
+/**
+ * The frames of eeprom_upload: BEGIN, DATA or DATA_PACKED (fillDataFrame()), END.
+ */
+static std::vector<std::vector<uint8_t> > uploadFrames(const std::vector<uint8_t>& image, const bool& packed, const int16_t& skipValue) {
+
+    std::vector<std::vector<uint8_t> > frames;
+    uint8_t payload[FRAME_MAX_PAYLOAD];
+    uint8_t seq = 0;
+
+    writeUint16(payload, 0);
+    writeUint16(payload + 2, image.size());
+    frames.push_back(frameBytes(FRAME_BEGIN, seq, payload, 4));
+
+    for (size_t offset = 0; offset < image.size();) {
+        uint8_t length;
+        uint32_t consumed;
+        uint8_t type = fillDataFrame(&image[offset], image.size() - offset, offset, packed, skipValue, payload, length, consumed);
+
+        frames.push_back(frameBytes(type, ++seq, payload, length));
+        offset += consumed;
+    }
+
+    frames.push_back(frameBytes(FRAME_END, ++seq, 0, 0));
+    return frames;
+}
+
+struct UploadOptions {
+    ChipProfile chip;
+    int16_t skipValue;
+    uint32_t baudRate;
+    double latencyUs;
+};
+
+/**
+ * Uploads the @param image on an erased chip and prints a line of the table.
+ * @return False if the chip doesn't hold the image (the skipped bytes excluded) or the upload didn't finish.
+ */
+static bool runUpload(const char* name, const std::vector<uint8_t>& image, const bool& packed, const UploadOptions& options) {
+
+    SimulatedEEPROM eeprom(chipSize(options.chip), options.chip.writeCycleUs);
+    eeprom.setPageMode(options.chip.pageSize, options.chip.byteLoadCycleUs);
+    SimulatedBoardPins pins = {SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN, EEPROM_WE_PIN, SHIFT_REGISTER_CHAIN_LENGTH,
+                               options.chip.outputEnableBit};
+    SimulatedBoard board(eeprom, pins);
+
+    ShiftRegister<SimulatedBoard> shiftRegister(board, SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN,
+                                                SHIFT_REGISTER_CHAIN_LENGTH);
+    WriteCycleConfig polling = {WRITE_CYCLE_DATA_POLLING | WRITE_CYCLE_TOGGLE_BIT, WRITE_CYCLE_DEFAULT_TIMEOUT_US, WRITE_CYCLE_DEFAULT_FALLBACK_DELAY_MS};
+    EEPROMProgrammer<SimulatedBoard> programmer(board, shiftRegister, EEPROM_WE_PIN, polling, PROGRAMMING_DIFFERENTIAL, options.chip);
+    programmer.begin();
+
+    SimulatedLink link = {board, programmer, 1000000.0 * BITS_PER_BYTE / options.baudRate, options.latencyUs,
+                          uploadFrames(image, packed, options.skipValue), 1, 0, 0, std::deque<std::pair<double, uint8_t> >(),
+                          FrameDecoder(), false, Frame()};
+    SerialSession<SimulatedLink> session(link);
+
+    double startUs = link.nowUs();
+    link.sendFrame(0, startUs);
+
+    while (!link.finished && link.nowUs() - startUs < MAX_UPLOAD_US) {
+        session.poll();
+
+        if (!session.isProgramming() && link.available() == 0)
+            board.delayMicroseconds(IDLE_INTERVAL_US);
+    }
+
+    bool same = link.finished;
+
+    for (size_t address = 0; address < image.size() && same; ++address)
+        same = eeprom.peek(address) == image[address] || (packed && image[address] == options.skipValue);
+
+    uint16_t written = link.finished ? readUint16(link.result.payload) : 0;
+    double lineMs = link.sentBytes * link.byteUs / 1000;
+
+    printf("%-10s %-8s %8zu %10llu %10.1f %10.1f %8u %8s\n", name, packed ? "packed" : "raw", link.frames.size(),
+           (unsigned long long) link.sentBytes, lineMs, (link.nowUs() - startUs) / 1000, written, same ? "ok" : "FAILED");
+
+    return same;
+}
+
+static std::vector<uint8_t> randomImage(const uint32_t& size) {
+
+    std::vector<uint8_t> image(size);
+    uint32_t seed = 0x2816;
+
+    for (size_t i = 0; i < image.size(); ++i) {
+        seed = seed * 1103515245 + 12345;
+        image[i] = seed >> 16;
+    }
+
+    return image;
+}
+
+int main(int argc, char** argv) {
+
+    UploadOptions options = {CHIP_28C16, PACKED_NO_SKIP, DEFAULT_BAUD_RATE, DEFAULT_LATENCY_US};
+    std::string imagePath;
+
+    for (int i = 1; i < argc; ++i) {
+
+        if (strcmp(argv[i], "--chip") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+
+            if (strcmp(name, CHIP_28C16.name) == 0)
+                options.chip = CHIP_28C16;
+            else if (strcmp(name, CHIP_28C64.name) == 0)
+                options.chip = CHIP_28C64;
+            else if (strcmp(name, CHIP_28C256.name) == 0)
+                options.chip = CHIP_28C256;
+            else {
+                printUsage();
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--image") == 0 && i + 1 < argc)
+            imagePath = argv[++i];
+        else if (strcmp(argv[i], "--skip") == 0 && i + 1 < argc)
+            options.skipValue = strtoul(argv[++i], 0, 0) & 0xFF;
+        else if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc)
+            options.baudRate = strtoul(argv[++i], 0, 0);
+        else if (strcmp(argv[i], "--latency-us") == 0 && i + 1 < argc)
+            options.latencyUs = atof(argv[++i]);
+        else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (options.baudRate == 0) {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<std::pair<std::string, std::vector<uint8_t> > > images;
+
+    if (!imagePath.empty()) {
+        std::vector<uint8_t> image;
+
+        if (!readBinaryFile(imagePath, image) || image.empty() || image.size() > chipSize(options.chip)) {
+            fprintf(stderr, "Can't read %s or it doesn't fit in the chip.\n", imagePath.c_str());
+            return 1;
+        }
+
+        images.push_back(std::make_pair(std::string("file"), image));
+    } else {
+        images.push_back(std::make_pair(std::string("first"), std::vector<uint8_t>(MicrocodeImage::first, MicrocodeImage::first + MICROCODE_IMAGE_SIZE)));
+        images.push_back(std::make_pair(std::string("second"), std::vector<uint8_t>(MicrocodeImage::second, MicrocodeImage::second + MICROCODE_IMAGE_SIZE)));
+        images.push_back(std::make_pair(std::string("random"), randomImage(chipSize(options.chip))));
+    }
+
+    printf("Chip: %s, %u baud, host latency: %.0f us\n", options.chip.name, options.baudRate, options.latencyUs);
+    printf("%-10s %-8s %8s %10s %10s %10s %8s %8s\n", "Image", "Frames", "Count", "Bytes", "Line ms", "Total ms", "Written", "Result");
+
+    bool ok = true;
+
+    for (size_t i = 0; i < images.size(); ++i) {
+        ok = runUpload(images[i].first.c_str(), images[i].second, false, options) && ok;
+        ok = runUpload(images[i].first.c_str(), images[i].second, true, options) && ok;
+    }
+
+    return ok ? 0 : 1;
+}
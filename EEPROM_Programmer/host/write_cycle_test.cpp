@@ -0,0 +1,145 @@
+/**
+ * Checks the detection of the end of the write cycle (WriteCycle.h) against the simulated chip (SimulatedEEPROM.h),
+ * which supports only one of the polling methods or none of them:
+ * - waitForWriteCycle() with DATA# Polling only and with Toggle Bit only ends right after tWC.
+ * - A write cycle longer than the timeout ends with the fallback delay.
+ * - WriteCyclePoller reaches its fallback delay the same way and stays busy until the delay is over.
+ */
+
+#include <SimulatedEEPROM.h>
+#include <WriteCycle.h>
+
+#include "HostTest.h"
+
+#define WRITE_CYCLE_US 1000
+#define READ_COST_US 4
+#define ADDRESS 0x123
+
+/**
+ * Bit 7 and bit 6 differ from the erased 0xFF, which the chip returns without the polling methods.
+ */
+#define DATA 0x35
+
+static SimulatedEEPROM pollingChip(const bool& dataPolling, const bool& toggleBit, const uint32_t& writeCycleUs) {
+
+    SimulatedEEPROM eeprom(2048, writeCycleUs);
+    eeprom.setDataPolling(dataPolling);
+    eeprom.setToggleBit(toggleBit);
+
+    return eeprom;
+}
+
+/**
+ * The chip supports only the polled @param method, so the other one can't end the wait.
+ */
+static void testSingleMethod(const uint8_t& method) {
+
+    SimulatedEEPROM eeprom = pollingChip(method == WRITE_CYCLE_DATA_POLLING, method == WRITE_CYCLE_TOGGLE_BIT, WRITE_CYCLE_US);
+    SimulatedClock clock = {0};
+    SimulatedWriteCycleBus bus = {eeprom, clock, ADDRESS, READ_COST_US};
+    WriteCycleConfig config = {method, WRITE_CYCLE_DEFAULT_TIMEOUT_US, WRITE_CYCLE_DEFAULT_FALLBACK_DELAY_MS};
+
+    CHECK(eeprom.write(ADDRESS, DATA, clock.nowUs));
+
+    WriteCycleResult result = waitForWriteCycle(bus, DATA, config);
+
+    CHECK(result.completed);
+    CHECK(result.elapsedUs >= WRITE_CYCLE_US);
+    CHECK(result.elapsedUs <= WRITE_CYCLE_US + 2 * READ_COST_US);
+    CHECK_EQUAL(result.polls, clock.nowUs / READ_COST_US);
+    CHECK(clock.nowUs < WRITE_CYCLE_US + 4 * READ_COST_US);
+    CHECK_EQUAL(eeprom.peek(ADDRESS), DATA);
+}
+
+/**
+ * The write cycle is longer than the timeout, so the polling gives up and waits the fallback delay.
+ */
+static void testFallback() {
+
+    const uint32_t timeoutUs = 2000;
+    SimulatedEEPROM eeprom = pollingChip(false, false, 5000);
+    SimulatedClock clock = {0};
+    SimulatedWriteCycleBus bus = {eeprom, clock, ADDRESS, READ_COST_US};
+    WriteCycleConfig config = {WRITE_CYCLE_DATA_POLLING | WRITE_CYCLE_TOGGLE_BIT, timeoutUs, WRITE_CYCLE_DEFAULT_FALLBACK_DELAY_MS};
+
+    CHECK(eeprom.write(ADDRESS, DATA, clock.nowUs));
+
+    WriteCycleResult result = waitForWriteCycle(bus, DATA, config);
+
+    CHECK(!result.completed);
+    CHECK(result.elapsedUs >= timeoutUs);
+    CHECK(result.elapsedUs < timeoutUs + READ_COST_US);
+    CHECK_EQUAL(clock.nowUs, result.elapsedUs + WRITE_CYCLE_DEFAULT_FALLBACK_DELAY_MS * 1000UL);
+    CHECK(!eeprom.isBusy(clock.nowUs));
+    CHECK_EQUAL(eeprom.peek(ADDRESS), DATA);
+
+    /**
+     * Only waiting - no reads at all.
+     */
+    uint32_t beforeUs = clock.nowUs;
+    config.methods = WRITE_CYCLE_FIXED_DELAY;
+    result = waitForWriteCycle(bus, DATA, config);
+
+    CHECK(!result.completed);
+    CHECK_EQUAL(result.polls, 0);
+    CHECK_EQUAL(clock.nowUs, beforeUs + WRITE_CYCLE_DEFAULT_FALLBACK_DELAY_MS * 1000UL);
+}
+
+/**
+ * Polls until the timeout, then only checks the time until the fallback delay is over. The caller's work between the polls
+ * takes @param idleUs (at least 1, the fallback delay doesn't read, so nothing else advances the clock).
+ */
+static void testPollerFallback(const uint32_t& idleUs) {
+
+    const uint32_t timeoutUs = 2000;
+    SimulatedEEPROM eeprom = pollingChip(false, false, 5000);
+    SimulatedClock clock = {0};
+    SimulatedWriteCycleBus bus = {eeprom, clock, ADDRESS, READ_COST_US};
+    WriteCycleConfig config = {WRITE_CYCLE_DATA_POLLING | WRITE_CYCLE_TOGGLE_BIT, timeoutUs, WRITE_CYCLE_DEFAULT_FALLBACK_DELAY_MS};
+    WriteCyclePoller poller;
+
+    CHECK(!poller.isBusy());
+    CHECK(eeprom.write(ADDRESS, DATA, clock.nowUs));
+    poller.begin(clock.nowUs, DATA, config);
+
+    uint16_t polls = 0;
+
+    while (!poller.poll(bus)) {
+        CHECK(poller.isBusy());
+        polls = poller.getResult().polls;
+        clock.advance(idleUs);
+    }
+
+    const WriteCycleResult& result = poller.getResult();
+
+    CHECK(!poller.isBusy());
+    CHECK(!result.completed);
+    CHECK_EQUAL(result.polls, polls);
+    CHECK(result.elapsedUs >= timeoutUs);
+    CHECK(result.elapsedUs < timeoutUs + READ_COST_US + idleUs);
+
+    /**
+     * The fallback delay counts from the last poll and ends on the first poll after it.
+     */
+    uint32_t fallbackUs = WRITE_CYCLE_DEFAULT_FALLBACK_DELAY_MS * 1000UL;
+    CHECK(clock.nowUs >= result.elapsedUs + fallbackUs);
+    CHECK(clock.nowUs < result.elapsedUs + fallbackUs + idleUs);
+    CHECK(!eeprom.isBusy(clock.nowUs));
+    CHECK_EQUAL(eeprom.peek(ADDRESS), DATA);
+
+    /**
+     * Idle - the next poll ends at once.
+     */
+    CHECK(poller.poll(bus));
+}
+
+int main() {
+
+    testSingleMethod(WRITE_CYCLE_DATA_POLLING);
+    testSingleMethod(WRITE_CYCLE_TOGGLE_BIT);
+    testFallback();
+    testPollerFallback(1);
+    testPollerFallback(100);
+
+    return testResult();
+}
@@ -0,0 +1,173 @@
+#include "CPUEmulator.h"
+
+#include <string.h>
+
+CPUEmulator::CPUEmulator(const uint8_t* firstImage, const uint8_t* secondImage, const uint16_t& imageSize, const uint8_t& steps)
+        : controlWords(imageSize),
+          busOutputs(imageSize),
+          addressMask(imageSize - 1),
+          steps(steps),
+          microsteps(0),
+          instructions(0),
+          busContentions(0),
+          firstContentionAddress(0) {
+
+    /**
+     * The control words and the number of outputs are prepared once, so a clock is only a lookup and the signals.
+     */
+    for (uint16_t address = 0; address < imageSize; ++address) {
+        controlWords[address] = (firstImage[address] << 8) | secondImage[address];
+        busOutputs[address] = countBusOutputs(controlWords[address]);
+    }
+
+    memset(&state, 0, sizeof(state));
+}
+
+void CPUEmulator::loadProgram(const uint8_t* program, const uint8_t& length) {
+
+    memset(state.ram, 0, sizeof(state.ram));
+    memcpy(state.ram, program, length < CPU_RAM_SIZE ? length : CPU_RAM_SIZE);
+}
+
+void CPUEmulator::reset() {
+
+    uint8_t ram[CPU_RAM_SIZE];
+    memcpy(ram, state.ram, sizeof(ram));
+    memset(&state, 0, sizeof(state));
+    memcpy(state.ram, ram, sizeof(ram));
+
+    outputs.clear();
+    microsteps = 0;
+    instructions = 0;
+    busContentions = 0;
+    firstContentionAddress = 0;
+}
+
+bool CPUEmulator::clock() {
+
+    if (state.halted)
+        return false;
+
+    uint16_t address = ((state.flags << MICROCODE_FLAGS_SHIFT) | (state.step << MICROCODE_CODE_BITS) | (state.ir >> 4)) & addressMask;
+    uint16_t controlWord = controlWords[address];
+
+    if (state.step == 0)
+        instructions++;
+
+    if (busOutputs[address] > 1 && busContentions++ == 0)
+        firstContentionAddress = address;
+
+    /**
+     * The ALU always calculates. SU subtracts with two's complement: A + ~B + 1.
+     */
+    uint16_t sum = controlWord & SU_CW ? state.a + (uint8_t) ~state.b + 1 : state.a + state.b;
+    uint8_t alu = sum;
+
+    uint8_t bus = 0;
+
+    if (controlWord & AO_CW)
+        bus |= state.a;
+
+    if (controlWord & EO_CW)
+        bus |= alu;
+
+    if (controlWord & RO_CW)
+        bus |= state.ram[state.mar];
+
+    if (controlWord & IO_CW)
+        bus |= state.ir & 0x0F;
+
+    if (controlWord & CO_CW)
+        bus |= state.pc;
+
+    state.bus = bus;
+
+    if (controlWord & HLT_CW) {
+        state.halted = true;
+        microsteps++;
+        return false;
+    }
+
+    /**
+     * Clock pulse. All inputs take the bus value at the same time, thus the RAM is written on the old MAR.
+     */
+    if (controlWord & RI_CW)
+        state.ram[state.mar] = bus;
+
+    if (controlWord & MI_CW)
+        state.mar = bus & CPU_RAM_ADDRESS_MASK;
+
+    if (controlWord & II_CW)
+        state.ir = bus;
+
+    if (controlWord & AI_CW)
+        state.a = bus;
+
+    if (controlWord & BI_CW)
+        state.b = bus;
+
+    if (controlWord & OI_CW) {
+        state.out = bus;
+        outputs.push_back(bus);
+    }
+
+    if (controlWord & EO_CW)
+        state.flags = (sum > 0xFF ? FLAG_CARRY : 0) | (alu == 0 ? FLAG_ZERO : 0);
+
+    if (controlWord & J_CW)
+        state.pc = bus & CPU_RAM_ADDRESS_MASK;
+    else if (controlWord & CE_CW)
+        state.pc = (state.pc + 1) & CPU_RAM_ADDRESS_MASK;
+
+    state.step = (controlWord & RS_CW) || state.step + 1 >= steps ? 0 : state.step + 1;
+    microsteps++;
+
+    return true;
+}
+
+uint64_t CPUEmulator::run(const uint64_t& maxMicrosteps) {
+
+    uint64_t start = microsteps;
+
+    while (microsteps - start < maxMicrosteps && clock());
+
+    return microsteps - start;
+}
+
+const CPUState& CPUEmulator::getState() const {
+    return state;
+}
+
+const std::vector<uint8_t>& CPUEmulator::getOutputs() const {
+    return outputs;
+}
+
+uint16_t CPUEmulator::getControlWord(const uint16_t& address) const {
+    return controlWords[address & addressMask];
+}
+
+uint64_t CPUEmulator::getMicrosteps() const {
+    return microsteps;
+}
+
+uint64_t CPUEmulator::getInstructions() const {
+    return instructions;
+}
+
+uint64_t CPUEmulator::getBusContentions() const {
+    return busContentions;
+}
+
+uint16_t CPUEmulator::getFirstContentionAddress() const {
+    return firstContentionAddress;
+}
+
+uint8_t CPUEmulator::countBusOutputs(const uint16_t& controlWord) {
+
+    uint8_t count = 0;
+
+    for (uint16_t outputs = controlWord & CPU_BUS_OUTPUTS; outputs; outputs &= outputs - 1)
+        count++;
+
+    return count;
+}
@@ -0,0 +1,116 @@
+#ifndef CPU_EMULATOR_H
+#define CPU_EMULATOR_H
+
+#include <stdint.h>
+#include <vector>
+
+#include <InstructionSet.h>
+#include <Microcode.h>
+
+/**
+ * Emulator of the 8-bit computer on the host. It doesn't know the instructions.
+ * Each clock the control word is read from the two microcode EEPROM images (the generated ones or a dump of the real chips)
+ * and the modules do exactly what the control signals tell them:
+ *
+ * - Outputs to the bus: AO (A register), EO (ALU), RO (RAM), IO (lower 4 bits of the Instruction Register), CO (Program Counter).
+ * - Inputs from the bus on the clock: MI, RI, II, AI, BI, OI, J. CE increments the Program Counter, HLT stops the clock.
+ * - RS clears the step counter on the clock instead of counting up.
+ * - SU makes the ALU subtract. The Flags register (carry, zero) is loaded together with EO.
+ *
+ * Microcode address: {Flags (2 bits)}{Step (3 bits)}{Upper 4 bits of the Instruction Register}
+ *
+ * More than one output in the same step is a bus contention. On the real board the result is undefined,
+ * here the values are OR-ed and the step is counted in getBusContentions().
+ */
+
+#define CPU_RAM_SIZE 16
+#define CPU_RAM_ADDRESS_MASK 0x0F
+
+#define CPU_BUS_OUTPUTS (AO_CW | EO_CW | RO_CW | IO_CW | CO_CW)
+
+struct CPUState {
+    uint8_t bus;
+    uint8_t a;
+    uint8_t b;
+    uint8_t ir;
+    uint8_t mar;
+    uint8_t pc;
+    uint8_t out;
+    uint8_t step;
+    uint8_t flags;
+    bool halted;
+    uint8_t ram[CPU_RAM_SIZE];
+};
+
+class CPUEmulator {
+
+public:
+
+    /**
+     * @param firstImage, secondImage The content of the two microcode EEPROMs.
+     * @param imageSize Size of each image. Must be a power of 2. The address lines above it are ignored.
+     * @param steps After that many steps the step counter starts from 0 even without RS. Like the fixed reset of the real step counter.
+     */
+    CPUEmulator(const uint8_t* firstImage, const uint8_t* secondImage, const uint16_t& imageSize, const uint8_t& steps = MICROCODE_STEPS);
+
+    /**
+     * Copies the program in the RAM. The rest of the RAM is 0.
+     */
+    void loadProgram(const uint8_t* program, const uint8_t& length);
+
+    /**
+     * Clears the registers, the step counter, the outputs and the counters. The RAM is kept like on the real board.
+     */
+    void reset();
+
+    /**
+     * Executes a single microstep (one clock).
+     * @return False if the computer is halted.
+     */
+    bool clock();
+
+    /**
+     * Clocks until HLT or until @param maxMicrosteps are executed.
+     * @return The executed microsteps.
+     */
+    uint64_t run(const uint64_t& maxMicrosteps);
+
+    const CPUState& getState() const;
+
+    /**
+     * Every value loaded in the Output register (OI) in order.
+     */
+    const std::vector<uint8_t>& getOutputs() const;
+
+    uint16_t getControlWord(const uint16_t& address) const;
+
+    uint64_t getMicrosteps() const;
+
+    uint64_t getInstructions() const;
+
+    uint64_t getBusContentions() const;
+
+    /**
+     * The microcode address of the first step with a bus contention. Valid only if getBusContentions() is not 0.
+     */
+    uint16_t getFirstContentionAddress() const;
+
+    static uint8_t countBusOutputs(const uint16_t& controlWord);
+
+private:
+
+    std::vector<uint16_t> controlWords;
+    std::vector<uint8_t> busOutputs;
+    uint16_t addressMask;
+    uint8_t steps;
+
+    CPUState state;
+    std::vector<uint8_t> outputs;
+
+    uint64_t microsteps;
+    uint64_t instructions;
+    uint64_t busContentions;
+    uint16_t firstContentionAddress;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef DATA_BUS_H
+#define DATA_BUS_H
+
+#include <stdint.h>
+
+/**
+ * Mapping between the EEPROM's data bus (I/O0-7) and the ATmega328's port registers.
+ *
+ * The data bus is connected to the Arduino Nano pins 5 - 12, where pin 5 is the most significant bit (I/O7)
+ * and pin 12 is the least significant bit (I/O0). That is the bit order of the pin by pin loops, which main.cpp used before the port mapping.
+ * On the ATmega328 the digital pins 0 - 7 are PORTD bits 0 - 7 and the pins 8 - 13 are PORTB bits 0 - 5.
+ *
+ * Pin:   5   6   7   8   9   10  11  12
+ * Port:  PD5 PD6 PD7 PB0 PB1 PB2 PB3 PB4
+ * Bit:   7   6   5   4   3   2   1   0
+ *
+ * The bits are in reversed order relative to the port bits, thus we reverse the byte first:
+ * reversed = b0 b1 b2 b3 b4 b5 b6 b7 (bit 7 to bit 0)
+ * PORTD bits 5 - 7 = reversed bits 0 - 2 = b7 b6 b5
+ * PORTB bits 0 - 4 = reversed bits 3 - 7 = b4 b3 b2 b1 b0
+ *
+ * Instead of 8 calls to pinMode() and digitalWrite() (or digitalRead()), a byte is moved with two masked port writes (or reads).
+ */
+
+#define DATA_BUS_FIRST_PIN 5
+#define DATA_BUS_LAST_PIN 12
+
+#define DATA_BUS_PORTD_MASK 0b11100000
+#define DATA_BUS_PORTB_MASK 0b00011111
+
+#define DATA_BUS_INPUT 0
+#define DATA_BUS_OUTPUT 1
+#define DATA_BUS_UNKNOWN 2
+
+/**
+ * Index is a 4 bit value, the element is the same value with reversed bit order. 0b0001 -> 0b1000
+ * A lookup is faster than shifting the bits one by one on the AVR.
+ */
+constexpr uint8_t DATA_BUS_NIBBLE_REVERSED[16] = {0b0000, 0b1000, 0b0100, 0b1100, 0b0010, 0b1010, 0b0110, 0b1110,
+                                                  0b0001, 0b1001, 0b0101, 0b1101, 0b0011, 0b1011, 0b0111, 0b1111};
+
+constexpr uint8_t reverseBits(uint8_t value) {
+    return (DATA_BUS_NIBBLE_REVERSED[value & 0b1111] << 4) | DATA_BUS_NIBBLE_REVERSED[value >> 4];
+}
+
+/**
+ * The part of the data byte, which must be written to PORTD (bits 5 - 7).
+ */
+constexpr uint8_t dataBusPortD(uint8_t data) {
+    return (reverseBits(data) & 0b111) << 5;
+}
+
+/**
+ * The part of the data byte, which must be written to PORTB (bits 0 - 4).
+ */
+constexpr uint8_t dataBusPortB(uint8_t data) {
+    return reverseBits(data) >> 3;
+}
+
+/**
+ * Constructs the data byte from the values of the PIND and PINB registers.
+ */
+constexpr uint8_t dataBusFromPorts(uint8_t pinD, uint8_t pinB) {
+    return reverseBits(((pinD & DATA_BUS_PORTD_MASK) >> 5) | ((pinB & DATA_BUS_PORTB_MASK) << 3));
+}
+
+/*---------------- Compile time check of the mapping ----------------*/
+
+/**
+ * The state of the @param pin after writing the value pin by pin.
+ * Pin 12 gets bit 0, pin 11 gets bit 1 ... pin 5 gets bit 7.
+ */
+constexpr bool digitalWriteBetweenPinState(uint8_t pin, uint8_t value) {
+    return (value >> (DATA_BUS_LAST_PIN - pin)) & 0b1;
+}
+
+/**
+ * The state of the @param pin after the masked port writes.
+ */
+constexpr bool dataBusPinState(uint8_t pin, uint8_t value) {
+    return pin < 8 ? (dataBusPortD(value) >> pin) & 0b1 : (dataBusPortB(value) >> (pin - 8)) & 0b1;
+}
+
+constexpr bool dataBusPinsMatch(uint8_t pin, uint8_t value) {
+    return pin > DATA_BUS_LAST_PIN ||
+           (digitalWriteBetweenPinState(pin, value) == dataBusPinState(pin, value) && dataBusPinsMatch(pin + 1, value));
+}
+
+/**
+ * Checks all of the 256 values. Split in two halves to keep the recursion depth low.
+ */
+constexpr bool dataBusMappingMatches(uint16_t value, uint16_t end) {
+    return value >= end ||
+           (dataBusPinsMatch(DATA_BUS_FIRST_PIN, value) &&
+            dataBusFromPorts(dataBusPortD(value), dataBusPortB(value)) == value &&
+            (dataBusPortD(value) & ~DATA_BUS_PORTD_MASK) == 0 &&
+            (dataBusPortB(value) & ~DATA_BUS_PORTB_MASK) == 0 &&
+            dataBusMappingMatches(value + 1, end));
+}
+
+static_assert(dataBusMappingMatches(0, 128), "The port mapping must set the pins exactly like the pin by pin write");
+static_assert(dataBusMappingMatches(128, 256), "The port mapping must set the pins exactly like the pin by pin write");
+
+#endif
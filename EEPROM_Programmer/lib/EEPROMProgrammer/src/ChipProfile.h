@@ -0,0 +1,68 @@
+#ifndef CHIP_PROFILE_H
+#define CHIP_PROFILE_H
+
+#include <stdint.h>
+
+/**
+ * The parallel EEPROMs of the 28C family have the same control pins (CE, OE, WE) and differ in:
+ * - Address width - 11 bits (2 KB) for the 28C16 up to 15 bits (32 KB) for the 28C256.
+ * - Page write - The 28C64B and 28C256 can load up to 64 bytes and write them with a single write cycle.
+ *   Each byte must be loaded within tBLC of the previous one, otherwise the chip starts the write cycle.
+ *   All of the bytes must be in the same page (A6 and up are the same).
+ * - Write cycle (tWC) - 1ms for the 28C16, 10ms for the bigger ones.
+ *
+ * On the programmer's board the address and OE come from the 74HC595 chain and WE is a pin of the Nano (its timing matters).
+ * The chain has 16 outputs, so OE is right above the address: 11 for the 28C16, 15 for the 28C256.
+ *
+ * @param addressBits Width of the address.
+ * @param outputEnableBit The bit of the shift word, which drives OE (active LOW).
+ * @param pageSize Bytes written with a single write cycle. 1 if the chip has no page write.
+ * @param writeCycleUs The maximum tWC.
+ * @param byteLoadCycleUs The maximum tBLC. 0 if the chip has no page write.
+ */
+struct ChipProfile {
+    const char* name;
+    uint8_t addressBits;
+    uint8_t outputEnableBit;
+    uint8_t pageSize;
+    uint16_t writeCycleUs;
+    uint16_t byteLoadCycleUs;
+};
+
+#define EEPROM_MAX_PAGE_SIZE 64
+
+constexpr ChipProfile CHIP_28C16 = {"28C16", 11, 11, 1, 1000, 0};
+constexpr ChipProfile CHIP_28C64 = {"28C64", 13, 13, 64, 10000, 150};
+constexpr ChipProfile CHIP_28C256 = {"28C256", 15, 15, 64, 10000, 150};
+
+constexpr uint32_t chipSize(const ChipProfile& chip) {
+    return 1UL << chip.addressBits;
+}
+
+constexpr bool hasPageWrite(const ChipProfile& chip) {
+    return chip.pageSize > 1;
+}
+
+/**
+ * The worst case from the last WE pulse until the end of the write cycle. A page is written only after tBLC.
+ */
+constexpr uint16_t writeCycleDelayMs(const ChipProfile& chip) {
+    return (chip.writeCycleUs + chip.byteLoadCycleUs + 999) / 1000;
+}
+
+/**
+ * How many bytes from @param address to the end of its page. 1 for chips without page write.
+ */
+constexpr uint8_t bytesToPageEnd(const ChipProfile& chip, uint16_t address) {
+    return hasPageWrite(chip) ? chip.pageSize - address % chip.pageSize : 1;
+}
+
+static_assert(CHIP_28C16.outputEnableBit >= CHIP_28C16.addressBits && CHIP_28C16.outputEnableBit < 16, "OE must be above the address in the 16 bit chain");
+static_assert(CHIP_28C64.outputEnableBit >= CHIP_28C64.addressBits && CHIP_28C64.outputEnableBit < 16, "OE must be above the address in the 16 bit chain");
+static_assert(CHIP_28C256.outputEnableBit >= CHIP_28C256.addressBits && CHIP_28C256.outputEnableBit < 16, "OE must be above the address in the 16 bit chain");
+static_assert(CHIP_28C64.pageSize <= EEPROM_MAX_PAGE_SIZE && CHIP_28C256.pageSize <= EEPROM_MAX_PAGE_SIZE, "The page must fit in the buffers");
+static_assert(bytesToPageEnd(CHIP_28C256, 0) == 64 && bytesToPageEnd(CHIP_28C256, 100) == 28 && bytesToPageEnd(CHIP_28C16, 100) == 1,
+              "Page boundaries");
+static_assert(writeCycleDelayMs(CHIP_28C16) == 1 && writeCycleDelayMs(CHIP_28C256) == 11, "Write cycle delay");
+
+#endif
@@ -0,0 +1,756 @@
+#ifndef EEPROM_PROGRAMMER_H
+#define EEPROM_PROGRAMMER_H
+
+#include <HAL.h>
+#include <DataBus.h>
+#include <ShiftRegister.h>
+#include <WriteCycle.h>
+#include <SerialProtocol.h>
+#include <PerfCounters.h>
+
+#include "ChipProfile.h"
+#include "ImageFingerprint.h"
+
+/**
+ * Driver of the 28C EEPROMs (see ChipProfile.h) through the programmer's board:
+ * - The address (A0-A10 for the AT28C16) and OE (bit 11 for the AT28C16, active LOW) are set through the chained 74HC595 shift registers.
+ * - The data bus (I/O0-7) and WE are connected directly to the Arduino.
+ * - CE is always LOW (enabled).
+ *
+ * Optionally a second socket (setSecondSocket()) shares the address, the data bus and the chain with the first one.
+ * It has its own WE pin and its own OE bit in the chain, so only the selected chip (selectSocket()) drives the bus when it is read.
+ * programEEPROMPairBytes() writes both chips on the same address setup: the data of the first chip is put on the bus and WE of the first
+ * is pulsed, then the same for the second. The chips latch the data on the rising edge of their WE, so the bus can be shared
+ * and both write cycles run at the same time. The two halves of the microcode are written in about the time of one.
+ *
+ * It is a template over the HAL (see HAL.h), so the same code runs on the Nano (ArduinoHAL) and on the host (SimulatedBoard).
+ */
+
+/**
+ * PROGRAMMING_FULL writes every byte.
+ * PROGRAMMING_DIFFERENTIAL reads the byte first and writes it only if it is different.
+ * When only a few microinstructions are changed, that skips the write cycle for almost all of the bytes.
+ */
+#define PROGRAMMING_FULL 0
+#define PROGRAMMING_DIFFERENTIAL 1
+
+/**
+ * The WE LOW pulse. The AT28C16 needs at least 100ns (tWP).
+ * With 0 there is no delay, the pulse is only as long as the two pin writes (~300ns on the Nano).
+ * The pin trace (PinTrace.h) shows if a shorter pulse still meets the timing.
+ */
+#define EEPROM_WRITE_PULSE_US 1
+
+/**
+ * The image is read back in chunks of that size, when its fingerprint is checked.
+ */
+#define EEPROM_FINGERPRINT_CHUNK_LENGTH 32
+
+#define EEPROM_SOCKET_FIRST 0
+#define EEPROM_SOCKET_SECOND 1
+
+/**
+ * Counters of a single programming. Reset with beginProgramming(). Each byte is in exactly one of written, skipped and failed.
+ * @param written Bytes, which were written and read back with the right data.
+ * @param skipped Bytes, which already had the right data and weren't written.
+ * @param verified Bytes, which hold the right data - written + skipped.
+ * @param failed Bytes, which were written, but read back with wrong data.
+ */
+struct ProgrammingStats {
+    uint16_t written;
+    uint16_t skipped;
+    uint16_t verified;
+    uint16_t failed;
+};
+
+template<typename HAL>
+class EEPROMProgrammer {
+
+public:
+
+    EEPROMProgrammer(HAL& hal, ShiftRegister<HAL>& shiftRegister, const uint8_t& wePin, const WriteCycleConfig& writeCycleConfig,
+                     const uint8_t& programmingMode = PROGRAMMING_DIFFERENTIAL, const ChipProfile& chip = CHIP_28C16)
+            : hal(hal),
+              shiftRegister(shiftRegister),
+              wePin(wePin),
+              chip(chip),
+              writeCycleConfig(writeCycleConfig),
+              programmingMode(programmingMode),
+              dataBusDirection(DATA_BUS_UNKNOWN),
+              writePulseUs(EEPROM_WRITE_PULSE_US),
+              pendingAddress(0),
+              pendingData(0),
+              pendingCount(0),
+              pendingLast(0),
+              pendingPolled(false),
+              dualSocket(false),
+              secondWePin(0),
+              secondOutputEnableBit(0),
+              socket(EEPROM_SOCKET_FIRST) {
+        beginProgramming();
+    }
+
+    /**
+     * WE is set HIGH before it becomes an output, so there is no accidental write. Must be called in setup().
+     */
+    void begin() {
+        we = hal.pin(wePin);
+        hal.write(we, HIGH);
+        hal.pinMode(wePin, OUTPUT);
+
+        if (dualSocket) {
+            secondWe = hal.pin(secondWePin);
+            hal.write(secondWe, HIGH);
+            hal.pinMode(secondWePin, OUTPUT);
+        }
+
+        shiftRegister.begin();
+    }
+
+    /**
+     * Enables the second socket. Must be called before begin().
+     * @param outputEnableBit The output of the chain driving the second chip's OE. It must be above the address and not the first chip's OE
+     * (12 for two 28C16 on the 16 bit chain).
+     */
+    void setSecondSocket(const uint8_t& wePin, const uint8_t& outputEnableBit) {
+        dualSocket = true;
+        secondWePin = wePin;
+        secondOutputEnableBit = outputEnableBit;
+    }
+
+    bool hasSecondSocket() const {
+        return dualSocket;
+    }
+
+    /**
+     * All other operations (reading, programming, verifying) work with the selected chip. EEPROM_SOCKET_FIRST by default.
+     */
+    void selectSocket(const uint8_t& selected) {
+        socket = dualSocket ? selected : EEPROM_SOCKET_FIRST;
+    }
+
+    uint8_t getSocket() const {
+        return socket;
+    }
+
+    /**
+     * Switches the data bus pins between INPUT and OUTPUT.
+     * The direction is remembered, so the DDR registers (or pinMode()) are touched only when the bus really changes its direction.
+     * Before the EEPROM's output is enabled the bus must be INPUT, otherwise both the Arduino and the EEPROM will drive it.
+     * @param direction Can be DATA_BUS_INPUT or DATA_BUS_OUTPUT
+     */
+    void setDataBusDirection(const uint8_t& direction) {
+
+        if (direction == dataBusDirection)
+            return;
+
+        hal.beginOperation(PERF_BUS_TURNAROUND);
+        hal.setDataBusDirection(direction);
+        hal.endOperation(PERF_BUS_TURNAROUND);
+        dataBusDirection = direction;
+    }
+
+    /**
+     * Puts the @param data on the EEPROM's I/O pins.
+     */
+    void writeDataBus(const uint8_t& data) {
+        setDataBusDirection(DATA_BUS_OUTPUT);
+        hal.beginOperation(PERF_BUS_WRITE);
+        hal.writeDataBus(data);
+        hal.endOperation(PERF_BUS_WRITE);
+    }
+
+    /**
+     * Reads the EEPROM's I/O pins.
+     */
+    uint8_t readDataBus() {
+        setDataBusDirection(DATA_BUS_INPUT);
+        hal.beginOperation(PERF_READ);
+        uint8_t data = hal.readDataBus();
+        hal.endOperation(PERF_READ);
+
+        return data;
+    }
+
+    /**
+     * Sets the address of the EEPROM and if the EEPROM's output will be enabled.
+     * First the most significant byte is shifted and then the least significant one, so each of them ends in its own register.
+     * The shift registers skip the address and OE, which are already set (for example the read back after the polled write cycle),
+     * and only latch the ones prepared with prepareEEPROMBytes().
+     */
+    void setEEPROMPins(const uint16_t& address, const bool& outputEnable, const uint8_t& bitOrder = MSBFIRST) {
+        shiftRegister.write(shiftWord(address, outputEnable), bitOrder);
+    }
+
+    uint8_t readEEPROMAddress(const uint16_t& address) {
+
+        setDataBusDirection(DATA_BUS_INPUT);
+        setEEPROMPins(address, true);
+
+        return readDataBus();
+    }
+
+    /**
+     * Reads @param length consecutive addresses starting from @param address into the @param buffer.
+     * The data bus is switched to INPUT only once. After that for each address only the address is shifted and the bus is read.
+     * The bus is sampled right after the latch without any delay. The outputs change on the rising edge of RCLK and the read comes after
+     * the RCLK LOW write and the restored interrupts (at least 8 cycles, 500ns at 16 MHz), which is more than tACC of the 28C chips (150 - 250ns).
+     */
+    void readEEPROMRange(const uint16_t& address, uint8_t* buffer, const uint16_t& length) {
+
+        setDataBusDirection(DATA_BUS_INPUT);
+
+        for (uint16_t i = 0; i < length; ++i) {
+            setEEPROMPins(address + i, true);
+            buffer[i] = readDataBus();
+        }
+    }
+
+    /**
+     * Reads the range like readEEPROMRange(), but only updates the CRC32 register (see crc32()) with each byte.
+     */
+    uint32_t crc32EEPROMRange(const uint16_t& address, const uint16_t& length, uint32_t crc = 0xFFFFFFFF) {
+
+        setDataBusDirection(DATA_BUS_INPUT);
+
+        for (uint16_t i = 0; i < length; ++i) {
+            setEEPROMPins(address + i, true);
+            crc = crc32Update(crc, readDataBus());
+        }
+
+        return crc;
+    }
+
+    /**
+     * Reads the range, updates the CRC32 register @param crc and compares each byte with the @param expected image.
+     * The @param Expected must provide uint8_t operator()(uint16_t address), so the image can be in the RAM or in the flash.
+     * @param bitmap Must be zeroed, bit 7 of the first byte is the @param address. The bit of each mismatching address is set.
+     * @return The number of mismatches.
+     */
+    template<typename Expected>
+    uint16_t verifyEEPROMRange(const uint16_t& address, const uint16_t& length, const Expected& expected, uint8_t* bitmap, uint32_t& crc) {
+
+        uint16_t mismatches = 0;
+        setDataBusDirection(DATA_BUS_INPUT);
+
+        for (uint16_t i = 0; i < length; ++i) {
+            setEEPROMPins(address + i, true);
+            uint8_t data = readDataBus();
+            crc = crc32Update(crc, data);
+
+            if (data != expected(address + i)) {
+                bitmap[i >> 3] |= 0x80 >> (i & 7);
+                mismatches++;
+            }
+        }
+
+        return mismatches;
+    }
+
+    void setEEPROMAddressData(const uint16_t& address, const uint8_t& data, const uint8_t& bitOrder = MSBFIRST) {
+        loadEEPROMByte(address, data, bitOrder);
+        waitForEEPROMWriteCycle(address, data, bitOrder);
+    }
+
+    /**
+     * A single WE pulse with the @param data on the @param address. It doesn't wait for the write cycle.
+     * On chips with page write the bytes loaded within tBLC of each other are written together.
+     */
+    void loadEEPROMByte(const uint16_t& address, const uint8_t& data, const uint8_t& bitOrder = MSBFIRST) {
+
+        setEEPROMPins(address, false, bitOrder);
+
+        writeDataBus(data);
+        pulseWriteEnable(socket == EEPROM_SOCKET_SECOND ? secondWe : we);
+    }
+
+    /**
+     * Will wait until the EEPROM completes the write of the @param data on the @param address.
+     * The EEPROM's output is enabled on the same address, so we can poll it (DATA# Polling / Toggle Bit).
+     * The next write disables the output again with setEEPROMPins().
+     */
+    WriteCycleResult waitForEEPROMWriteCycle(const uint16_t& address, const uint8_t& data, const uint8_t& bitOrder = MSBFIRST) {
+
+        hal.beginOperation(PERF_WRITE_WAIT);
+
+        if (writeCycleConfig.methods != WRITE_CYCLE_FIXED_DELAY) {
+            setDataBusDirection(DATA_BUS_INPUT);
+            setEEPROMPins(address, true, bitOrder);
+        }
+
+        WriteCycleBus bus = {*this};
+        WriteCycleResult result = waitForWriteCycle(bus, data, writeCycleConfig);
+        hal.endOperation(PERF_WRITE_WAIT);
+
+        return result;
+    }
+
+    void beginProgramming() {
+        ProgrammingStats empty = {0, 0, 0, 0};
+        stats = empty;
+    }
+
+    /**
+     * Programs the @param data on the @param address depending on the programmingMode.
+     * In differential mode the address is read first and if it already holds the data the write is skipped.
+     * After each write the data is read back to verify it.
+     * @return PROGRAM_BYTE_WRITTEN, PROGRAM_BYTE_SKIPPED or PROGRAM_BYTE_FAILED
+     */
+    uint8_t programEEPROMAddressData(const uint16_t& address, const uint8_t& data) {
+
+        if (programmingMode == PROGRAMMING_DIFFERENTIAL && readEEPROMAddress(address) == data) {
+            stats.skipped++;
+            stats.verified++;
+            return PROGRAM_BYTE_SKIPPED;
+        }
+
+        setEEPROMAddressData(address, data);
+
+        if (readEEPROMAddress(address) == data) {
+            stats.written++;
+            stats.verified++;
+            return PROGRAM_BYTE_WRITTEN;
+        }
+
+        stats.failed++;
+        return PROGRAM_BYTE_FAILED;
+    }
+
+    /**
+     * Programs up to @param length bytes from the @param address with a single write cycle:
+     * - Without page write only the first byte.
+     * - With page write the bytes up to the end of the page. They are loaded one after another and then the write cycle is awaited once.
+     *   In differential mode only the changed bytes are loaded, the others in the page are left as they are by the chip.
+     * If a byte can't be loaded within tBLC of the previous one (an interrupt took too long), the chip has already started
+     * the write cycle. It is awaited and the loading continues as a new page write.
+     * Each programmed byte is read back to verify it.
+     * @param results Optional, PROGRAM_BYTE_* of each programmed byte.
+     * @return Number of the programmed bytes. Call it again with the rest.
+     */
+    uint8_t programEEPROMBytes(const uint16_t& address, const uint8_t* data, const uint8_t& length, uint8_t* results = 0) {
+
+        uint8_t count = startEEPROMBytes(address, data, length);
+
+        while (!pollEEPROMBytes(results)) {
+        }
+
+        return count;
+    }
+
+    /**
+     * The first half of programEEPROMBytes() - loads the bytes and starts the write cycle, but doesn't wait for it.
+     * Then pollEEPROMBytes() must be called until it returns true. Meanwhile the EEPROM's pins must not be touched,
+     * except for prepareEEPROMBytes().
+     * @param data Must stay unchanged until pollEEPROMBytes() returns true.
+     * @return Number of the bytes, which will be programmed.
+     */
+    uint8_t startEEPROMBytes(const uint16_t& address, const uint8_t* data, const uint8_t& length) {
+
+        pendingCount = length < bytesToPageEnd(chip, address) ? length : bytesToPageEnd(chip, address);
+        pendingAddress = address;
+        pendingData = data;
+        pendingPolled = false;
+
+        for (uint8_t i = 0; i < pendingCount; ++i) {
+            bool load = programmingMode != PROGRAMMING_DIFFERENTIAL || readEEPROMAddress(address + i) != data[i];
+            setPendingLoad(i, load);
+        }
+
+        uint8_t loaded = 0;
+        uint32_t lastLoadUs = 0;
+        uint32_t loadUs = 0;
+
+        for (uint8_t i = 0; i < pendingCount; ++i) {
+
+            if (!isPendingLoad(i))
+                continue;
+
+            /**
+             * The next WE pulse comes after the shifting of the address, which takes about as long as the previous load.
+             */
+            uint32_t startUs = hal.micros();
+
+            if (loaded > 0 && startUs - lastLoadUs + loadUs >= chip.byteLoadCycleUs) {
+                waitForEEPROMWriteCycle(address + pendingLast, data[pendingLast]);
+                loaded = 0;
+                startUs = hal.micros();
+            }
+
+            loadEEPROMByte(address + i, data[i]);
+            lastLoadUs = hal.micros();
+            loadUs = lastLoadUs - startUs;
+            pendingLast = i;
+            loaded++;
+        }
+
+        if (loaded > 0) {
+            if (writeCycleConfig.methods != WRITE_CYCLE_FIXED_DELAY) {
+                setDataBusDirection(DATA_BUS_INPUT);
+                setEEPROMPins(address + pendingLast, true);
+            }
+
+            hal.beginOperation(PERF_WRITE_WAIT);
+            writeCyclePoller.begin(hal.micros(), data[pendingLast], writeCycleConfig);
+            pendingPolled = true;
+        }
+
+        return pendingCount;
+    }
+
+    /**
+     * Polls the write cycle started by startEEPROMBytes() once and returns. When it is over the bytes are verified.
+     * The last loaded byte was already read back by the polling (WriteCyclePoller), so without page write the verification costs nothing.
+     * @param results Optional, PROGRAM_BYTE_* of each programmed byte. Filled only when it returns true.
+     * @return True when the bytes are programmed (or there is nothing pending).
+     */
+    bool pollEEPROMBytes(uint8_t* results = 0) {
+
+        WriteCycleBus bus = {*this};
+
+        if (!writeCyclePoller.poll(bus))
+            return false;
+
+        if (pendingPolled)
+            hal.endOperation(PERF_WRITE_WAIT);
+
+        bool lastVerified = pendingPolled && writeCyclePoller.getResult().completed;
+
+        for (uint8_t i = 0; i < pendingCount; ++i) {
+            uint8_t result;
+
+            if (!isPendingLoad(i)) {
+                stats.skipped++;
+                stats.verified++;
+                result = PROGRAM_BYTE_SKIPPED;
+            } else if ((lastVerified && i == pendingLast) || readEEPROMAddress(pendingAddress + i) == pendingData[i]) {
+                stats.written++;
+                stats.verified++;
+                result = PROGRAM_BYTE_WRITTEN;
+            } else {
+                stats.failed++;
+                result = PROGRAM_BYTE_FAILED;
+            }
+
+            if (results)
+                results[i] = result;
+        }
+
+        pendingCount = 0;
+        pendingPolled = false;
+        return true;
+    }
+
+    /**
+     * Programs up to @param length bytes from the @param address in both sockets, the @param firstData in the first chip and the
+     * @param secondData in the second. The chips get the same address setup and the WE pulses are right after each other,
+     * so their write cycles overlap and are awaited together. Like programEEPROMBytes() with page write the bytes up to the end
+     * of the page are loaded (interleaved, each chip sees its own loads within tBLC). The polled byte of each chip is verified by the polling,
+     * the others are read back. The selected socket stays the same.
+     * @param firstResults, secondResults Optional, PROGRAM_BYTE_* of each programmed byte.
+     * @return Number of the programmed bytes (of each chip). Call it again with the rest. 0 without the second socket (setSecondSocket()),
+     * then nothing is written.
+     */
+    uint8_t programEEPROMPairBytes(const uint16_t& address, const uint8_t* firstData, const uint8_t* secondData, const uint8_t& length,
+                                   uint8_t* firstResults = 0, uint8_t* secondResults = 0) {
+
+        if (!dualSocket)
+            return 0;
+
+        const uint8_t* data[2] = {firstData, secondData};
+        uint8_t* results[2] = {firstResults, secondResults};
+        uint8_t loads[2][EEPROM_MAX_PAGE_SIZE / 8];
+        uint8_t selected = socket;
+        uint8_t count = length < bytesToPageEnd(chip, address) ? length : bytesToPageEnd(chip, address);
+
+        for (uint8_t s = 0; s < 2; ++s) {
+            selectSocket(s);
+
+            for (uint8_t i = 0; i < count; ++i) {
+                bool load = programmingMode != PROGRAMMING_DIFFERENTIAL || readEEPROMAddress(address + i) != data[s][i];
+                setLoad(loads[s], i, load);
+            }
+        }
+
+        int16_t last[2] = {-1, -1};
+        bool polled[2] = {false, false};
+        uint32_t lastLoadUs = 0;
+        uint32_t loadUs = 0;
+
+        for (uint8_t i = 0; i < count; ++i) {
+
+            if (!isLoad(loads[0], i) && !isLoad(loads[1], i))
+                continue;
+
+            uint32_t startUs = hal.micros();
+
+            if ((last[0] >= 0 || last[1] >= 0) && startUs - lastLoadUs + loadUs >= chip.byteLoadCycleUs) {
+                waitForPairWriteCycle(address, data, last, polled);
+                last[0] = last[1] = -1;
+                startUs = hal.micros();
+            }
+
+            setEEPROMPins(address + i, false);
+
+            for (uint8_t s = 0; s < 2; ++s) {
+                if (!isLoad(loads[s], i))
+                    continue;
+
+                writeDataBus(data[s][i]);
+                pulseWriteEnable(s == EEPROM_SOCKET_SECOND ? secondWe : we);
+                last[s] = i;
+            }
+
+            lastLoadUs = hal.micros();
+            loadUs = lastLoadUs - startUs;
+        }
+
+        polled[0] = polled[1] = false;
+        waitForPairWriteCycle(address, data, last, polled);
+
+        for (uint8_t s = 0; s < 2; ++s) {
+            selectSocket(s);
+
+            for (uint8_t i = 0; i < count; ++i) {
+                uint8_t result;
+
+                if (!isLoad(loads[s], i)) {
+                    stats.skipped++;
+                    stats.verified++;
+                    result = PROGRAM_BYTE_SKIPPED;
+                } else if ((polled[s] && i == last[s]) || readEEPROMAddress(address + i) == data[s][i]) {
+                    stats.written++;
+                    stats.verified++;
+                    result = PROGRAM_BYTE_WRITTEN;
+                } else {
+                    stats.failed++;
+                    result = PROGRAM_BYTE_FAILED;
+                }
+
+                if (results[s])
+                    results[s][i] = result;
+            }
+        }
+
+        selectSocket(selected);
+        return count;
+    }
+
+    /**
+     * True between startEEPROMBytes() and the pollEEPROMBytes(), which returned true.
+     */
+    bool isEEPROMBusy() const {
+        return pendingCount > 0;
+    }
+
+    /**
+     * Shifts the first address of the next startEEPROMBytes() in the shift registers without latching it (see ShiftRegister.h).
+     * The outputs still hold the polled address, so it is allowed during the write cycle. When the next operation selects
+     * the same address and OE, only RCLK is pulsed. Any other address is shifted as usual.
+     */
+    void prepareEEPROMBytes(const uint16_t& address) {
+        shiftRegister.shift(shiftWord(address, programmingMode == PROGRAMMING_DIFFERENTIAL));
+    }
+
+    /**
+     * Hashes the first @param length bytes of the EEPROM in chunks like fingerprintBytes() does with the image.
+     */
+    uint32_t fingerprintEEPROM(const uint16_t& length) {
+
+        uint8_t chunk[EEPROM_FINGERPRINT_CHUNK_LENGTH];
+        uint32_t hash = FINGERPRINT_BASIS;
+
+        for (uint16_t address = 0; address < length; address += EEPROM_FINGERPRINT_CHUNK_LENGTH) {
+            uint16_t chunkLength = length - address < EEPROM_FINGERPRINT_CHUNK_LENGTH ? length - address : EEPROM_FINGERPRINT_CHUNK_LENGTH;
+
+            readEEPROMRange(address, chunk, chunkLength);
+            hash = fingerprintBytes(chunk, chunkLength, hash);
+        }
+
+        return hash;
+    }
+
+    /**
+     * @return False if the chip has no fingerprint (see ImageFingerprint.h).
+     */
+    bool readImageFingerprint(ImageFingerprint& fingerprint) {
+
+        uint8_t record[IMAGE_FINGERPRINT_LENGTH];
+        readEEPROMRange(imageFingerprintAddress(chip), record, IMAGE_FINGERPRINT_LENGTH);
+
+        return decodeImageFingerprint(record, fingerprint);
+    }
+
+    /**
+     * Stores the @param fingerprint after the image was programmed. Counted in the stats like the image's bytes.
+     * @return False if a byte of the record failed.
+     */
+    bool programImageFingerprint(const ImageFingerprint& fingerprint) {
+
+        uint8_t record[IMAGE_FINGERPRINT_LENGTH];
+        uint8_t results[IMAGE_FINGERPRINT_LENGTH];
+        encodeImageFingerprint(fingerprint, record);
+
+        for (uint8_t i = 0; i < IMAGE_FINGERPRINT_LENGTH;)
+            i += programEEPROMBytes(imageFingerprintAddress(chip) + i, record + i, IMAGE_FINGERPRINT_LENGTH - i, results + i);
+
+        for (uint8_t i = 0; i < IMAGE_FINGERPRINT_LENGTH; ++i) {
+            if (results[i] == PROGRAM_BYTE_FAILED)
+                return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * True if the EEPROM holds the image with the @param expected fingerprint. First the stored record is compared (8 reads),
+     * then the image is read back and hashed, so a changed or damaged byte is still found.
+     */
+    bool isImageCurrent(const ImageFingerprint& expected) {
+
+        ImageFingerprint stored;
+
+        if (!readImageFingerprint(stored) || !(stored == expected))
+            return false;
+
+        return expected.size <= imageFingerprintAddress(chip) && fingerprintEEPROM(expected.size) == expected.hash;
+    }
+
+    const ProgrammingStats& getStats() const {
+        return stats;
+    }
+
+    void setProgrammingMode(const uint8_t& mode) {
+        programmingMode = mode;
+    }
+
+    uint8_t getProgrammingMode() const {
+        return programmingMode;
+    }
+
+    void setWriteCycleConfig(const WriteCycleConfig& config) {
+        writeCycleConfig = config;
+    }
+
+    const ChipProfile& getChip() const {
+        return chip;
+    }
+
+    void setChip(const ChipProfile& profile) {
+        chip = profile;
+    }
+
+    void setWritePulseUs(const uint16_t& us) {
+        writePulseUs = us;
+    }
+
+private:
+
+    /**
+     * The bits of the shift registers for the @param address and OE (active LOW).
+     */
+    uint32_t shiftWord(const uint16_t& address, const bool& outputEnable) const {
+        uint32_t disabled = (1UL << chip.outputEnableBit) | (dualSocket ? 1UL << secondOutputEnableBit : 0);
+        uint32_t enabled = !outputEnable ? 0 : socket == EEPROM_SOCKET_SECOND ? 1UL << secondOutputEnableBit : 1UL << chip.outputEnableBit;
+
+        return (disabled & ~enabled) | (address & (chipSize(chip) - 1));
+    }
+
+    void pulseWriteEnable(const typename HAL::Pin& pin) {
+
+        hal.write(pin, LOW);
+
+        if (writePulseUs > 0)
+            hal.delayMicroseconds(writePulseUs);
+
+        hal.write(pin, HIGH);
+    }
+
+    /**
+     * Waits for the write cycle of each socket, which loaded a byte (@param last is its index, -1 for none), one after another.
+     * The second chip started its cycle a few microseconds after the first one, so its wait is usually over with the first poll.
+     * With the fixed delay only the first wait is needed.
+     * @param polled Set for each socket, where the polling saw the last byte.
+     */
+    void waitForPairWriteCycle(const uint16_t& address, const uint8_t* const* data, const int16_t* last, bool* polled) {
+
+        bool waited = false;
+
+        for (uint8_t s = 0; s < 2; ++s) {
+            if (last[s] < 0 || (waited && writeCycleConfig.methods == WRITE_CYCLE_FIXED_DELAY))
+                continue;
+
+            selectSocket(s);
+            polled[s] = waitForEEPROMWriteCycle(address + last[s], data[s][last[s]]).completed;
+            waited = true;
+        }
+    }
+
+    static bool isLoad(const uint8_t* loads, const uint8_t& index) {
+        return loads[index >> 3] & (0x80 >> (index & 7));
+    }
+
+    static void setLoad(uint8_t* loads, const uint8_t& index, const bool& load) {
+        if (load)
+            loads[index >> 3] |= 0x80 >> (index & 7);
+        else
+            loads[index >> 3] &= ~(0x80 >> (index & 7));
+    }
+
+    bool isPendingLoad(const uint8_t& index) const {
+        return isLoad(pendingLoad, index);
+    }
+
+    void setPendingLoad(const uint8_t& index, const bool& load) {
+        setLoad(pendingLoad, index, load);
+    }
+
+    /**
+     * Gives waitForWriteCycle() access to the EEPROM's data bus.
+     * The address and OE are already set, thus each read is only reading the I/O pins.
+     */
+    struct WriteCycleBus {
+        EEPROMProgrammer& programmer;
+
+        uint8_t readData() {
+            return programmer.readDataBus();
+        }
+
+        uint32_t micros() {
+            return programmer.hal.micros();
+        }
+
+        void delayMilliseconds(const uint16_t& ms) {
+            programmer.hal.delayMilliseconds(ms);
+        }
+    };
+
+    HAL& hal;
+    ShiftRegister<HAL>& shiftRegister;
+    uint8_t wePin;
+    typename HAL::Pin we;
+    ChipProfile chip;
+    WriteCycleConfig writeCycleConfig;
+    uint8_t programmingMode;
+    uint8_t dataBusDirection;
+    uint16_t writePulseUs;
+    ProgrammingStats stats;
+
+    /**
+     * The bytes between startEEPROMBytes() and pollEEPROMBytes(). The load flags are a bitmap, bit 7 of the first byte is the first address.
+     */
+    WriteCyclePoller writeCyclePoller;
+    uint16_t pendingAddress;
+    const uint8_t* pendingData;
+    uint8_t pendingLoad[EEPROM_MAX_PAGE_SIZE / 8];
+    uint8_t pendingCount;
+    uint8_t pendingLast;
+    bool pendingPolled;
+
+    bool dualSocket;
+    uint8_t secondWePin;
+    typename HAL::Pin secondWe;
+    uint8_t secondOutputEnableBit;
+    uint8_t socket;
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef IMAGE_FINGERPRINT_H
+#define IMAGE_FINGERPRINT_H
+
+#include <stdint.h>
+
+#include "ChipProfile.h"
+
+/**
+ * The fingerprint of an image is its size and its hash (FNV-1a, 32 bit). It is computed with the image (at compile time for the microcode)
+ * and stored on the chip after the programming in the last IMAGE_FINGERPRINT_LENGTH bytes, which the computer never addresses
+ * (the microcode takes 512 bytes, A9/A10 are always LOW).
+ *
+ * On the next run the programmer reads it first. If it is the same, the image is only read back and hashed to check that nothing changed.
+ * That takes a few milliseconds instead of a full burn.
+ *
+ * Record:
+ * | MAGIC (0x46, 0x50 - "FP") | SIZE (MSB, LSB) | HASH (4 bytes, MSB first) |
+ * An erased chip (0xFF) has no magic, so it never matches.
+ */
+
+#define IMAGE_FINGERPRINT_MAGIC 0x4650
+#define IMAGE_FINGERPRINT_LENGTH 8
+
+#define FINGERPRINT_BASIS 2166136261UL
+#define FINGERPRINT_PRIME 16777619UL
+
+struct ImageFingerprint {
+    uint16_t size;
+    uint32_t hash;
+};
+
+constexpr uint32_t fingerprintUpdate(uint32_t hash, uint8_t byte) {
+    return (uint32_t) ((hash ^ byte) * FINGERPRINT_PRIME);
+}
+
+inline uint32_t fingerprintBytes(const uint8_t* data, const uint16_t& length, uint32_t hash = FINGERPRINT_BASIS) {
+
+    for (uint16_t i = 0; i < length; ++i)
+        hash = fingerprintUpdate(hash, data[i]);
+
+    return hash;
+}
+
+/**
+ * Where the record starts. It is in the last page, so chips with page write store it with a single write cycle.
+ */
+constexpr uint16_t imageFingerprintAddress(const ChipProfile& chip) {
+    return chipSize(chip) - IMAGE_FINGERPRINT_LENGTH;
+}
+
+inline bool operator==(const ImageFingerprint& first, const ImageFingerprint& second) {
+    return first.size == second.size && first.hash == second.hash;
+}
+
+inline void encodeImageFingerprint(const ImageFingerprint& fingerprint, uint8_t* out) {
+    out[0] = IMAGE_FINGERPRINT_MAGIC >> 8;
+    out[1] = IMAGE_FINGERPRINT_MAGIC & 0xFF;
+    out[2] = fingerprint.size >> 8;
+    out[3] = fingerprint.size & 0xFF;
+
+    for (uint8_t i = 0; i < 4; ++i)
+        out[4 + i] = fingerprint.hash >> (24 - 8 * i);
+}
+
+/**
+ * @return False if the record has no magic (erased or never fingerprinted chip).
+ */
+inline bool decodeImageFingerprint(const uint8_t* in, ImageFingerprint& fingerprint) {
+
+    if (((uint16_t) in[0] << 8 | in[1]) != IMAGE_FINGERPRINT_MAGIC)
+        return false;
+
+    fingerprint.size = (uint16_t) in[2] << 8 | in[3];
+    fingerprint.hash = (uint32_t) in[4] << 24 | (uint32_t) in[5] << 16 | (uint32_t) in[6] << 8 | in[7];
+    return true;
+}
+
+static_assert(fingerprintUpdate(FINGERPRINT_BASIS, 'a') == 0xE40C292CUL, "FNV-1a of \"a\"");
+static_assert(imageFingerprintAddress(CHIP_28C16) == 2040 && imageFingerprintAddress(CHIP_28C256) == 32760, "The record is at the end of the chip");
+
+#endif
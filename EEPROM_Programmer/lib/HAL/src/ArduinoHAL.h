@@ -0,0 +1,195 @@
+#ifndef ARDUINO_HAL_H
+#define ARDUINO_HAL_H
+
+#include <Arduino.h>
+#include <SPI.h>
+
+#include "HAL.h"
+#include <DataBus.h>
+
+/**
+ * HAL (see HAL.h) for the Arduino Nano.
+ *
+ * On the AVR a Pin is its output port register and bit mask, so a write is a single read-modify-write of the register.
+ * The data bus is moved through the PORTD/PORTB registers (DataBus.h) if it is on pins 5 - 12 of the ATmega328.
+ * Otherwise each pin is written with digitalWrite() in the same bit order (the first pin is I/O7).
+ */
+class ArduinoHAL {
+
+public:
+
+    struct Pin {
+        uint8_t number;
+#ifdef __AVR__
+        volatile uint8_t* port;
+        uint8_t mask;
+#endif
+    };
+
+    ArduinoHAL(const uint8_t& dataBusFirstPin, const uint8_t& dataBusLastPin)
+            : dataBusFirstPin(dataBusFirstPin),
+              dataBusLastPin(dataBusLastPin) {
+#ifdef __AVR_ATmega328P__
+        dataBusPorts = dataBusFirstPin == DATA_BUS_FIRST_PIN && dataBusLastPin == DATA_BUS_LAST_PIN;
+#else
+        dataBusPorts = false;
+#endif
+    }
+
+    Pin pin(const uint8_t& number) {
+        Pin pin;
+        pin.number = number;
+#ifdef __AVR__
+        pin.port = portOutputRegister(digitalPinToPort(number));
+        pin.mask = digitalPinToBitMask(number);
+#endif
+        return pin;
+    }
+
+    void pinMode(const uint8_t& number, const uint8_t& mode) {
+        ::pinMode(number, mode);
+    }
+
+    /**
+     * ! Not atomic on the AVR. Call it between disableInterrupts() and restoreInterrupts() if an interrupt can write the same port.
+     */
+    void write(const Pin& pin, const bool& value) {
+#ifdef __AVR__
+        if (value)
+            *pin.port |= pin.mask;
+        else
+            *pin.port &= ~pin.mask;
+#else
+        ::digitalWrite(pin.number, value);
+#endif
+    }
+
+    uint8_t disableInterrupts() {
+#ifdef __AVR__
+        uint8_t state = SREG;
+        cli();
+        return state;
+#else
+        return 0;
+#endif
+    }
+
+    void restoreInterrupts(const uint8_t& state) {
+#ifdef __AVR__
+        SREG = state;
+#else
+        (void) state;
+#endif
+    }
+
+    void setDataBusDirection(const uint8_t& direction) {
+
+#ifdef __AVR_ATmega328P__
+        if (dataBusPorts) {
+            if (direction == DATA_BUS_OUTPUT) {
+                DDRD |= DATA_BUS_PORTD_MASK;
+                DDRB |= DATA_BUS_PORTB_MASK;
+            } else {
+                DDRD &= ~DATA_BUS_PORTD_MASK;
+                DDRB &= ~DATA_BUS_PORTB_MASK;
+                PORTD &= ~DATA_BUS_PORTD_MASK;
+                PORTB &= ~DATA_BUS_PORTB_MASK;
+            }
+            return;
+        }
+#endif
+
+        for (uint8_t pin = dataBusFirstPin; pin <= dataBusLastPin; ++pin)
+            ::pinMode(pin, direction == DATA_BUS_OUTPUT ? OUTPUT : INPUT);
+    }
+
+    void writeDataBus(const uint8_t& data) {
+
+#ifdef __AVR_ATmega328P__
+        if (dataBusPorts) {
+            PORTD = (PORTD & ~DATA_BUS_PORTD_MASK) | dataBusPortD(data);
+            PORTB = (PORTB & ~DATA_BUS_PORTB_MASK) | dataBusPortB(data);
+            return;
+        }
+#endif
+
+        uint8_t bitIndex = 0;
+
+        for (uint8_t pin = dataBusLastPin; pin >= dataBusFirstPin; --pin)
+            ::digitalWrite(pin, (data >> bitIndex++) & 0b1);
+    }
+
+    uint8_t readDataBus() {
+
+#ifdef __AVR_ATmega328P__
+        if (dataBusPorts)
+            return dataBusFromPorts(PIND, PINB);
+#endif
+
+        uint8_t data = 0;
+
+        for (uint8_t pin = dataBusFirstPin; pin <= dataBusLastPin; ++pin)
+            data = (data << 1) | (::digitalRead(pin) == HIGH);
+
+        return data;
+    }
+
+    void spiBegin() {
+        SPI.begin();
+    }
+
+    void spiTransfer(const uint8_t* bytes, const uint8_t& length, const uint32_t& clock, const uint8_t& bitOrder) {
+
+        SPI.beginTransaction(SPISettings(clock, bitOrder, SPI_MODE0));
+
+        for (uint8_t i = 0; i < length; ++i)
+            SPI.transfer(bytes[i]);
+
+        SPI.endTransaction();
+    }
+
+    uint32_t micros() {
+        return ::micros();
+    }
+
+    void delayMicroseconds(const uint16_t& us) {
+        ::delayMicroseconds(us);
+    }
+
+    void delayMilliseconds(const uint16_t& ms) {
+        ::delay(ms);
+    }
+
+    /**
+     * On the ATmega328 Timer1 counts every CPU cycle (no prescaler). The Arduino uses it only for the PWM of pins 9 and 10,
+     * which are part of the data bus, so nothing is lost.
+     */
+    void beginCycleCounter() {
+#ifdef __AVR_ATmega328P__
+        TCCR1A = 0;
+        TCCR1B = _BV(CS10);
+#endif
+    }
+
+    uint16_t cycleCounter() {
+#ifdef __AVR_ATmega328P__
+        return TCNT1;
+#else
+        return ::micros() * clockCyclesPerMicrosecond();
+#endif
+    }
+
+    void beginOperation(const uint8_t& operation) {
+    }
+
+    void endOperation(const uint8_t& operation) {
+    }
+
+private:
+
+    uint8_t dataBusFirstPin;
+    uint8_t dataBusLastPin;
+    bool dataBusPorts;
+};
+
+#endif
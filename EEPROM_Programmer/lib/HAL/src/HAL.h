@@ -0,0 +1,47 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+
+/**
+ * Hardware abstraction layer of the programmer.
+ *
+ * The drivers (ShiftRegister, EEPROMProgrammer) doesn't call the Arduino functions directly. They are templates
+ * and everything is done through a HAL object, which is passed to them:
+ * - ArduinoHAL (ArduinoHAL.h) - The real pins of the Arduino Nano.
+ * - SimulatedBoard (SimulatedBoard.h) - Software model of the shift registers and the EEPROM on the host.
+ * That way the same code runs on the Nano and in the tests and benchmarks on a Linux box.
+ *
+ * A HAL must have:
+ * typedef ... Pin;                                         - Prepared pin, which is fast to write. (For example its port register and mask)
+ * Pin pin(const uint8_t& number);
+ * void pinMode(const uint8_t& number, const uint8_t& mode);
+ * void write(const Pin& pin, const bool& value);
+ * uint8_t disableInterrupts();                             - Returns the previous state for restoreInterrupts().
+ * void restoreInterrupts(const uint8_t& state);
+ * void setDataBusDirection(const uint8_t& direction);       - DATA_BUS_INPUT or DATA_BUS_OUTPUT (DataBus.h)
+ * void writeDataBus(const uint8_t& data);                  - I/O7 is the most significant bit.
+ * uint8_t readDataBus();
+ * void spiBegin();
+ * void spiTransfer(const uint8_t* bytes, const uint8_t& length, const uint32_t& clock, const uint8_t& bitOrder);
+ * uint32_t micros();
+ * void delayMicroseconds(const uint16_t& us);
+ * void delayMilliseconds(const uint16_t& ms);
+ * void beginCycleCounter();                                - Starts cycleCounter(). Only needed by the pin trace (TracingHAL.h).
+ * uint16_t cycleCounter();                                 - Free running counter of CPU cycles, which wraps at 65536.
+ * void beginOperation(const uint8_t& operation);           - The drivers mark their operations (PERF_* in PerfCounters.h).
+ * void endOperation(const uint8_t& operation);               Only ProfilingHAL measures them, the others do nothing.
+ *
+ * The calls are not virtual. Each driver is compiled for the concrete HAL, so on the Nano there is no cost for the abstraction.
+ */
+
+#ifndef ARDUINO
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define LSBFIRST 0
+#define MSBFIRST 1
+#endif
+
+#endif
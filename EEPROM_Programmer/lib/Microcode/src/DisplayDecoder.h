@@ -0,0 +1,135 @@
+#ifndef DISPLAY_DECODER_H
+#define DISPLAY_DECODER_H
+
+#include <stdint.h>
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#endif
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+#include "IndexSequence.h"
+
+/**
+ * Generates the image of the output register's display decoder EEPROM at compile time, the same way as the microcode (Microcode.h).
+ * Every address is computed by the compiler, so programming it is a copy of the image without any arithmetic per byte.
+ *
+ * Address:
+ * A0/7: The value of the output register.
+ * A8/9: The digit, which is multiplexed at the moment. The bits are swapped by the wiring of the display's counter:
+ *       0b00 (A9 A8) = hundreds, 0b10 = tens, 0b01 = ones, 0b11 = sign.
+ * A10/11: The display mode (DISPLAY_MODE_*), for example from switches. A line, which is tied to GND, selects mode 0.
+ *         The 28C16 has only A10, so there only the first two modes are available.
+ *
+ * Data (segments):
+ * G, F, A, B, E, D, C, (unused)
+ *
+ * Example (value 0b11111101):
+ * Mode          Sign Hundreds Tens Ones
+ * Signed         -      0       0    3
+ * Unsigned              2       5    3
+ * Hex                           F    D
+ * Unsigned no 0         2       5    3
+ */
+
+#define DISPLAY_MODE_SIGNED 0
+#define DISPLAY_MODE_UNSIGNED 1
+#define DISPLAY_MODE_HEX 2
+#define DISPLAY_MODE_UNSIGNED_NO_ZEROS 3
+
+#define DISPLAY_DIGIT_HUNDREDS 0
+#define DISPLAY_DIGIT_TENS 1
+#define DISPLAY_DIGIT_ONES 2
+#define DISPLAY_DIGIT_SIGN 3
+
+#define DISPLAY_MODE_SHIFT 10
+#define DISPLAY_MODE_BITS 2
+#define DISPLAY_DECODER_IMAGE_SIZE (1 << (DISPLAY_MODE_SHIFT + DISPLAY_MODE_BITS))
+
+#define DISPLAY_SEGMENTS_BLANK 0b00000000
+#define DISPLAY_SEGMENTS_MINUS 0b10000000
+
+/**
+ * The segments of the digits 0 - 9 and A - F (b and d are lower case, so they differ from 8 and 0).
+ * (7) HIGH, LOW, LOW, HIGH, HIGH, LOW, LOW = 0b00110010
+ * (8) HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH = 0b11111110
+ * (9) HIGH, LOW, LOW, HIGH, HIGH, HIGH, HIGH = 0b11110010
+ */
+constexpr uint8_t DISPLAY_SEGMENTS[16] = {0b01111110, 0b00010010, 0b10111100, 0b10110110, 0b11010010, 0b11100110, 0b11101110, 0b00110010,
+                                          0b11111110, 0b11110010, 0b11111010, 0b11001110, 0b01101100, 0b10011110, 0b11101100, 0b11101000};
+
+constexpr uint16_t displayDecoderAddress(uint8_t value, uint8_t digit, uint8_t mode = DISPLAY_MODE_SIGNED) {
+    return (mode << DISPLAY_MODE_SHIFT) | ((digit & 0b01) << 9) | ((digit & 0b10) << 7) | value;
+}
+
+constexpr uint8_t displayDecoderValue(uint16_t address) {
+    return address & 0xFF;
+}
+
+constexpr uint8_t displayDecoderDigit(uint16_t address) {
+    return ((address >> 9) & 0b01) | ((address >> 7) & 0b10);
+}
+
+constexpr uint8_t displayDecoderMode(uint16_t address) {
+    return address >> DISPLAY_MODE_SHIFT;
+}
+
+/**
+ * The absolute value. In the signed mode the value is in two's complement, so -128 (0b10000000) is 128.
+ */
+constexpr uint8_t displayMagnitude(uint8_t value, uint8_t mode) {
+    return mode == DISPLAY_MODE_SIGNED && value >= 0x80 ? 0x100 - value : value;
+}
+
+constexpr uint8_t decimalDigitSegments(uint8_t magnitude, uint8_t digit, bool noZeros) {
+    return digit == DISPLAY_DIGIT_HUNDREDS ? (noZeros && magnitude < 100 ? DISPLAY_SEGMENTS_BLANK : DISPLAY_SEGMENTS[magnitude / 100]) :
+           digit == DISPLAY_DIGIT_TENS ? (noZeros && magnitude < 10 ? DISPLAY_SEGMENTS_BLANK : DISPLAY_SEGMENTS[magnitude / 10 % 10]) :
+           DISPLAY_SEGMENTS[magnitude % 10];
+}
+
+constexpr uint8_t hexDigitSegments(uint8_t value, uint8_t digit) {
+    return digit == DISPLAY_DIGIT_TENS ? DISPLAY_SEGMENTS[value >> 4] : digit == DISPLAY_DIGIT_ONES ? DISPLAY_SEGMENTS[value & 0x0F] : DISPLAY_SEGMENTS_BLANK;
+}
+
+constexpr uint8_t displayDigitSegments(uint8_t value, uint8_t digit, uint8_t mode) {
+    return digit == DISPLAY_DIGIT_SIGN ? (mode == DISPLAY_MODE_SIGNED && value >= 0x80 ? DISPLAY_SEGMENTS_MINUS : DISPLAY_SEGMENTS_BLANK) :
+           mode == DISPLAY_MODE_HEX ? hexDigitSegments(value, digit) :
+           decimalDigitSegments(displayMagnitude(value, mode), digit, mode == DISPLAY_MODE_UNSIGNED_NO_ZEROS);
+}
+
+constexpr uint8_t displayDecoderData(uint16_t address) {
+    return displayDigitSegments(displayDecoderValue(address), displayDecoderDigit(address), displayDecoderMode(address));
+}
+
+template<typename Addresses>
+struct DisplayDecoderImages;
+
+template<uint16_t... Addresses>
+struct DisplayDecoderImages<IndexSequence<Addresses...> > {
+    static const uint8_t image[sizeof...(Addresses)];
+};
+
+template<uint16_t... Addresses>
+const uint8_t DisplayDecoderImages<IndexSequence<Addresses...> >::image[sizeof...(Addresses)] PROGMEM = {displayDecoderData(Addresses)...};
+
+/**
+ * DisplayDecoderImage::image holds the DISPLAY_DECODER_IMAGE_SIZE bytes of all modes. On the AVR it is in the flash.
+ * A chip with less addresses (28C16) gets only its beginning.
+ */
+typedef DisplayDecoderImages<MakeIndexSequence<DISPLAY_DECODER_IMAGE_SIZE>::type> DisplayDecoderImage;
+
+static_assert(displayDecoderAddress(0xFD, DISPLAY_DIGIT_TENS) == 0b1011111101 && displayDecoderAddress(0xFD, DISPLAY_DIGIT_ONES) == 0b0111111101,
+              "The digit lines must match the old wiring");
+static_assert(displayDecoderData(displayDecoderAddress(0x99, DISPLAY_DIGIT_SIGN)) == DISPLAY_SEGMENTS_MINUS &&
+              displayDecoderData(displayDecoderAddress(0x99, DISPLAY_DIGIT_HUNDREDS)) == DISPLAY_SEGMENTS[1] &&
+              displayDecoderData(displayDecoderAddress(0x99, DISPLAY_DIGIT_ONES)) == DISPLAY_SEGMENTS[3], "0b10011001 is -103 in the signed mode");
+static_assert(displayDecoderData(displayDecoderAddress(0x80, DISPLAY_DIGIT_TENS)) == DISPLAY_SEGMENTS[2], "-128 must not overflow");
+static_assert(displayDecoderData(displayDecoderAddress(0xFD, DISPLAY_DIGIT_TENS, DISPLAY_MODE_HEX)) == DISPLAY_SEGMENTS[0xF] &&
+              displayDecoderData(displayDecoderAddress(0xFD, DISPLAY_DIGIT_HUNDREDS, DISPLAY_MODE_HEX)) == DISPLAY_SEGMENTS_BLANK, "Hex digits");
+static_assert(displayDecoderData(displayDecoderAddress(7, DISPLAY_DIGIT_TENS, DISPLAY_MODE_UNSIGNED_NO_ZEROS)) == DISPLAY_SEGMENTS_BLANK &&
+              displayDecoderData(displayDecoderAddress(7, DISPLAY_DIGIT_TENS, DISPLAY_MODE_UNSIGNED)) == DISPLAY_SEGMENTS[0], "Leading zeros");
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef INDEX_SEQUENCE_H
+#define INDEX_SEQUENCE_H
+
+#include <stdint.h>
+
+/**
+ * A list of the addresses 0 ... N - 1 as template parameters, so the images can be written as {f(0), f(1), ... f(N - 1)}.
+ * The list is made by joining two halves. That way the template nesting grows with log2(N) instead of N.
+ */
+template<uint16_t... Indices>
+struct IndexSequence {
+    typedef IndexSequence type;
+};
+
+template<typename First, typename Second>
+struct ConcatIndexSequence;
+
+template<uint16_t... First, uint16_t... Second>
+struct ConcatIndexSequence<IndexSequence<First...>, IndexSequence<Second...> > : IndexSequence<First..., (sizeof...(First) + Second)...> {
+};
+
+template<uint16_t N>
+struct MakeIndexSequence : ConcatIndexSequence<typename MakeIndexSequence<N / 2>::type, typename MakeIndexSequence<N - N / 2>::type> {
+};
+
+template<>
+struct MakeIndexSequence<0> : IndexSequence<> {
+};
+
+template<>
+struct MakeIndexSequence<1> : IndexSequence<0> {
+};
+
+#endif
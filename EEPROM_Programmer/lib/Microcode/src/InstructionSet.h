@@ -0,0 +1,132 @@
+#ifndef INSTRUCTION_SET_H
+#define INSTRUCTION_SET_H
+
+#include <stdint.h>
+
+/**
+ * Because, we have many control signals we can't use a single EEPROM.
+ * ! Single EEPROM have only 8 outputs, which can't cover all signals and thus we can't active them.
+ * That means we must use 2 EEPROMs and program them separately. For the same address program first half and then the second.
+ * For easier programming the eeproms, instead of each time making the bits for a given microinstruction we can pre-define where the bits for a given
+ * control signal to be activated need to be and the using bitwise operators create the final control signals for single microinstruction.
+ */
+
+//First EEPROM
+#define HLT_CS 0b10000000
+#define MI_CS 0b01000000
+#define RI_CS 0b00100000
+#define RO_CS 0b00010000
+#define IO_CS 0b00001000
+#define II_CS 0b00000100
+#define AI_CS 0b00000010
+#define AO_CS 0b00000001
+
+//Second EEPROM
+#define EO_CS  0b10000000
+#define SU_CS  0b01000000
+#define BI_CS  0b00100000
+#define OI_CS  0b00010000
+#define CE_CS  0b00001000
+#define CO_CS  0b00000100
+#define J_CS   0b00000010
+#define RS_CS  0b00000001
+
+/**
+ * The same control signals in a single 16 bit control word.
+ * The most significant byte goes to the first EEPROM and the least significant byte to the second one.
+ *
+ * HLT MI RI RO IO II AI AO | EO SU BI OI CE CO J RS
+ *
+ * RS (Step Reset) goes to the synchronous clear of the step counter. On the next clock the counter goes to 0 instead of
+ * counting up, so the step with RS is the last one of the instruction and no clock is wasted for the reset.
+ */
+#define HLT_CW ((uint16_t) HLT_CS << 8)
+#define MI_CW ((uint16_t) MI_CS << 8)
+#define RI_CW ((uint16_t) RI_CS << 8)
+#define RO_CW ((uint16_t) RO_CS << 8)
+#define IO_CW ((uint16_t) IO_CS << 8)
+#define II_CW ((uint16_t) II_CS << 8)
+#define AI_CW ((uint16_t) AI_CS << 8)
+#define AO_CW ((uint16_t) AO_CS << 8)
+
+#define EO_CW ((uint16_t) EO_CS)
+#define SU_CW ((uint16_t) SU_CS)
+#define BI_CW ((uint16_t) BI_CS)
+#define OI_CW ((uint16_t) OI_CS)
+#define CE_CW ((uint16_t) CE_CS)
+#define CO_CW ((uint16_t) CO_CS)
+#define J_CW ((uint16_t) J_CS)
+#define RS_CW ((uint16_t) RS_CS)
+
+const uint8_t LDA_INSTRUCTION_CODE = 0b0000;
+const uint8_t LDB_INSTRUCTION_CODE = 0b0001;
+const uint8_t ADD_INSTRUCTION_CODE = 0b0010;
+const uint8_t SUB_INSTRUCTION_CODE = 0b0011;
+const uint8_t STA_INSTRUCTION_CODE = 0b0100;
+const uint8_t LDI_INSTRUCTION_CODE = 0b0101;
+const uint8_t JMP_INSTRUCTION_CODE = 0b0110;
+const uint8_t OUT_INSTRUCTION_CODE = 0b0111;
+const uint8_t HLT_INSTRUCTION_CODE = 0b1000;
+const uint8_t JC_INSTRUCTION_CODE = 0b1001;
+const uint8_t JZ_INSTRUCTION_CODE = 0b1010;
+
+/**
+ * The Flags register is connected to the address lines of the EEPROMs after the step (A7 and A8).
+ * It is loaded together with EO (when the ALU's result goes to the bus), thus no extra control signal is needed.
+ * FLAG_CARRY - The last ADD/SUB had a carry out.
+ * FLAG_ZERO - The result of the last ADD/SUB was 0.
+ */
+#define FLAG_CARRY 0b01
+#define FLAG_ZERO 0b10
+#define FLAG_BITS 2
+
+/**
+ * Each instruction takes MICROCODE_STEPS microinstructions (steps).
+ * The first MICROCODE_FETCH_STEPS are the same for all of them. They load the instruction from the memory in the Instruction Register.
+ */
+#define MICROCODE_STEPS 5
+#define MICROCODE_FETCH_STEPS 2
+#define MICROCODE_INSTRUCTION_STEPS (MICROCODE_STEPS - MICROCODE_FETCH_STEPS)
+
+/**
+ * @param condition The flags, which must be set for the steps to be executed. INSTRUCTION_ALWAYS if they don't depend on the flags.
+ * When the condition is not met only the fetch is executed and the rest of the steps are empty.
+ */
+#define INSTRUCTION_ALWAYS 0
+
+struct Instruction {
+    uint8_t code;
+    uint8_t condition;
+    uint16_t steps[MICROCODE_INSTRUCTION_STEPS];
+};
+
+/**
+ * 0: The Program Counter's value goes to the Memory Address Register.
+ * 1: The memory's value goes to the Instruction Register and the Program Counter is incremented.
+ */
+constexpr uint16_t FETCH[MICROCODE_FETCH_STEPS] = {
+        MI_CW | CO_CW,
+        RO_CW | II_CW | CE_CW
+};
+
+/**
+ * The steps of each instruction after the fetch.
+ * That is the only place, which must be changed when an instruction is added or changed. The EEPROM images are generated from it.
+ */
+constexpr Instruction INSTRUCTIONS[] = {
+        {LDA_INSTRUCTION_CODE, INSTRUCTION_ALWAYS, {MI_CW | IO_CW, RO_CW | AI_CW,         0}},
+        {LDB_INSTRUCTION_CODE, INSTRUCTION_ALWAYS, {MI_CW | IO_CW, RO_CW | BI_CW,         0}},
+        {ADD_INSTRUCTION_CODE, INSTRUCTION_ALWAYS, {MI_CW | IO_CW, RI_CW | EO_CW,         0}},
+        {SUB_INSTRUCTION_CODE, INSTRUCTION_ALWAYS, {MI_CW | IO_CW, RO_CW | EO_CW | SU_CW, AI_CW}},
+        {STA_INSTRUCTION_CODE, INSTRUCTION_ALWAYS, {MI_CW | IO_CW, RI_CW | AO_CW,         0}},
+        {LDI_INSTRUCTION_CODE, INSTRUCTION_ALWAYS, {IO_CW | AI_CW, 0,                     0}},
+        {JMP_INSTRUCTION_CODE, INSTRUCTION_ALWAYS, {IO_CW | J_CW,  0,                     0}},
+        {OUT_INSTRUCTION_CODE, INSTRUCTION_ALWAYS, {AO_CW | OI_CW, 0,                     0}},
+        {HLT_INSTRUCTION_CODE, INSTRUCTION_ALWAYS, {HLT_CW,        0,                     0}},
+        {JC_INSTRUCTION_CODE,  FLAG_CARRY,         {IO_CW | J_CW,  0,                     0}},
+        {JZ_INSTRUCTION_CODE,  FLAG_ZERO,          {IO_CW | J_CW,  0,                     0}}
+};
+
+#define INSTRUCTION_COUNT (sizeof(INSTRUCTIONS) / sizeof(INSTRUCTIONS[0]))
+
+#endif
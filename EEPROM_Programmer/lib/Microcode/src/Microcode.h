@@ -0,0 +1,267 @@
+#ifndef MICROCODE_H
+#define MICROCODE_H
+
+#include <stdint.h>
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#endif
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+#include <ImageFingerprint.h>
+
+#include "IndexSequence.h"
+#include "InstructionSet.h"
+
+/**
+ * Generates the images of the two microcode EEPROMs at compile time from the INSTRUCTIONS table.
+ * The images are placed in the flash (PROGMEM), so programming an EEPROM is a single loop over the image
+ * instead of a function call with a lookup for each address.
+ *
+ * Address:
+ * A0/3 Instruction (4 bits)
+ * A4/6: Microinstruction (3 bits)
+ * A7: Carry flag
+ * A8: Zero flag
+ * A9/10: Nothing Yet (all 0). The end of the chip holds the image's fingerprint (ImageFingerprint.h).
+ *
+ * Data:
+ * First EEPROM: HLT, MI, RI, RO, IO, II, AI, AO
+ * Second EEPROM: EO, SU, BI, OI, CE, CO, J, RS
+ *
+ * Example:
+ * Let's say we have the OUT instruction.
+ * The OUT instruction unique code (4 bit) is 0111.
+ * The OUT instruction needs 5 total microinstruction.
+ *       EEPROM Addr. |  Control Word (First EEPROM | Second EEPROM)
+ * 0:  0b000000000111      0b01000000 00000100
+ * 1:  0b000000010111      0b00010100 00001000
+ * 2:  0b000000100111      0b00000001 00010000
+ * 3:  0b000000110111      0b00000000 00000000
+ * 4:  0b000001000111      0b00000000 00000000
+ *
+ * Where EEPROM Address's patter is the following:
+ * 0b00{Flags (2 bits)}{N Microinstruction (3 bits)}{Instruction (4 Bits)}
+ *
+ * Each instruction is expanded in 4 variants, one for each combination of the flags. The unconditional instructions are
+ * the same in all of them. For JC/JZ the jump is in the variants with the flag set and the rest of them only fetch.
+ * The expansion is done by the compiler, so the images are just copied to the EEPROMs.
+ *
+ * The images covers all 512 addresses. The steps after MICROCODE_STEPS and the codes without an instruction are 0,
+ * except the fetch, which is the same for every code.
+ *
+ * Optimization (MICROCODE_STEP_RESET):
+ * Without it each instruction takes all MICROCODE_STEPS steps, even if the last ones are empty.
+ * With it the steps of the instruction (after the fetch) are optimized:
+ * - The empty steps are removed.
+ * - Consecutive steps are merged in one if the result is the same. See canMergeSteps().
+ * - RS is added to the last step, so the step counter starts from 0 right after the instruction.
+ * Example: LDI takes 3 steps instead of 5, LDA takes 4.
+ * The step counter must have RS connected, otherwise set MICROCODE_STEP_RESET to false.
+ */
+
+#ifndef MICROCODE_STEP_RESET
+#define MICROCODE_STEP_RESET true
+#endif
+
+#define MICROCODE_CODE_BITS 4
+#define MICROCODE_STEP_BITS 3
+#define MICROCODE_FLAGS_SHIFT (MICROCODE_CODE_BITS + MICROCODE_STEP_BITS)
+#define MICROCODE_IMAGE_SIZE (1 << (MICROCODE_FLAGS_SHIFT + FLAG_BITS))
+
+constexpr uint16_t microinstructionAddress(uint8_t step, uint8_t code, uint8_t flags = 0) {
+    return (flags << MICROCODE_FLAGS_SHIFT) | (step << MICROCODE_CODE_BITS) | code;
+}
+
+constexpr uint8_t microinstructionStep(uint16_t address) {
+    return (address >> MICROCODE_CODE_BITS) & ((1 << MICROCODE_STEP_BITS) - 1);
+}
+
+constexpr uint8_t microinstructionCode(uint16_t address) {
+    return address & ((1 << MICROCODE_CODE_BITS) - 1);
+}
+
+constexpr uint8_t microinstructionFlags(uint16_t address) {
+    return (address >> MICROCODE_FLAGS_SHIFT) & ((1 << FLAG_BITS) - 1);
+}
+
+constexpr bool isConditionMet(uint8_t condition, uint8_t flags) {
+    return condition == INSTRUCTION_ALWAYS || (flags & condition) == condition;
+}
+
+/**
+ * The control word of the @param step (after the fetch) of the instruction with @param code, when the Flags register holds @param flags.
+ * 0 if there is no such instruction or its condition is not met.
+ */
+constexpr uint16_t instructionControlWord(uint8_t code, uint8_t step, uint8_t flags, uint8_t index = 0) {
+    return index >= INSTRUCTION_COUNT ? 0 :
+           INSTRUCTIONS[index].code != code ? instructionControlWord(code, step, flags, index + 1) :
+           isConditionMet(INSTRUCTIONS[index].condition, flags) ? INSTRUCTIONS[index].steps[step - MICROCODE_FETCH_STEPS] :
+           0;
+}
+
+/**
+ * Control word without the optimization. Each instruction takes MICROCODE_STEPS steps.
+ */
+constexpr uint16_t fixedStepsControlWord(uint16_t address) {
+    return microinstructionStep(address) < MICROCODE_FETCH_STEPS ? FETCH[microinstructionStep(address)] :
+           microinstructionStep(address) < MICROCODE_STEPS ?
+           instructionControlWord(microinstructionCode(address), microinstructionStep(address), microinstructionFlags(address)) :
+           0;
+}
+
+/**
+ * The signals, which put something on the bus or take it from the bus.
+ */
+#define MICROCODE_BUS_SIGNALS (AO_CW | EO_CW | RO_CW | IO_CW | CO_CW | MI_CW | RI_CW | II_CW | AI_CW | BI_CW | OI_CW | J_CW)
+
+/**
+ * Two consecutive steps can be executed as one if:
+ * - Only one of them uses the bus. Otherwise the inputs would get another value or a register would be read after it was changed in the same clock.
+ * - None of them halts.
+ * - The Program Counter is not incremented in the first step and then read or changed in the second one (CO, J, CE).
+ * - SU is in the same step as its EO.
+ */
+constexpr bool canMergeSteps(uint16_t first, uint16_t second) {
+    return !((first & MICROCODE_BUS_SIGNALS) && (second & MICROCODE_BUS_SIGNALS)) &&
+           !((first | second) & HLT_CW) &&
+           !((first & CE_CW) && (second & (CO_CW | J_CW | CE_CW))) &&
+           !((second & CE_CW) && (first & J_CW)) &&
+           !((first & SU_CW) && (second & EO_CW)) &&
+           !((second & SU_CW) && (first & EO_CW));
+}
+
+constexpr uint8_t findInstruction(uint8_t code, uint8_t index = 0) {
+    return index >= INSTRUCTION_COUNT || INSTRUCTIONS[index].code == code ? index : findInstruction(code, index + 1);
+}
+
+/**
+ * Walks the steps of the instruction (after the fetch), skips the empty ones and merges the rest when possible.
+ * @return The control word of the merged step with index @param target. 0 if there are less merged steps.
+ */
+constexpr uint16_t mergedStep(uint8_t instruction, uint8_t target, uint8_t index = 0, uint8_t merged = 0, uint16_t word = 0) {
+    return index >= MICROCODE_INSTRUCTION_STEPS ? (merged == target ? word : 0) :
+           INSTRUCTIONS[instruction].steps[index] == 0 ? mergedStep(instruction, target, index + 1, merged, word) :
+           word == 0 || canMergeSteps(word, INSTRUCTIONS[instruction].steps[index]) ?
+           mergedStep(instruction, target, index + 1, merged, word | INSTRUCTIONS[instruction].steps[index]) :
+           merged == target ? word :
+           mergedStep(instruction, target, index + 1, merged + 1, INSTRUCTIONS[instruction].steps[index]);
+}
+
+constexpr uint8_t mergedStepCount(uint8_t instruction, uint8_t index = 0, uint8_t merged = 0, uint16_t word = 0) {
+    return index >= MICROCODE_INSTRUCTION_STEPS ? merged + (word != 0) :
+           INSTRUCTIONS[instruction].steps[index] == 0 ? mergedStepCount(instruction, index + 1, merged, word) :
+           word == 0 || canMergeSteps(word, INSTRUCTIONS[instruction].steps[index]) ?
+           mergedStepCount(instruction, index + 1, merged, word | INSTRUCTIONS[instruction].steps[index]) :
+           mergedStepCount(instruction, index + 1, merged + 1, INSTRUCTIONS[instruction].steps[index]);
+}
+
+/**
+ * Number of the optimized steps after the fetch. 0 for a code without an instruction or if the condition is not met.
+ */
+constexpr uint8_t optimizedStepCount(uint8_t code, uint8_t flags) {
+    return findInstruction(code) < INSTRUCTION_COUNT && isConditionMet(INSTRUCTIONS[findInstruction(code)].condition, flags) ?
+           mergedStepCount(findInstruction(code)) : 0;
+}
+
+/**
+ * An instruction without steps still needs one with RS, because the step after the fetch is the first one,
+ * which knows the instruction (the Instruction Register is loaded at the end of the fetch).
+ */
+constexpr uint16_t optimizedInstructionControlWord(uint8_t code, uint8_t step, uint8_t flags) {
+    return optimizedStepCount(code, flags) == 0 ? (step == 0 ? RS_CW : 0) :
+           step < optimizedStepCount(code, flags) ?
+           mergedStep(findInstruction(code), step) | (step + 1 == optimizedStepCount(code, flags) ? RS_CW : 0) :
+           0;
+}
+
+constexpr uint16_t optimizedControlWord(uint16_t address) {
+    return microinstructionStep(address) < MICROCODE_FETCH_STEPS ? FETCH[microinstructionStep(address)] :
+           optimizedInstructionControlWord(microinstructionCode(address), microinstructionStep(address) - MICROCODE_FETCH_STEPS,
+                                           microinstructionFlags(address));
+}
+
+/**
+ * Total steps of the instruction (with the fetch).
+ */
+constexpr uint8_t instructionSteps(uint8_t code, uint8_t flags, bool optimized) {
+    return optimized ? MICROCODE_FETCH_STEPS + (optimizedStepCount(code, flags) == 0 ? 1 : optimizedStepCount(code, flags)) : MICROCODE_STEPS;
+}
+
+constexpr uint16_t microcodeControlWord(uint16_t address, bool optimized = MICROCODE_STEP_RESET) {
+    return optimized ? optimizedControlWord(address) : fixedStepsControlWord(address);
+}
+
+constexpr uint8_t microcodeFirstEEPROMData(uint16_t address, bool optimized = MICROCODE_STEP_RESET) {
+    return microcodeControlWord(address, optimized) >> 8;
+}
+
+constexpr uint8_t microcodeSecondEEPROMData(uint16_t address, bool optimized = MICROCODE_STEP_RESET) {
+    return microcodeControlWord(address, optimized) & 0xFF;
+}
+
+constexpr uint8_t microcodeEEPROMData(bool second, uint16_t address, bool optimized = MICROCODE_STEP_RESET) {
+    return second ? microcodeSecondEEPROMData(address, optimized) : microcodeFirstEEPROMData(address, optimized);
+}
+
+/**
+ * FNV-1a of the addresses @param from ... @param to - 1 of the image (same as fingerprintBytes() over MicrocodeImage).
+ * The range is split in halves, so the recursion is log2(N) deep and stays under the compiler's constexpr limit.
+ */
+constexpr uint32_t microcodeFingerprint(bool second, uint16_t from = 0, uint16_t to = MICROCODE_IMAGE_SIZE, uint32_t hash = FINGERPRINT_BASIS,
+                                        bool optimized = MICROCODE_STEP_RESET) {
+    return to - from == 1 ? fingerprintUpdate(hash, microcodeEEPROMData(second, from, optimized)) :
+           microcodeFingerprint(second, from + (to - from) / 2, to, microcodeFingerprint(second, from, from + (to - from) / 2, hash, optimized), optimized);
+}
+
+template<typename Addresses, bool Optimized>
+struct MicrocodeImages;
+
+template<uint16_t... Addresses, bool Optimized>
+struct MicrocodeImages<IndexSequence<Addresses...>, Optimized> {
+    static const uint8_t first[sizeof...(Addresses)];
+    static const uint8_t second[sizeof...(Addresses)];
+};
+
+template<uint16_t... Addresses, bool Optimized>
+const uint8_t MicrocodeImages<IndexSequence<Addresses...>, Optimized>::first[sizeof...(Addresses)] PROGMEM = {
+        microcodeFirstEEPROMData(Addresses, Optimized)...};
+
+template<uint16_t... Addresses, bool Optimized>
+const uint8_t MicrocodeImages<IndexSequence<Addresses...>, Optimized>::second[sizeof...(Addresses)] PROGMEM = {
+        microcodeSecondEEPROMData(Addresses, Optimized)...};
+
+/**
+ * MicrocodeImage::first and MicrocodeImage::second are the MICROCODE_IMAGE_SIZE bytes of the two EEPROMs.
+ * On the AVR they are in the flash and must be read with pgm_read_byte().
+ * FixedStepsMicrocodeImage and OptimizedMicrocodeImage are for comparing both variants on the host.
+ * Only the used one ends up in the flash.
+ */
+typedef MicrocodeImages<MakeIndexSequence<MICROCODE_IMAGE_SIZE>::type, MICROCODE_STEP_RESET> MicrocodeImage;
+typedef MicrocodeImages<MakeIndexSequence<MICROCODE_IMAGE_SIZE>::type, false> FixedStepsMicrocodeImage;
+typedef MicrocodeImages<MakeIndexSequence<MICROCODE_IMAGE_SIZE>::type, true> OptimizedMicrocodeImage;
+
+static_assert(microcodeFirstEEPROMData(microinstructionAddress(0, OUT_INSTRUCTION_CODE)) == MI_CS, "Fetch must be the same for each instruction");
+static_assert(microcodeSecondEEPROMData(microinstructionAddress(1, OUT_INSTRUCTION_CODE)) == CE_CS, "Fetch must be the same for each instruction");
+static_assert(fixedStepsControlWord(microinstructionAddress(2, OUT_INSTRUCTION_CODE)) == (AO_CW | OI_CW), "OUT must output the A register");
+static_assert(fixedStepsControlWord(microinstructionAddress(4, SUB_INSTRUCTION_CODE)) == AI_CW, "SUB must store the result in the A register");
+static_assert(fixedStepsControlWord(microinstructionAddress(5, HLT_INSTRUCTION_CODE)) == 0, "The steps after MICROCODE_STEPS must be empty");
+static_assert(fixedStepsControlWord(microinstructionAddress(2, JC_INSTRUCTION_CODE, FLAG_CARRY)) == (IO_CW | J_CW) &&
+              fixedStepsControlWord(microinstructionAddress(2, JC_INSTRUCTION_CODE, FLAG_ZERO)) == 0, "JC must jump only with carry");
+static_assert(fixedStepsControlWord(microinstructionAddress(2, JZ_INSTRUCTION_CODE, FLAG_ZERO | FLAG_CARRY)) == (IO_CW | J_CW) &&
+              fixedStepsControlWord(microinstructionAddress(2, JZ_INSTRUCTION_CODE, FLAG_CARRY)) == 0, "JZ must jump only with zero");
+static_assert(fixedStepsControlWord(microinstructionAddress(3, LDA_INSTRUCTION_CODE, FLAG_CARRY | FLAG_ZERO)) ==
+              fixedStepsControlWord(microinstructionAddress(3, LDA_INSTRUCTION_CODE)), "The flags must not change the other instructions");
+
+static_assert(optimizedControlWord(microinstructionAddress(2, OUT_INSTRUCTION_CODE)) == (AO_CW | OI_CW | RS_CW), "OUT must reset the steps after its only step");
+static_assert(optimizedControlWord(microinstructionAddress(3, LDA_INSTRUCTION_CODE)) == (RO_CW | AI_CW | RS_CW), "LDA must reset the steps after 4 steps");
+static_assert(optimizedControlWord(microinstructionAddress(2, JC_INSTRUCTION_CODE)) == RS_CW, "JC without carry must only reset the steps");
+static_assert(instructionSteps(LDI_INSTRUCTION_CODE, 0, true) == 3 && instructionSteps(SUB_INSTRUCTION_CODE, 0, true) == 5, "Unexpected optimized steps");
+static_assert(MICROCODE_IMAGE_SIZE <= imageFingerprintAddress(CHIP_28C16), "The fingerprint must not overlap the image");
+static_assert(!canMergeSteps(MI_CW | IO_CW, RO_CW | AI_CW) && canMergeSteps(CE_CW, AO_CW | OI_CW) && !canMergeSteps(CE_CW, CO_CW | MI_CW),
+              "Unexpected merging of steps");
+
+#endif
@@ -0,0 +1,78 @@
+#include "PackedImage.h"
+
+/**
+ * How many times the byte at @param offset repeats, up to @param max.
+ */
+static uint32_t runLength(const uint8_t* image, const uint32_t& length, const uint32_t& offset, const uint32_t& max) {
+
+    uint32_t run = 1;
+
+    while (offset + run < length && run < max && image[offset + run] == image[offset])
+        run++;
+
+    return run;
+}
+
+uint32_t packImageChunk(const uint8_t* image, const uint32_t& length, const int16_t& skipValue, uint8_t* out, const uint16_t& capacity,
+                        uint16_t& outLength) {
+
+    uint32_t offset = 0;
+    outLength = 0;
+
+    while (offset < length && capacity - outLength >= 2) {
+
+        if (skipValue >= 0 && image[offset] == skipValue) {
+            uint32_t skip = runLength(image, length, offset, PACKED_MAX_SKIP);
+            out[outLength++] = PACKED_SKIP | (skip - 1) >> 8;
+            out[outLength++] = (skip - 1) & 0xFF;
+            offset += skip;
+            continue;
+        }
+
+        uint32_t run = runLength(image, length, offset, PACKED_MAX_RUN);
+
+        if (run >= PACKED_MIN_RUN) {
+            out[outLength++] = PACKED_RUN | (run - PACKED_MIN_RUN);
+            out[outLength++] = image[offset];
+            offset += run;
+            continue;
+        }
+
+        /**
+         * The literal ends before the next run or skipped byte, where a shorter record starts.
+         */
+        uint32_t literal = 0;
+        uint32_t maxLiteral = capacity - outLength - 1 < PACKED_MAX_LITERAL ? capacity - outLength - 1 : PACKED_MAX_LITERAL;
+
+        while (offset + literal < length && literal < maxLiteral) {
+            uint8_t byte = image[offset + literal];
+
+            if ((skipValue >= 0 && byte == skipValue) || runLength(image, length, offset + literal, PACKED_MIN_RUN) >= PACKED_MIN_RUN)
+                break;
+
+            literal++;
+        }
+
+        out[outLength++] = PACKED_LITERAL | (literal - 1);
+
+        for (uint32_t i = 0; i < literal; ++i)
+            out[outLength++] = image[offset + i];
+
+        offset += literal;
+    }
+
+    return offset;
+}
+
+uint32_t packImage(const uint8_t* image, const uint32_t& length, const int16_t& skipValue, uint8_t* out) {
+
+    uint16_t chunkLength;
+    uint32_t packedLength = 0;
+
+    for (uint32_t offset = 0; offset < length;) {
+        offset += packImageChunk(image + offset, length - offset, skipValue, out + packedLength, 0xFFFF, chunkLength);
+        packedLength += chunkLength;
+    }
+
+    return packedLength;
+}
@@ -0,0 +1,206 @@
+#ifndef PACKED_IMAGE_H
+#define PACKED_IMAGE_H
+
+#include <stdint.h>
+
+/**
+ * Compact format of the EEPROM images for the serial transfer (DATA_PACKED in SerialProtocol.h) and for the Nano's flash.
+ * The microcode is mostly zeros (the unused steps and codes) and the display decoders repeat the same patterns,
+ * so most of the image are runs of the same byte.
+ *
+ * The image is a sequence of records. The first byte tells the type and the length:
+ * | 0b0nnnnnnn | n + 1 bytes ...         | LITERAL - 1 to 128 bytes as they are.
+ * | 0b10nnnnnn | value                   | RUN - n + 3 (3 to 66) times the value.
+ * | 0b11nnnnnn | nnnnnnnn                | SKIP - n + 1 (1 to 16384) addresses are not part of the image.
+ *
+ * The skipped addresses are neither written nor verified, whatever the chip holds there stays. packImage() skips only the runs
+ * of a given value, for example 0xFF for an erased chip, or nothing at all.
+ *
+ * The decoding (PackedImageReader) needs no buffer for the whole image, it expands the records only as far as they are asked for.
+ */
+
+#define PACKED_LITERAL 0x00
+#define PACKED_RUN 0x80
+#define PACKED_SKIP 0xC0
+#define PACKED_TYPE_MASK 0xC0
+
+#define PACKED_MAX_LITERAL 128
+#define PACKED_MIN_RUN 3
+#define PACKED_MAX_RUN (0x3F + PACKED_MIN_RUN)
+#define PACKED_MAX_SKIP 0x4000
+
+/**
+ * No value is skipped by packImage().
+ */
+#define PACKED_NO_SKIP -1
+
+/**
+ * Packs as much of the @param image as fits in @param capacity bytes (at least 2). The records end where the output ends,
+ * so each chunk can be decoded on its own (one DATA_PACKED frame).
+ * @param skipValue Runs of that value become SKIP records. PACKED_NO_SKIP packs everything.
+ * @param outLength The packed bytes in @param out.
+ * @return How many bytes of the image were packed.
+ */
+uint32_t packImageChunk(const uint8_t* image, const uint32_t& length, const int16_t& skipValue, uint8_t* out, const uint16_t& capacity,
+                        uint16_t& outLength);
+
+/**
+ * Packs the whole @param image in @param out, which must have space for packedImageBound() bytes.
+ * @return The packed length.
+ */
+uint32_t packImage(const uint8_t* image, const uint32_t& length, const int16_t& skipValue, uint8_t* out);
+
+/**
+ * The worst case (no runs at all) - one LITERAL header per 128 bytes.
+ */
+constexpr uint32_t packedImageBound(uint32_t length) {
+    return length + (length + PACKED_MAX_LITERAL - 1) / PACKED_MAX_LITERAL;
+}
+
+/**
+ * The packed bytes in the RAM. For the flash main.cpp uses ProgmemImage.
+ */
+struct MemoryBytes {
+    const uint8_t* data;
+
+    uint8_t operator()(const uint16_t& offset) const {
+        return data[offset];
+    }
+};
+
+/**
+ * Expands the packed image record by record.
+ * The @param Source must provide uint8_t operator()(uint16_t offset), so the packed image can be in the RAM or in the flash.
+ *
+ * Example:
+ * reader.begin(source, packedLength, 0);
+ * while ((count = reader.read(address, page, pageSize)) > 0)
+ *     programmer.programEEPROMBytes(address, page, count);
+ */
+template<typename Source>
+class PackedImageReader {
+
+public:
+
+    PackedImageReader() : source(), length(0), position(0), address(0), type(PACKED_LITERAL), remaining(0), value(0), packed(true) {
+    }
+
+    /**
+     * @param length Of the packed image.
+     * @param address Where the image's first byte goes.
+     * @param packed False if the source holds the bytes as they are (a plain DATA frame). They are read like a single LITERAL.
+     */
+    void begin(const Source& source, const uint16_t& length, const uint16_t& address, const bool& packed = true) {
+        this->source = source;
+        this->length = length;
+        this->address = address;
+        this->packed = packed;
+        position = 0;
+        remaining = 0;
+    }
+
+    /**
+     * Expands up to @param max bytes of consecutive addresses in the @param out. It stops before a SKIP, so the next call
+     * continues after the skipped addresses.
+     * @param outAddress The address of out[0].
+     * @param continuing The bytes continue a previous output at getAddress(), so a SKIP at the start ends the read too.
+     * @return The number of bytes. 0 at the end of the image.
+     */
+    uint8_t read(uint16_t& outAddress, uint8_t* out, const uint8_t& max, const bool& continuing = false) {
+
+        uint8_t count = 0;
+
+        while (count < max) {
+
+            if (remaining == 0 && !nextRecord(count == 0 && !continuing))
+                break;
+
+            if (count == 0)
+                outAddress = address;
+
+            out[count++] = type == PACKED_RUN ? value : source(position++);
+            address++;
+            remaining--;
+        }
+
+        return count;
+    }
+
+    /**
+     * The address of the next byte, unless a SKIP comes first.
+     */
+    uint16_t getAddress() const {
+        return address;
+    }
+
+    bool isDone() const {
+        return remaining == 0 && position >= length;
+    }
+
+private:
+
+    /**
+     * Reads the next record's header. A SKIP is taken only if @param canSkip, otherwise the output would not be consecutive.
+     * A truncated record ends the image.
+     */
+    bool nextRecord(const bool& canSkip) {
+
+        while (position < length) {
+
+            if (!packed) {
+                type = PACKED_LITERAL;
+                remaining = length - position;
+                return true;
+            }
+
+            uint8_t header = source(position);
+            type = header & PACKED_TYPE_MASK;
+
+            if (type == PACKED_SKIP) {
+                if (!canSkip)
+                    return false;
+
+                if (position + 2 > length)
+                    break;
+
+                address += (((uint16_t) (header & 0x3F) << 8) | source(position + 1)) + 1;
+                position += 2;
+                continue;
+            }
+
+            if (type == PACKED_RUN) {
+                if (position + 2 > length)
+                    break;
+
+                remaining = (header & 0x3F) + PACKED_MIN_RUN;
+                value = source(position + 1);
+                position += 2;
+                return true;
+            }
+
+            type = PACKED_LITERAL;
+            remaining = (header & 0x7F) + 1;
+            position++;
+
+            if (position + remaining > length)
+                break;
+
+            return true;
+        }
+
+        position = length;
+        remaining = 0;
+        return false;
+    }
+
+    Source source;
+    uint16_t length;
+    uint16_t position;
+    uint16_t address;
+    uint8_t type;
+    uint16_t remaining;
+    uint8_t value;
+    bool packed;
+};
+
+#endif
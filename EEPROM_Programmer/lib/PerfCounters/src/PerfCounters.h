@@ -0,0 +1,130 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+
+/**
+ * Counters of the time, which the programmer spends in each of its operations. They show where the time goes (shifting the address,
+ * the data bus, the write cycle or the serial link) before anything is optimized.
+ *
+ * The drivers mark each operation with HAL::beginOperation() and HAL::endOperation() (see HAL.h). Only ProfilingHAL (ProfilingHAL.h)
+ * measures them, the other HALs do nothing, so without it there is no cost.
+ *
+ * Operations:
+ * - SHIFT - Shifting a word in the shift registers (bit bang or SPI), without the latch.
+ * - LATCH - The RCLK pulse.
+ * - BUS_TURNAROUND - Switching the data bus between INPUT and OUTPUT.
+ * - BUS_WRITE - Putting a byte on the data bus.
+ * - READ - Reading the data bus, the polls of the write cycle included.
+ * - WRITE_WAIT - From the start until the end of a write cycle, blocking (waitForEEPROMWriteCycle()) or polled (pollEEPROMBytes()).
+ * - SERIAL - Sending over the serial link, which waits when the transmit buffer is full.
+ *
+ * The time is in CPU cycles. The short operations are measured with the cycle counter (HAL::cycleCounter()), which wraps
+ * at 65536 cycles. WRITE_WAIT and SERIAL can take longer, so they are measured with micros() (4us steps on the Nano).
+ */
+
+#define PERF_SHIFT 0
+#define PERF_LATCH 1
+#define PERF_BUS_TURNAROUND 2
+#define PERF_BUS_WRITE 3
+#define PERF_READ 4
+#define PERF_WRITE_WAIT 5
+#define PERF_SERIAL 6
+#define PERF_OPERATIONS 7
+
+#define PERF_COUNTER_LENGTH 20
+
+/**
+ * @param total Of all measurements. 64 bits, so it doesn't overflow during a long programming (32 bits are ~4 minutes at 16 MHz).
+ */
+struct PerfCounter {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+};
+
+inline bool isLongPerfOperation(const uint8_t& operation) {
+    return operation == PERF_WRITE_WAIT || operation == PERF_SERIAL;
+}
+
+/**
+ * Short names without spaces for the machine readable report.
+ */
+inline const char* perfOperationName(const uint8_t& operation) {
+
+    static const char* const NAMES[PERF_OPERATIONS] = {"shift", "latch", "bus_turnaround", "bus_write", "read", "write_wait", "serial"};
+
+    return operation < PERF_OPERATIONS ? NAMES[operation] : "unknown";
+}
+
+/**
+ * Big endian count, min, max and total. Used when the counters are sent to the host.
+ */
+inline void encodePerfCounter(const PerfCounter& counter, uint8_t* out) {
+
+    uint32_t values[3] = {counter.count, counter.min, counter.max};
+
+    for (uint8_t i = 0; i < 3; ++i) {
+        for (uint8_t byte = 0; byte < 4; ++byte)
+            out[4 * i + byte] = values[i] >> (24 - 8 * byte);
+    }
+
+    for (uint8_t byte = 0; byte < 8; ++byte)
+        out[12 + byte] = counter.total >> (56 - 8 * byte);
+}
+
+inline PerfCounter decodePerfCounter(const uint8_t* in) {
+
+    uint32_t values[3] = {0, 0, 0};
+    uint64_t total = 0;
+
+    for (uint8_t i = 0; i < 3; ++i) {
+        for (uint8_t byte = 0; byte < 4; ++byte)
+            values[i] = (values[i] << 8) | in[4 * i + byte];
+    }
+
+    for (uint8_t byte = 0; byte < 8; ++byte)
+        total = (total << 8) | in[12 + byte];
+
+    PerfCounter counter = {values[0], values[1], values[2], total};
+    return counter;
+}
+
+class PerfCounters {
+
+public:
+
+    PerfCounters() {
+        clear();
+    }
+
+    void record(const uint8_t& operation, const uint32_t& cycles) {
+
+        PerfCounter& counter = counters[operation];
+
+        if (counter.count == 0 || cycles < counter.min)
+            counter.min = cycles;
+
+        if (cycles > counter.max)
+            counter.max = cycles;
+
+        counter.count++;
+        counter.total += cycles;
+    }
+
+    const PerfCounter& get(const uint8_t& operation) const {
+        return counters[operation];
+    }
+
+    void clear() {
+        for (uint8_t i = 0; i < PERF_OPERATIONS; ++i)
+            counters[i] = {0, 0, 0, 0};
+    }
+
+private:
+
+    PerfCounter counters[PERF_OPERATIONS];
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef PROFILING_HAL_H
+#define PROFILING_HAL_H
+
+#include <HAL.h>
+
+#include "PerfCounters.h"
+
+/**
+ * HAL (see HAL.h), which passes everything to the wrapped @param HAL and measures the operations marked by the drivers
+ * (beginOperation() and endOperation()) in the PerfCounters. Like TracingHAL nothing in the drivers changes:
+ * EEPROMProgrammer<ProfilingHAL<ArduinoHAL>>
+ * On the host it wraps the SimulatedBoard, so the same counters can be compared between the Nano and the simulation.
+ *
+ * ! Each measurement costs some cycles (reading the counter and updating min/max/total), which are partly counted
+ * in the enclosing operations, for example the reads inside of WRITE_WAIT.
+ */
+template<typename HAL>
+class ProfilingHAL {
+
+public:
+
+    typedef typename HAL::Pin Pin;
+
+    /**
+     * @param clockHz The CPU clock, which converts micros() of the long operations to cycles.
+     */
+    ProfilingHAL(HAL& hal, PerfCounters& counters, const uint32_t& clockHz)
+            : hal(hal),
+              counters(counters),
+              clockHz(clockHz) {
+    }
+
+    /**
+     * Starts the cycle counter. Must be called in setup().
+     */
+    void begin() {
+        hal.beginCycleCounter();
+    }
+
+    void beginOperation(const uint8_t& operation) {
+        hal.beginOperation(operation);
+
+        if (isLongPerfOperation(operation))
+            starts[operation] = hal.micros();
+        else
+            starts[operation] = hal.cycleCounter();
+    }
+
+    void endOperation(const uint8_t& operation) {
+
+        uint32_t cycles;
+
+        if (isLongPerfOperation(operation))
+            cycles = (hal.micros() - starts[operation]) * (clockHz / 1000000);
+        else
+            cycles = (uint16_t) (hal.cycleCounter() - starts[operation]);
+
+        counters.record(operation, cycles);
+        hal.endOperation(operation);
+    }
+
+    Pin pin(const uint8_t& number) {
+        return hal.pin(number);
+    }
+
+    void pinMode(const uint8_t& number, const uint8_t& mode) {
+        hal.pinMode(number, mode);
+    }
+
+    void write(const Pin& pin, const bool& value) {
+        hal.write(pin, value);
+    }
+
+    uint8_t disableInterrupts() {
+        return hal.disableInterrupts();
+    }
+
+    void restoreInterrupts(const uint8_t& state) {
+        hal.restoreInterrupts(state);
+    }
+
+    void setDataBusDirection(const uint8_t& direction) {
+        hal.setDataBusDirection(direction);
+    }
+
+    void writeDataBus(const uint8_t& data) {
+        hal.writeDataBus(data);
+    }
+
+    uint8_t readDataBus() {
+        return hal.readDataBus();
+    }
+
+    void spiBegin() {
+        hal.spiBegin();
+    }
+
+    void spiTransfer(const uint8_t* bytes, const uint8_t& length, const uint32_t& clock, const uint8_t& bitOrder) {
+        hal.spiTransfer(bytes, length, clock, bitOrder);
+    }
+
+    uint32_t micros() {
+        return hal.micros();
+    }
+
+    void delayMicroseconds(const uint16_t& us) {
+        hal.delayMicroseconds(us);
+    }
+
+    void delayMilliseconds(const uint16_t& ms) {
+        hal.delayMilliseconds(ms);
+    }
+
+    void beginCycleCounter() {
+        hal.beginCycleCounter();
+    }
+
+    uint16_t cycleCounter() {
+        return hal.cycleCounter();
+    }
+
+    PerfCounters& getCounters() {
+        return counters;
+    }
+
+    uint32_t getClockHz() const {
+        return clockHz;
+    }
+
+private:
+
+    HAL& hal;
+    PerfCounters& counters;
+    uint32_t clockHz;
+    uint32_t starts[PERF_OPERATIONS];
+};
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef PIN_TRACE_H
+#define PIN_TRACE_H
+
+#include <stdint.h>
+
+/**
+ * Trace of the programmer's pins, which shows if the EEPROM's write timing (tAS, tAH, tWP, tDS) is met without a logic analyzer.
+ *
+ * Each transition of a signal is an event with the time in CPU cycles.
+ * The time is only the lower 16 bits of the cycle counter (HAL::cycleCounter()), so an event takes 4 bytes.
+ * The host unwraps it by adding the difference of the consecutive events. At 16 MHz the counter overflows every 4.096ms,
+ * thus longer gaps (the fixed delay of a write cycle) are shortened. The short timings between the events are always exact.
+ *
+ * Signals:
+ * - SER, SRCLK, RCLK, WE - The levels of the pins.
+ * - OE - The EEPROM's OE as it comes out of the shift registers (the bit of the shift word, active LOW). It changes on the rising edge of RCLK.
+ * - IO - The byte, which the programmer drives on I/O0-7.
+ * - IO_RELEASED - The data bus became an input, so the programmer doesn't drive it anymore.
+ *
+ * The address comes out of the shift registers too, so it changes on each rising edge of RCLK.
+ */
+
+#define PIN_TRACE_SER 0
+#define PIN_TRACE_SRCLK 1
+#define PIN_TRACE_RCLK 2
+#define PIN_TRACE_WE 3
+#define PIN_TRACE_OE 4
+#define PIN_TRACE_IO 5
+#define PIN_TRACE_IO_RELEASED 6
+#define PIN_TRACE_NONE 0xFF
+
+#define PIN_TRACE_EVENT_LENGTH 4
+
+struct PinTraceEvent {
+    uint16_t cycles;
+    uint8_t signal;
+    uint8_t value;
+};
+
+/**
+ * Big endian cycles, signal, value. Used when the trace is sent to the host.
+ */
+inline void encodePinTraceEvent(const PinTraceEvent& event, uint8_t* out) {
+    out[0] = event.cycles >> 8;
+    out[1] = event.cycles;
+    out[2] = event.signal;
+    out[3] = event.value;
+}
+
+inline PinTraceEvent decodePinTraceEvent(const uint8_t* in) {
+    PinTraceEvent event = {(uint16_t) (((uint16_t) in[0] << 8) | in[1]), in[2], in[3]};
+    return event;
+}
+
+/**
+ * Ring buffer with the last @param Length events. The older ones are overwritten, so after a failed write
+ * the buffer holds the pins' activity right before the failure.
+ * @param Length Must be a power of two.
+ */
+template<uint16_t Length>
+class PinTraceBuffer {
+
+    static_assert((Length & (Length - 1)) == 0, "The length of the trace buffer must be a power of two");
+
+public:
+
+    PinTraceBuffer() : next(0), count(0), overwritten(0) {
+    }
+
+    void record(const uint16_t& cycles, const uint8_t& signal, const uint8_t& value) {
+        PinTraceEvent& event = events[next];
+        event.cycles = cycles;
+        event.signal = signal;
+        event.value = value;
+
+        next = (next + 1) & (Length - 1);
+
+        if (count < Length)
+            count++;
+        else
+            overwritten++;
+    }
+
+    void clear() {
+        next = 0;
+        count = 0;
+        overwritten = 0;
+    }
+
+    uint16_t getCount() const {
+        return count;
+    }
+
+    /**
+     * How many of the older events were lost.
+     */
+    uint32_t getOverwritten() const {
+        return overwritten;
+    }
+
+    /**
+     * @param index 0 is the oldest event in the buffer.
+     */
+    const PinTraceEvent& get(const uint16_t& index) const {
+        return events[(next - count + index) & (Length - 1)];
+    }
+
+private:
+
+    PinTraceEvent events[Length];
+    uint16_t next;
+    uint16_t count;
+    uint32_t overwritten;
+};
+
+#endif
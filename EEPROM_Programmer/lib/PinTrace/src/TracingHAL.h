@@ -0,0 +1,200 @@
+#ifndef TRACING_HAL_H
+#define TRACING_HAL_H
+
+#include <HAL.h>
+#include <DataBus.h>
+
+#include "PinTrace.h"
+
+/**
+ * HAL (see HAL.h), which passes everything to the wrapped @param HAL and records the transitions of the programmer's pins
+ * in the @param Trace (see PinTrace.h). The drivers use it instead of the real HAL, so nothing in them changes:
+ * EEPROMProgrammer<TracingHAL<ArduinoHAL, PinTraceBuffer<128>>>
+ *
+ * The @param Trace must provide:
+ * - void record(uint16_t cycles, uint8_t signal, uint8_t value)
+ *
+ * OE is not a pin of the Arduino. The shifted bits are followed here like in the 74HC595 and OE is taken from the latched ones.
+ * In SPI mode SER and SRCLK are driven by the SPI peripheral, so only RCLK, OE, WE and the data bus are recorded.
+ *
+ * ! Each event costs some cycles on the Nano, thus the traced timing is a bit slower than the untraced one.
+ */
+template<typename HAL, typename Trace>
+class TracingHAL {
+
+public:
+
+    struct Pin {
+        typename HAL::Pin pin;
+        uint8_t signal;
+    };
+
+    /**
+     * @param outputEnableBit The bit of the shift word, which drives OE.
+     */
+    TracingHAL(HAL& hal, Trace& trace, const uint8_t& serPin, const uint8_t& srClkPin, const uint8_t& rclkPin, const uint8_t& wePin,
+               const uint8_t& outputEnableBit)
+            : hal(hal),
+              trace(trace),
+              serPin(serPin),
+              srClkPin(srClkPin),
+              rclkPin(rclkPin),
+              wePin(wePin),
+              outputEnableBit(outputEnableBit),
+              ser(LOW),
+              shifted(0),
+              outputEnable(PIN_TRACE_NONE),
+              dataBus(0),
+              dataBusDriven(false) {
+    }
+
+    /**
+     * Starts the cycle counter of the timestamps. Must be called in setup().
+     */
+    void begin() {
+        hal.beginCycleCounter();
+    }
+
+    Pin pin(const uint8_t& number) {
+        Pin pin;
+        pin.pin = hal.pin(number);
+        pin.signal = number == serPin ? PIN_TRACE_SER :
+                     number == srClkPin ? PIN_TRACE_SRCLK :
+                     number == rclkPin ? PIN_TRACE_RCLK :
+                     number == wePin ? PIN_TRACE_WE : PIN_TRACE_NONE;
+        return pin;
+    }
+
+    void pinMode(const uint8_t& number, const uint8_t& mode) {
+        hal.pinMode(number, mode);
+    }
+
+    void write(const Pin& pin, const bool& value) {
+        hal.write(pin.pin, value);
+
+        if (pin.signal == PIN_TRACE_NONE)
+            return;
+
+        record(pin.signal, value);
+
+        if (pin.signal == PIN_TRACE_SER)
+            ser = value;
+        else if (pin.signal == PIN_TRACE_SRCLK && value)
+            shifted = (shifted << 1) | ser;
+        else if (pin.signal == PIN_TRACE_RCLK && value)
+            latch();
+    }
+
+    uint8_t disableInterrupts() {
+        return hal.disableInterrupts();
+    }
+
+    void restoreInterrupts(const uint8_t& state) {
+        hal.restoreInterrupts(state);
+    }
+
+    void setDataBusDirection(const uint8_t& direction) {
+        hal.setDataBusDirection(direction);
+
+        if (direction == DATA_BUS_OUTPUT)
+            return;
+
+        dataBusDriven = false;
+        record(PIN_TRACE_IO_RELEASED, 0);
+    }
+
+    void writeDataBus(const uint8_t& data) {
+        hal.writeDataBus(data);
+
+        if (dataBusDriven && data == dataBus)
+            return;
+
+        dataBus = data;
+        dataBusDriven = true;
+        record(PIN_TRACE_IO, data);
+    }
+
+    uint8_t readDataBus() {
+        return hal.readDataBus();
+    }
+
+    void spiBegin() {
+        hal.spiBegin();
+    }
+
+    void spiTransfer(const uint8_t* bytes, const uint8_t& length, const uint32_t& clock, const uint8_t& bitOrder) {
+        hal.spiTransfer(bytes, length, clock, bitOrder);
+
+        for (uint8_t i = 0; i < length; ++i) {
+            for (uint8_t bit = 0; bit < 8; ++bit)
+                shifted = (shifted << 1) | (bitOrder == LSBFIRST ? (bytes[i] >> bit) & 0b1 : (bytes[i] >> (7 - bit)) & 0b1);
+        }
+    }
+
+    uint32_t micros() {
+        return hal.micros();
+    }
+
+    void delayMicroseconds(const uint16_t& us) {
+        hal.delayMicroseconds(us);
+    }
+
+    void delayMilliseconds(const uint16_t& ms) {
+        hal.delayMilliseconds(ms);
+    }
+
+    void beginCycleCounter() {
+        hal.beginCycleCounter();
+    }
+
+    uint16_t cycleCounter() {
+        return hal.cycleCounter();
+    }
+
+    void beginOperation(const uint8_t& operation) {
+        hal.beginOperation(operation);
+    }
+
+    void endOperation(const uint8_t& operation) {
+        hal.endOperation(operation);
+    }
+
+    Trace& getTrace() {
+        return trace;
+    }
+
+private:
+
+    void record(const uint8_t& signal, const uint8_t& value) {
+        trace.record(hal.cycleCounter(), signal, value);
+    }
+
+    /**
+     * OE is recorded only when it changes. The address changes on each latch, which is already seen as RCLK.
+     */
+    void latch() {
+        uint8_t level = (shifted >> outputEnableBit) & 0b1;
+
+        if (level == outputEnable)
+            return;
+
+        outputEnable = level;
+        record(PIN_TRACE_OE, level);
+    }
+
+    HAL& hal;
+    Trace& trace;
+    uint8_t serPin;
+    uint8_t srClkPin;
+    uint8_t rclkPin;
+    uint8_t wePin;
+    uint8_t outputEnableBit;
+
+    bool ser;
+    uint32_t shifted;
+    uint8_t outputEnable;
+    uint8_t dataBus;
+    bool dataBusDriven;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+/**
+ * Cooperative scheduler for the loop() of the programmer.
+ *
+ * A task is a function with a context. It runs when its deadline (micros()) passes and returns after how many microseconds
+ * it wants to run again, or SCHEDULER_STOP to leave the queue (a one shot job). Nothing is preempted, thus a task must never block.
+ * Long operations are split in steps, for example the write cycle is polled once per run (WriteCyclePoller in WriteCycle.h),
+ * so the serial port is drained between the polls.
+ *
+ * The deadlines are compared by their difference, so the wrap of micros() (every ~71 minutes) doesn't matter,
+ * as long as no deadline is more than ~35 minutes away.
+ *
+ * Example:
+ * uint32_t blink(void* context) { toggleLed(); return 500000; }
+ * scheduler.add(blink, 0, micros());
+ * loop() { scheduler.runDue(micros()); }
+ */
+
+#define SCHEDULER_STOP 0xFFFFFFFFUL
+
+typedef uint32_t (* SchedulerTask)(void* context);
+
+template<uint8_t Capacity>
+class Scheduler {
+
+public:
+
+    Scheduler() : count(0) {
+    }
+
+    /**
+     * @param dueUs The first run, usually micros() for as soon as possible.
+     * @return False if the queue is full.
+     */
+    bool add(SchedulerTask task, void* context, const uint32_t& dueUs) {
+
+        if (count >= Capacity)
+            return false;
+
+        Entry entry = {task, context, dueUs};
+        entries[count++] = entry;
+        return true;
+    }
+
+    /**
+     * Runs the task with the earliest deadline, if it has passed at @param nowUs.
+     * Tasks with the same deadline run in the order they were added, so a task that always wants to run again doesn't starve the others.
+     * @return False if nothing was due.
+     */
+    bool runDue(const uint32_t& nowUs) {
+
+        uint8_t next = count;
+
+        for (uint8_t i = 0; i < count; ++i) {
+            if ((int32_t) (nowUs - entries[i].dueUs) >= 0 && (next == count || (int32_t) (entries[next].dueUs - entries[i].dueUs) > 0))
+                next = i;
+        }
+
+        if (next == count)
+            return false;
+
+        Entry entry = entries[next];
+
+        for (uint8_t i = next; i + 1 < count; ++i)
+            entries[i] = entries[i + 1];
+
+        count--;
+        uint32_t delayUs = entry.task(entry.context);
+
+        if (delayUs != SCHEDULER_STOP)
+            add(entry.task, entry.context, nowUs + delayUs);
+
+        return true;
+    }
+
+    uint8_t getCount() const {
+        return count;
+    }
+
+private:
+
+    struct Entry {
+        SchedulerTask task;
+        void* context;
+        uint32_t dueUs;
+    };
+
+    Entry entries[Capacity];
+    uint8_t count;
+};
+
+#endif
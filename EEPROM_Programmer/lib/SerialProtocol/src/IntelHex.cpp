@@ -0,0 +1,97 @@
+#include "IntelHex.h"
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+static char* writeHexByte(char* out, const uint8_t& value) {
+    out[0] = HEX_DIGITS[value >> 4];
+    out[1] = HEX_DIGITS[value & 0b1111];
+    return out + 2;
+}
+
+static int readHexDigit(const char& digit) {
+
+    if (digit >= '0' && digit <= '9')
+        return digit - '0';
+
+    if (digit >= 'A' && digit <= 'F')
+        return digit - 'A' + 10;
+
+    if (digit >= 'a' && digit <= 'f')
+        return digit - 'a' + 10;
+
+    return -1;
+}
+
+static int readHexByte(const char* in) {
+
+    int high = readHexDigit(in[0]);
+    int low = high < 0 ? -1 : readHexDigit(in[1]);
+
+    return low < 0 ? -1 : (high << 4) | low;
+}
+
+uint8_t encodeIntelHexRecord(const uint8_t& type, const uint16_t& address, const uint8_t* data, const uint8_t& length, char* out) {
+
+    char* position = out;
+    uint8_t sum = length + (address >> 8) + (address & 0xFF) + type;
+
+    *position++ = ':';
+    position = writeHexByte(position, length);
+    position = writeHexByte(position, address >> 8);
+    position = writeHexByte(position, address & 0xFF);
+    position = writeHexByte(position, type);
+
+    for (uint8_t i = 0; i < length; ++i) {
+        position = writeHexByte(position, data[i]);
+        sum += data[i];
+    }
+
+    position = writeHexByte(position, -sum);
+    *position = '\0';
+
+    return position - out;
+}
+
+bool decodeIntelHexRecord(const char* line, IntelHexRecord& record) {
+
+    if (line[0] != ':')
+        return false;
+
+    uint8_t bytes[5 + INTEL_HEX_RECORD_DATA];
+    uint8_t count = 0;
+    const char* position = line + 1;
+
+    while (*position != '\0') {
+
+        if (count == sizeof(bytes))
+            return false;
+
+        int value = readHexByte(position);
+
+        if (value < 0)
+            return false;
+
+        bytes[count++] = value;
+        position += 2;
+    }
+
+    if (count < 5 || bytes[0] != count - 5)
+        return false;
+
+    uint8_t sum = 0;
+
+    for (uint8_t i = 0; i < count; ++i)
+        sum += bytes[i];
+
+    if (sum != 0)
+        return false;
+
+    record.length = bytes[0];
+    record.address = ((uint16_t) bytes[1] << 8) | bytes[2];
+    record.type = bytes[3];
+
+    for (uint8_t i = 0; i < record.length; ++i)
+        record.data[i] = bytes[4 + i];
+
+    return true;
+}
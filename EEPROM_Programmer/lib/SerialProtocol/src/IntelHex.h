@@ -0,0 +1,48 @@
+#ifndef INTEL_HEX_H
+#define INTEL_HEX_H
+
+#include <stdint.h>
+
+/**
+ * Intel HEX records. Each line is a single record:
+ * :LLAAAATT DD..DD CC
+ * LL - Number of data bytes, AAAA - Address, TT - Type, DD - Data, CC - Checksum
+ * The checksum is the two's complement of the sum of all the other bytes, so the sum of the whole record is 0.
+ *
+ * Example:
+ * :10000000417E12BCB6D2E6EE32FEF2000000000000BB (16 bytes on address 0x0000)
+ * :00000001FF (End of file)
+ *
+ * The files can be read by the most tools (objcopy -I ihex -O binary dump.hex dump.bin).
+ */
+
+#define INTEL_HEX_DATA 0x00
+#define INTEL_HEX_END_OF_FILE 0x01
+
+#define INTEL_HEX_RECORD_DATA 16
+
+/**
+ * Characters of the longest record without the line end and the terminating zero.
+ */
+#define INTEL_HEX_MAX_LINE (11 + 2 * INTEL_HEX_RECORD_DATA)
+
+struct IntelHexRecord {
+    uint8_t type;
+    uint16_t address;
+    uint8_t length;
+    uint8_t data[INTEL_HEX_RECORD_DATA];
+};
+
+/**
+ * Writes the record as text in @param out, which must have at least INTEL_HEX_MAX_LINE + 1 characters.
+ * @return Number of characters (without the terminating zero).
+ */
+uint8_t encodeIntelHexRecord(const uint8_t& type, const uint16_t& address, const uint8_t* data, const uint8_t& length, char* out);
+
+/**
+ * Parses a single line. Leading and trailing whitespaces are not allowed, the line end must be removed.
+ * @return False if the line is not a valid record or the checksum is wrong.
+ */
+bool decodeIntelHexRecord(const char* line, IntelHexRecord& record);
+
+#endif
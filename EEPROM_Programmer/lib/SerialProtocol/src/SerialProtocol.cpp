@@ -0,0 +1,168 @@
+#include "SerialProtocol.h"
+
+#define DECODER_SYNC 0
+#define DECODER_TYPE 1
+#define DECODER_SEQ 2
+#define DECODER_LENGTH 3
+#define DECODER_PAYLOAD 4
+#define DECODER_CRC_MSB 5
+#define DECODER_CRC_LSB 6
+
+/**
+ * CRC16 CCITT, processed bit by bit to avoid a 512 byte table in the Arduino's memory.
+ */
+uint16_t crc16Update(const uint16_t& crc, const uint8_t& byte) {
+
+    uint16_t result = crc ^ ((uint16_t) byte << 8);
+
+    for (uint8_t i = 0; i < 8; ++i)
+        result = (result & 0x8000) ? (result << 1) ^ 0x1021 : result << 1;
+
+    return result;
+}
+
+uint16_t crc16(const uint8_t* data, const uint16_t& length, const uint16_t& crc) {
+
+    uint16_t result = crc;
+
+    for (uint16_t i = 0; i < length; ++i)
+        result = crc16Update(result, data[i]);
+
+    return result;
+}
+
+/**
+ * Also bit by bit. A byte takes about 6us on the Nano, reading it from the EEPROM takes three times more.
+ */
+uint32_t crc32Update(const uint32_t& crc, const uint8_t& byte) {
+
+    uint32_t result = crc ^ byte;
+
+    for (uint8_t i = 0; i < 8; ++i)
+        result = (result & 1) ? (result >> 1) ^ 0xEDB88320UL : result >> 1;
+
+    return result;
+}
+
+uint32_t crc32(const uint8_t* data, const uint16_t& length, const uint32_t& crc) {
+
+    uint32_t result = crc;
+
+    for (uint16_t i = 0; i < length; ++i)
+        result = crc32Update(result, data[i]);
+
+    return result;
+}
+
+void writeUint16(uint8_t* out, const uint16_t& value) {
+    out[0] = value >> 8;
+    out[1] = value & 0xFF;
+}
+
+uint16_t readUint16(const uint8_t* in) {
+    return ((uint16_t) in[0] << 8) | in[1];
+}
+
+void writeUint32(uint8_t* out, const uint32_t& value) {
+    writeUint16(out, value >> 16);
+    writeUint16(out + 2, value & 0xFFFF);
+}
+
+uint32_t readUint32(const uint8_t* in) {
+    return ((uint32_t) readUint16(in) << 16) | readUint16(in + 2);
+}
+
+uint8_t encodeFrame(const uint8_t& type, const uint8_t& seq, const uint8_t* payload, const uint8_t& length, uint8_t* out) {
+
+    out[0] = FRAME_SYNC;
+    out[1] = type;
+    out[2] = seq;
+    out[3] = length;
+
+    for (uint8_t i = 0; i < length; ++i)
+        out[FRAME_HEADER_LENGTH + i] = payload[i];
+
+    uint16_t crc = crc16(out + 1, FRAME_HEADER_LENGTH - 1 + length);
+    writeUint16(out + FRAME_HEADER_LENGTH + length, crc);
+
+    return FRAME_HEADER_LENGTH + length + FRAME_CRC_LENGTH;
+}
+
+FrameDecoder::FrameDecoder() {
+    reset();
+}
+
+void FrameDecoder::reset() {
+    state = DECODER_SYNC;
+    index = 0;
+    crc = 0xFFFF;
+    receivedCrc = 0;
+}
+
+uint8_t FrameDecoder::feed(const uint8_t& byte) {
+
+    switch (state) {
+
+        case DECODER_SYNC:
+            if (byte == FRAME_SYNC) {
+                reset();
+                state = DECODER_TYPE;
+            }
+            return FRAME_INCOMPLETE;
+
+        case DECODER_TYPE:
+            frame.type = byte;
+            crc = crc16Update(crc, byte);
+            state = DECODER_SEQ;
+            return FRAME_INCOMPLETE;
+
+        case DECODER_SEQ:
+            frame.seq = byte;
+            crc = crc16Update(crc, byte);
+            state = DECODER_LENGTH;
+            return FRAME_INCOMPLETE;
+
+        case DECODER_LENGTH:
+            if (byte > FRAME_MAX_PAYLOAD) {
+                reset();
+                return FRAME_LENGTH_ERROR;
+            }
+
+            frame.length = byte;
+            crc = crc16Update(crc, byte);
+            state = byte > 0 ? DECODER_PAYLOAD : DECODER_CRC_MSB;
+            return FRAME_INCOMPLETE;
+
+        case DECODER_PAYLOAD:
+            frame.payload[index++] = byte;
+            crc = crc16Update(crc, byte);
+
+            if (index == frame.length)
+                state = DECODER_CRC_MSB;
+
+            return FRAME_INCOMPLETE;
+
+        case DECODER_CRC_MSB:
+            receivedCrc = byte << 8;
+            state = DECODER_CRC_LSB;
+            return FRAME_INCOMPLETE;
+
+        case DECODER_CRC_LSB: {
+            receivedCrc |= byte;
+            bool valid = receivedCrc == crc;
+            reset();
+            return valid ? FRAME_COMPLETE : FRAME_CRC_ERROR;
+        }
+    }
+
+    reset();
+    return FRAME_INCOMPLETE;
+}
+
+bool FrameDecoder::isReceiving() const {
+    return state != DECODER_SYNC;
+}
+
+const Frame& FrameDecoder::getFrame() const {
+    return frame;
+}
@@ -0,0 +1,195 @@
+#ifndef SERIAL_PROTOCOL_H
+#define SERIAL_PROTOCOL_H
+
+#include <stdint.h>
+
+/**
+ * Binary protocol between the host and the programmer over the serial link.
+ *
+ * Frame:
+ * | SYNC (0xA5) | TYPE | SEQ | LENGTH | PAYLOAD (LENGTH bytes) | CRC16 (MSB, LSB) |
+ *
+ * - SEQ is incremented by the host for each frame. The answer to a frame (ACK/NAK/...) carries the same SEQ.
+ * - CRC16 is CCITT (polynomial 0x1021, initial value 0xFFFF) over TYPE, SEQ, LENGTH and PAYLOAD.
+ * - All multi byte values are big endian.
+ * - Bytes before the SYNC are ignored. That way the text logs of the programmer doesn't break the protocol.
+ *   (The text is ASCII and never contains 0xA5)
+ *
+ * Upload:
+ * Host                                 Programmer
+ * BEGIN (address, length)      ->
+ *                              <-      ACK
+ * DATA (address, up to 32 bytes) ->
+ *                              <-      ACK (As soon as the frame is buffered, not after it is written)
+ * DATA ...                     ->      (Received while the previous frame is being written)
+ * END                          ->
+ *                              <-      RESULT (written, skipped, verified, failed), after everything is written
+ *
+ * DATA_PACKED (address, packed records) can be sent instead of DATA. The records (PackedImage.h) expand from the address,
+ * skipped addresses are not written. Each frame holds complete records, so it is decoded on its own while it is written.
+ *
+ * A frame with a wrong CRC or unexpected SEQ is answered with NAK and the host sends it again.
+ * If the ACK was lost and the host sends the same frame again, it is only acknowledged again.
+ *
+ * Dump:
+ * Host                                 Programmer
+ * DUMP (address, length, format) ->
+ *                              <-      DUMP_DATA (address, up to 32 bytes) ... (DUMP_FORMAT_BINARY)
+ *                              <-      Intel HEX records as text ... (DUMP_FORMAT_INTEL_HEX)
+ *                              <-      DUMP_END (length, CRC16 of the whole range)
+ * Each DUMP_DATA frame is protected by its own CRC and each Intel HEX record by its checksum.
+ * There is no flow control. If something is lost the host asks again for the missing part.
+ *
+ * Pin trace (PinTrace.h):
+ * Host                                 Programmer
+ * TRACE (clear)                ->
+ *                              <-      TRACE_DATA (index of the first event, up to 8 events of 4 bytes) ...
+ *                              <-      TRACE_END (count, overwritten)
+ * The events are sent from the oldest one. If clear is 1 the trace is emptied after it is sent.
+ * A programmer without a trace answers only with TRACE_END (0, 0).
+ *
+ * Verify:
+ * Host                                 Programmer
+ * VERIFY (address, length, image) ->
+ *                              <-      VERIFY_MAP (address, bitmap of up to 256 addresses) ... (only blocks with a mismatch)
+ *                              <-      VERIFY_END (length, mismatches, CRC32 of the whole range)
+ * The range is read in a tight loop and compared with one of the programmer's own images (for example the microcode in its flash).
+ * Bit 7 of the first bitmap byte is the first address of the block. With VERIFY_IMAGE_NONE nothing is compared, only the CRC32
+ * is computed, so the host can check it against its own file. An unknown image or a range outside of it is answered with NAK_IMAGE.
+ *
+ * Performance counters (PerfCounters.h):
+ * Host                                 Programmer
+ * STATS (clear)                ->
+ *                              <-      STATS_DATA (operation, count, min, max, total) ... (one per operation)
+ *                              <-      STATS_END (operations, clock in Hz)
+ * The min, max and total are CPU cycles of the programmer. If clear is 1 the counters are reset after they are sent.
+ * A programmer without counters answers only with STATS_END (0, clock).
+ */
+
+#define FRAME_SYNC 0xA5
+
+#define FRAME_BEGIN 0x01
+#define FRAME_DATA 0x02
+#define FRAME_END 0x03
+#define FRAME_DUMP 0x04
+#define FRAME_TRACE 0x05
+#define FRAME_VERIFY 0x06
+#define FRAME_DATA_PACKED 0x07
+#define FRAME_STATS 0x08
+#define FRAME_ACK 0x10
+#define FRAME_NAK 0x11
+#define FRAME_RESULT 0x12
+#define FRAME_DUMP_DATA 0x13
+#define FRAME_DUMP_END 0x14
+#define FRAME_TRACE_DATA 0x15
+#define FRAME_TRACE_END 0x16
+#define FRAME_VERIFY_MAP 0x17
+#define FRAME_VERIFY_END 0x18
+#define FRAME_STATS_DATA 0x19
+#define FRAME_STATS_END 0x1A
+
+#define DUMP_FORMAT_BINARY 0
+#define DUMP_FORMAT_INTEL_HEX 1
+
+#define FRAME_HEADER_LENGTH 4
+#define FRAME_CRC_LENGTH 2
+#define FRAME_MAX_DATA 32
+#define FRAME_MAX_PAYLOAD (2 + FRAME_MAX_DATA)
+#define FRAME_MAX_LENGTH (FRAME_HEADER_LENGTH + FRAME_MAX_PAYLOAD + FRAME_CRC_LENGTH)
+#define FRAME_TRACE_EVENT_LENGTH 4
+#define FRAME_MAX_TRACE_EVENTS (FRAME_MAX_DATA / FRAME_TRACE_EVENT_LENGTH)
+#define FRAME_VERIFY_MAP_ADDRESSES (FRAME_MAX_DATA * 8)
+#define FRAME_PERF_COUNTER_LENGTH 20
+
+#define VERIFY_IMAGE_NONE 0
+
+/**
+ * A partially received frame is dropped if no byte comes for that time.
+ */
+#define FRAME_TIMEOUT_MS 50
+
+#define FRAME_INCOMPLETE 0
+#define FRAME_COMPLETE 1
+#define FRAME_CRC_ERROR 2
+#define FRAME_LENGTH_ERROR 3
+
+#define NAK_CRC 0x01
+#define NAK_SEQUENCE 0x02
+#define NAK_LENGTH 0x03
+#define NAK_NO_SESSION 0x04
+#define NAK_IMAGE 0x05
+
+/**
+ * Result of the programming of a single byte.
+ */
+#define PROGRAM_BYTE_WRITTEN 0
+#define PROGRAM_BYTE_SKIPPED 1
+#define PROGRAM_BYTE_FAILED 2
+
+struct Frame {
+    uint8_t type;
+    uint8_t seq;
+    uint8_t length;
+    uint8_t payload[FRAME_MAX_PAYLOAD];
+};
+
+uint16_t crc16Update(const uint16_t& crc, const uint8_t& byte);
+
+uint16_t crc16(const uint8_t* data, const uint16_t& length, const uint16_t& crc = 0xFFFF);
+
+/**
+ * CRC32 (IEEE 802.3, the same as zip and zlib). The functions work with the register, which starts at 0xFFFFFFFF,
+ * so a range can be processed in parts. The final CRC is its complement (~crc).
+ */
+uint32_t crc32Update(const uint32_t& crc, const uint8_t& byte);
+
+uint32_t crc32(const uint8_t* data, const uint16_t& length, const uint32_t& crc = 0xFFFFFFFF);
+
+/**
+ * Writes the whole frame (SYNC up to the CRC) in @param out, which must have at least FRAME_MAX_LENGTH bytes.
+ * @return The length of the frame.
+ */
+uint8_t encodeFrame(const uint8_t& type, const uint8_t& seq, const uint8_t* payload, const uint8_t& length, uint8_t* out);
+
+void writeUint16(uint8_t* out, const uint16_t& value);
+
+uint16_t readUint16(const uint8_t* in);
+
+void writeUint32(uint8_t* out, const uint32_t& value);
+
+uint32_t readUint32(const uint8_t* in);
+
+/**
+ * Receives a frame byte by byte, so it can be fed directly from the serial port.
+ */
+class FrameDecoder {
+
+public:
+
+    FrameDecoder();
+
+    void reset();
+
+    /**
+     * @return FRAME_INCOMPLETE until the last byte of a frame. Then FRAME_COMPLETE and the frame is in getFrame().
+     * FRAME_CRC_ERROR or FRAME_LENGTH_ERROR if the frame is broken. After the result the decoder waits for the next SYNC.
+     */
+    uint8_t feed(const uint8_t& byte);
+
+    /**
+     * True if the decoder is in the middle of a frame.
+     */
+    bool isReceiving() const;
+
+    const Frame& getFrame() const;
+
+private:
+
+    uint8_t state;
+    uint8_t index;
+    uint16_t crc;
+    uint16_t receivedCrc;
+    Frame frame;
+};
+
+#endif
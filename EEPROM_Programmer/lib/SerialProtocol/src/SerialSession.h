@@ -0,0 +1,562 @@
+#ifndef SERIAL_SESSION_H
+#define SERIAL_SESSION_H
+
+#include <PackedImage.h>
+
+#include "SerialProtocol.h"
+#include "IntelHex.h"
+
+/**
+ * The programmer's side of the serial protocol. See SerialProtocol.h
+ *
+ * Double buffering:
+ * There are two frame buffers. A DATA frame is acknowledged as soon as it is copied in a free buffer.
+ * That way the host sends the next frame while the bytes of the current one are in their EEPROM write cycle.
+ * A DATA_PACKED frame stays packed in its buffer and is expanded up to SESSION_CHUNK_LENGTH bytes at a time (PackedImageReader),
+ * so a frame of runs can cover hundreds of addresses without a bigger buffer. A buffer is free again as soon as it is expanded.
+ * If the next buffer continues at the next address it is expanded in the same chunk, so a page split between two frames
+ * still takes a single write cycle.
+ * When both buffers are full the serial port is not read. The host doesn't send more than one frame without ACK,
+ * thus the waiting frame (up to FRAME_MAX_LENGTH bytes) always fits in the serial's receive buffer (64 bytes on the Arduino).
+ *
+ * poll() must be called continuously (from loop()). It never waits for the EEPROM. Each call reads the waiting bytes and then
+ * either starts the write cycle of the next bytes or polls the running one once. That way the serial port is drained and the frames are
+ * decoded (and their CRC checked) during the write cycle. Once per write cycle the address of the next bytes is prepared in the
+ * shift registers, so after the cycle only RCLK is pulsed. receive() and program() are the two halves of poll(),
+ * for a loop that runs them as separate tasks (see Scheduler.h).
+ *
+ * The @param Device must provide:
+ * - int available() - Number of bytes waiting in the serial port.
+ * - int read() - Reads a byte from the serial port.
+ * - void write(const uint8_t* bytes, uint8_t length) - Sends the bytes over the serial port.
+ * - uint32_t millis() - Monotonic time in milliseconds.
+ * - uint8_t startBytes(uint16_t address, const uint8_t* data, uint8_t length) - Starts programming at least the first byte
+ *   with a single write cycle (a whole page on chips with page write) and returns the number of the bytes. The data stays unchanged until
+ *   pollBytes() returns true.
+ * - bool pollBytes(uint8_t* results) - Checks the write cycle without waiting. When it is over stores PROGRAM_BYTE_WRITTEN, _SKIPPED
+ *   or _FAILED of each programmed byte in the results and returns true.
+ * - void prepareBytes(uint16_t address) - Called during the write cycle with the address of the next startBytes(). Can do nothing.
+ * - void readBytes(uint16_t address, uint8_t* buffer, uint8_t length) - Reads consecutive addresses from the EEPROM.
+ * - uint16_t traceLength() - Number of the events in the pin trace (PinTrace.h). 0 if the pins are not traced.
+ * - uint32_t traceOverwritten() - Number of the events, which were lost because the trace was full.
+ * - void readTraceEvent(uint16_t index, uint8_t* out) - Encodes the event (encodePinTraceEvent()), 0 is the oldest one.
+ * - void clearTrace()
+ * - uint16_t verifyImageSize(uint8_t image) - Size of the programmer's image with that id (see VERIFY in SerialProtocol.h). 0 if there is none.
+ * - uint16_t verifyBytes(uint8_t image, uint16_t address, uint16_t length, uint8_t* bitmap, uint32_t& crc) - Reads up to
+ *   FRAME_VERIFY_MAP_ADDRESSES addresses, updates the CRC32 register with them and sets the bits of the mismatching ones
+ *   in the zeroed bitmap. Returns the number of mismatches (always 0 with VERIFY_IMAGE_NONE).
+ * - uint8_t perfOperations() - Number of the performance counters (PerfCounters.h). 0 if they are disabled.
+ * - void readPerfCounter(uint8_t operation, uint8_t* out) - Encodes the counter (encodePerfCounter()).
+ * - uint32_t perfClockHz() - The unit of the counters.
+ * - void clearPerfCounters()
+ */
+
+/**
+ * The expanded bytes are programmed from a chunk of that size. It is a whole page of the biggest chips (EEPROM_MAX_PAGE_SIZE).
+ */
+#define SESSION_CHUNK_LENGTH 64
+
+/**
+ * Counters of the current upload, the same as ProgrammingStats (EEPROMProgrammer.h). Each byte is in exactly one of written, skipped and failed.
+ * @param naks Frames, which were answered with NAK.
+ */
+struct SessionStats {
+    uint16_t written;
+    uint16_t skipped;
+    uint16_t failed;
+    uint16_t naks;
+};
+
+template<typename Device>
+class SerialSession {
+
+public:
+
+    explicit SerialSession(Device& device) : device(device) {
+        active = false;
+        ending = false;
+        finished = false;
+        expectedSeq = 0;
+        endSeq = 0;
+        head = 0;
+        count = 0;
+        programming = 0;
+        prepared = false;
+        expandedAddress = 0;
+        expandedLength = 0;
+        expandedIndex = 0;
+        lastByteMs = 0;
+        stats = {0, 0, 0, 0};
+    }
+
+    void poll() {
+        receive();
+        program();
+    }
+
+    /**
+     * Reads the bytes waiting in the serial port, but only while there is a free buffer for a DATA frame.
+     */
+    void receive() {
+
+        if (decoder.isReceiving() && device.millis() - lastByteMs > FRAME_TIMEOUT_MS)
+            decoder.reset();
+
+        while (count < 2 && device.available() > 0) {
+            lastByteMs = device.millis();
+            uint8_t status = decoder.feed(device.read());
+
+            if (status == FRAME_COMPLETE)
+                handleFrame(decoder.getFrame());
+            else if (status == FRAME_CRC_ERROR)
+                sendNak(expectedSeq, NAK_CRC);
+            else if (status == FRAME_LENGTH_ERROR)
+                sendNak(expectedSeq, NAK_LENGTH);
+        }
+    }
+
+    /**
+     * Starts or polls the write cycle of the buffered bytes. Sends the RESULT when the upload is over.
+     */
+    void program() {
+
+        if (isProgramming()) {
+            programNextBytes();
+            return;
+        }
+
+        if (ending) {
+            ending = false;
+            active = false;
+            finished = true;
+            sendResult(endSeq);
+        }
+    }
+
+    /**
+     * True while there are buffered bytes, so program() has work. The caller can call it more often than it checks the serial port.
+     */
+    bool isProgramming() const {
+        return count > 0 || programming > 0 || expandedIndex < expandedLength;
+    }
+
+    const SessionStats& getStats() const {
+        return stats;
+    }
+
+    /**
+     * True after the RESULT of the last upload was sent.
+     */
+    bool isFinished() const {
+        return finished;
+    }
+
+private:
+
+    struct FrameBuffer {
+        uint16_t address;
+        uint8_t data[FRAME_MAX_DATA];
+        PackedImageReader<MemoryBytes> reader;
+    };
+
+    void handleFrame(const Frame& frame) {
+
+        switch (frame.type) {
+
+            case FRAME_BEGIN:
+                finishProgramming();
+                active = true;
+                ending = false;
+                finished = false;
+                count = 0;
+                expandedLength = 0;
+                expandedIndex = 0;
+                expectedSeq = frame.seq + 1;
+                stats = {0, 0, 0, 0};
+                sendFrame(FRAME_ACK, frame.seq, 0, 0);
+                return;
+
+            case FRAME_DATA:
+            case FRAME_DATA_PACKED:
+                return handleData(frame);
+
+            case FRAME_DUMP:
+                return handleDump(frame);
+
+            case FRAME_TRACE:
+                return handleTrace(frame);
+
+            case FRAME_VERIFY:
+                return handleVerify(frame);
+
+            case FRAME_STATS:
+                return handleStats(frame);
+
+            case FRAME_END:
+                if (finished && frame.seq == endSeq) {
+                    sendResult(endSeq);
+                    return;
+                }
+
+                if (ending && frame.seq == endSeq)
+                    return;
+
+                if (!active || frame.seq != expectedSeq) {
+                    sendNak(frame.seq, active ? NAK_SEQUENCE : NAK_NO_SESSION);
+                    return;
+                }
+
+                ending = true;
+                endSeq = frame.seq;
+                expectedSeq++;
+                return;
+        }
+    }
+
+    void handleData(const Frame& frame) {
+
+        if (!active) {
+            sendNak(frame.seq, NAK_NO_SESSION);
+            return;
+        }
+
+        if (frame.seq == (uint8_t) (expectedSeq - 1)) {
+            sendFrame(FRAME_ACK, frame.seq, 0, 0);
+            return;
+        }
+
+        if (frame.seq != expectedSeq) {
+            sendNak(frame.seq, NAK_SEQUENCE);
+            return;
+        }
+
+        if (frame.length < 2) {
+            sendNak(frame.seq, NAK_LENGTH);
+            return;
+        }
+
+        FrameBuffer& buffer = buffers[(head + count) % 2];
+        MemoryBytes bytes = {buffer.data};
+        buffer.address = readUint16(frame.payload);
+
+        for (uint8_t i = 0; i < frame.length - 2; ++i)
+            buffer.data[i] = frame.payload[2 + i];
+
+        buffer.reader.begin(bytes, frame.length - 2, buffer.address, frame.type == FRAME_DATA_PACKED);
+
+        count++;
+        expectedSeq++;
+        sendFrame(FRAME_ACK, frame.seq, 0, 0);
+    }
+
+    /**
+     * DUMP payload: address (uint16_t), length (uint16_t), format (uint8_t)
+     * The range is read in chunks, each chunk is sent right after it is read.
+     * It is not allowed during an upload, because the bytes in the buffers are not written yet.
+     */
+    void handleDump(const Frame& frame) {
+
+        if (frame.length < 5) {
+            sendNak(frame.seq, NAK_LENGTH);
+            return;
+        }
+
+        if (active) {
+            sendNak(frame.seq, NAK_SEQUENCE);
+            return;
+        }
+
+        uint16_t address = readUint16(frame.payload);
+        uint16_t length = readUint16(frame.payload + 2);
+        uint8_t format = frame.payload[4];
+        uint8_t chunkLength = format == DUMP_FORMAT_INTEL_HEX ? INTEL_HEX_RECORD_DATA : FRAME_MAX_DATA;
+
+        uint8_t chunk[2 + FRAME_MAX_DATA];
+        uint16_t crc = 0xFFFF;
+
+        for (uint32_t offset = 0; offset < length; offset += chunkLength) {
+            uint8_t count = length - offset < chunkLength ? length - offset : chunkLength;
+            uint16_t chunkAddress = address + offset;
+
+            device.readBytes(chunkAddress, chunk + 2, count);
+            crc = crc16(chunk + 2, count, crc);
+
+            if (format == DUMP_FORMAT_INTEL_HEX) {
+                sendIntelHexRecord(INTEL_HEX_DATA, chunkAddress, chunk + 2, count);
+            } else {
+                writeUint16(chunk, chunkAddress);
+                sendFrame(FRAME_DUMP_DATA, frame.seq, chunk, count + 2);
+            }
+        }
+
+        if (format == DUMP_FORMAT_INTEL_HEX)
+            sendIntelHexRecord(INTEL_HEX_END_OF_FILE, 0, 0, 0);
+
+        uint8_t payload[4];
+        writeUint16(payload, length);
+        writeUint16(payload + 2, crc);
+        sendFrame(FRAME_DUMP_END, frame.seq, payload, sizeof(payload));
+    }
+
+    /**
+     * TRACE payload: clear (uint8_t, optional)
+     * Unlike the dump it doesn't touch the EEPROM, so it is allowed during an upload.
+     */
+    void handleTrace(const Frame& frame) {
+
+        uint16_t length = device.traceLength();
+        uint8_t chunk[2 + FRAME_MAX_DATA];
+
+        for (uint16_t index = 0; index < length; index += FRAME_MAX_TRACE_EVENTS) {
+            uint8_t count = length - index < FRAME_MAX_TRACE_EVENTS ? length - index : FRAME_MAX_TRACE_EVENTS;
+            writeUint16(chunk, index);
+
+            for (uint8_t i = 0; i < count; ++i)
+                device.readTraceEvent(index + i, chunk + 2 + FRAME_TRACE_EVENT_LENGTH * i);
+
+            sendFrame(FRAME_TRACE_DATA, frame.seq, chunk, 2 + FRAME_TRACE_EVENT_LENGTH * count);
+        }
+
+        uint32_t overwritten = device.traceOverwritten();
+        uint8_t payload[4];
+        writeUint16(payload, length);
+        writeUint16(payload + 2, overwritten > 0xFFFF ? 0xFFFF : overwritten);
+        sendFrame(FRAME_TRACE_END, frame.seq, payload, sizeof(payload));
+
+        if (frame.length >= 1 && frame.payload[0])
+            device.clearTrace();
+    }
+
+    /**
+     * STATS payload: clear (uint8_t, optional)
+     * Like the trace it is allowed during an upload. The counters of the frames themselves are in SERIAL of the next request.
+     */
+    void handleStats(const Frame& frame) {
+
+        uint8_t operations = device.perfOperations();
+        uint8_t chunk[1 + FRAME_PERF_COUNTER_LENGTH];
+
+        for (uint8_t operation = 0; operation < operations; ++operation) {
+            chunk[0] = operation;
+            device.readPerfCounter(operation, chunk + 1);
+            sendFrame(FRAME_STATS_DATA, frame.seq, chunk, sizeof(chunk));
+        }
+
+        uint8_t payload[5];
+        payload[0] = operations;
+        writeUint32(payload + 1, device.perfClockHz());
+        sendFrame(FRAME_STATS_END, frame.seq, payload, sizeof(payload));
+
+        if (frame.length >= 1 && frame.payload[0])
+            device.clearPerfCounters();
+    }
+
+    /**
+     * VERIFY payload: address (uint16_t), length (uint16_t), image (uint8_t)
+     * Like the dump it is not allowed during an upload. Only the blocks with a mismatch are sent, so a good chip costs a single frame.
+     */
+    void handleVerify(const Frame& frame) {
+
+        if (frame.length < 5) {
+            sendNak(frame.seq, NAK_LENGTH);
+            return;
+        }
+
+        if (active) {
+            sendNak(frame.seq, NAK_SEQUENCE);
+            return;
+        }
+
+        uint16_t address = readUint16(frame.payload);
+        uint16_t length = readUint16(frame.payload + 2);
+        uint8_t image = frame.payload[4];
+
+        if (image != VERIFY_IMAGE_NONE && (uint32_t) address + length > device.verifyImageSize(image)) {
+            sendNak(frame.seq, NAK_IMAGE);
+            return;
+        }
+
+        uint8_t map[2 + FRAME_MAX_DATA];
+        uint32_t crc = 0xFFFFFFFF;
+        uint16_t mismatches = 0;
+
+        for (uint32_t offset = 0; offset < length; offset += FRAME_VERIFY_MAP_ADDRESSES) {
+            uint16_t count = length - offset < FRAME_VERIFY_MAP_ADDRESSES ? length - offset : FRAME_VERIFY_MAP_ADDRESSES;
+            uint16_t blockAddress = address + offset;
+
+            for (uint8_t i = 0; i < FRAME_MAX_DATA; ++i)
+                map[2 + i] = 0;
+
+            uint16_t blockMismatches = device.verifyBytes(image, blockAddress, count, map + 2, crc);
+
+            if (blockMismatches > 0) {
+                writeUint16(map, blockAddress);
+                sendFrame(FRAME_VERIFY_MAP, frame.seq, map, 2 + (count + 7) / 8);
+            }
+
+            mismatches += blockMismatches;
+        }
+
+        uint8_t payload[8];
+        writeUint16(payload, length);
+        writeUint16(payload + 2, mismatches);
+        writeUint32(payload + 4, ~crc);
+        sendFrame(FRAME_VERIFY_END, frame.seq, payload, sizeof(payload));
+    }
+
+    void sendIntelHexRecord(const uint8_t& type, const uint16_t& address, const uint8_t* data, const uint8_t& length) {
+        char line[INTEL_HEX_MAX_LINE + 3];
+        uint8_t lineLength = encodeIntelHexRecord(type, address, data, length, line);
+        line[lineLength++] = '\r';
+        line[lineLength++] = '\n';
+        device.write((const uint8_t*) line, lineLength);
+    }
+
+    /**
+     * Starts the next expanded bytes or polls their write cycle.
+     * While the cycle runs the first address after the bytes (in the same chunk or in the next buffer) is prepared once.
+     */
+    void programNextBytes() {
+
+        if (programming == 0 && expandedIndex >= expandedLength)
+            expandNextBytes();
+
+        if (programming == 0 && expandedIndex < expandedLength) {
+            programming = device.startBytes(expandedAddress + expandedIndex, expanded + expandedIndex, expandedLength - expandedIndex);
+            prepared = false;
+        }
+
+        if (programming == 0)
+            return;
+
+        uint8_t results[SESSION_CHUNK_LENGTH];
+
+        if (!device.pollBytes(results)) {
+            prepareNextBytes();
+            return;
+        }
+
+        countResults(results, programming);
+        expandedIndex += programming;
+        programming = 0;
+    }
+
+    /**
+     * Fills the chunk from the buffers, starting with the head one. Stops at a gap in the addresses (another frame's address or a SKIP).
+     * The chunk ends at a multiple of SESSION_CHUNK_LENGTH, so it is never split between two pages of any chip.
+     */
+    void expandNextBytes() {
+
+        expandedLength = 0;
+        expandedIndex = 0;
+
+        while (count > 0 && (expandedLength == 0 || expandedLength < SESSION_CHUNK_LENGTH - expandedAddress % SESSION_CHUNK_LENGTH)) {
+            PackedImageReader<MemoryBytes>& reader = buffers[head].reader;
+
+            if (expandedLength == 0)
+                expandedLength = reader.read(expandedAddress, expanded, 1);
+
+            if (expandedLength > 0 && reader.getAddress() == (uint16_t) (expandedAddress + expandedLength)) {
+                uint16_t address;
+                uint8_t space = SESSION_CHUNK_LENGTH - expandedAddress % SESSION_CHUNK_LENGTH - expandedLength;
+                expandedLength += reader.read(address, expanded + expandedLength, space, true);
+            }
+
+            if (!reader.isDone())
+                return;
+
+            head = (head + 1) % 2;
+            count--;
+        }
+    }
+
+    void prepareNextBytes() {
+
+        if (prepared)
+            return;
+
+        prepared = true;
+
+        if (expandedIndex + programming < expandedLength)
+            device.prepareBytes(expandedAddress + expandedIndex + programming);
+        else if (count > 0)
+            device.prepareBytes(buffers[head].reader.getAddress());
+    }
+
+    /**
+     * Waits for the running write cycle, so its buffer can be reused (a new BEGIN during an upload).
+     */
+    void finishProgramming() {
+
+        if (programming == 0)
+            return;
+
+        uint8_t results[SESSION_CHUNK_LENGTH];
+
+        while (!device.pollBytes(results)) {
+        }
+
+        countResults(results, programming);
+        programming = 0;
+    }
+
+    void countResults(const uint8_t* results, const uint8_t& length) {
+
+        for (uint8_t i = 0; i < length; ++i) {
+            if (results[i] == PROGRAM_BYTE_WRITTEN)
+                stats.written++;
+            else if (results[i] == PROGRAM_BYTE_SKIPPED)
+                stats.skipped++;
+            else
+                stats.failed++;
+        }
+    }
+
+    /**
+     * RESULT payload: written, skipped, verified, failed (uint16_t each)
+     * The failed bytes are not in written, so verified (the bytes, which hold the right data) is written + skipped.
+     */
+    void sendResult(const uint8_t& seq) {
+        uint8_t payload[8];
+        writeUint16(payload, stats.written);
+        writeUint16(payload + 2, stats.skipped);
+        writeUint16(payload + 4, stats.written + stats.skipped);
+        writeUint16(payload + 6, stats.failed);
+        sendFrame(FRAME_RESULT, seq, payload, sizeof(payload));
+    }
+
+    void sendNak(const uint8_t& seq, const uint8_t& reason) {
+        stats.naks++;
+        sendFrame(FRAME_NAK, seq, &reason, 1);
+    }
+
+    void sendFrame(const uint8_t& type, const uint8_t& seq, const uint8_t* payload, const uint8_t& length) {
+        uint8_t out[FRAME_MAX_LENGTH];
+        uint8_t outLength = encodeFrame(type, seq, payload, length, out);
+        device.write(out, outLength);
+    }
+
+    Device& device;
+    FrameDecoder decoder;
+
+    FrameBuffer buffers[2];
+    uint8_t head;
+    uint8_t count;
+    uint8_t programming;
+    bool prepared;
+
+    uint8_t expanded[SESSION_CHUNK_LENGTH];
+    uint16_t expandedAddress;
+    uint8_t expandedLength;
+    uint8_t expandedIndex;
+
+    bool active;
+    bool ending;
+    bool finished;
+    uint8_t expectedSeq;
+    uint8_t endSeq;
+    uint32_t lastByteMs;
+    SessionStats stats;
+};
+
+#endif
@@ -0,0 +1,253 @@
+#ifndef SHIFT_REGISTER_H
+#define SHIFT_REGISTER_H
+
+#include <HAL.h>
+#include <PerfCounters.h>
+
+/**
+ * Driver for a chain of 74HC595 shift registers.
+ *
+ * The bits are stored in two steps:
+ * 1. shift() - Each bit is placed on SER and stored in the Shift Register on the rising edge of SRCLK. The outputs doesn't change.
+ * 2. latch() - Pulse on RCLK moves the Shift Register into the Storage Register, which drives the outputs Q0-Q7.
+ * write() does both of them.
+ *
+ * The driver remembers which word (the uint32_t functions with MSBFIRST) is in the Shift Register and which one is on the outputs.
+ * write() of the word, which is already on the outputs, does nothing. If it is only in the Shift Register (shifted ahead with shift()),
+ * just RCLK is pulsed. Only a new word is shifted.
+ * ! Each bit of a new word must pass the whole chain: the control bits (OE) are in the last register and a shorter shift
+ * would move the address bits into them. Therefore a changed word is always shifted completely.
+ *
+ * Two modes with the same interface:
+ * - Bit Bang - Any three pins. The pins are prepared once (HAL::Pin), on the Nano that is their port register instead of digitalWrite().
+ * - Hardware SPI - The ATmega328's SPI peripheral shifts a whole byte on its own (up to 8 MHz).
+ *   SER must be connected to MOSI (pin 11) and SRCLK to SCK (pin 13). Only the latch pin is free to choose.
+ *   ! The SPI peripheral also takes MISO (pin 12) as input, so pins 11 - 13 can't be used for anything else.
+ *   ! SS (pin 10) must stay an OUTPUT. As an INPUT a LOW level switches the peripheral to slave mode and the shifting stops.
+ *   spiBegin() (SPI.begin()) makes it an OUTPUT, so nothing may switch it to INPUT later, for example the data bus during a read.
+ *
+ * Chaining: The QH' output of each register is connected to the SER of the next one.
+ * The first shifted byte ends in the last register of the chain.
+ * The uint32_t functions (used by EEPROMProgrammer) take chains of up to SHIFT_REGISTER_MAX_CHAIN_LENGTH registers and do nothing
+ * on a longer one. A longer chain must be driven with the byte array functions.
+ *
+ * All pins are driven through the @param HAL (see HAL.h).
+ */
+
+#define SHIFT_REGISTER_BIT_BANG 0
+#define SHIFT_REGISTER_HARDWARE_SPI 1
+
+#define SHIFT_REGISTER_MAX_CHAIN_LENGTH 4
+#define SHIFT_REGISTER_DEFAULT_SPI_CLOCK 8000000
+
+template<typename HAL>
+class ShiftRegister {
+
+public:
+
+    /**
+     * Bit Bang mode.
+     * @param chainLength How many shift registers are chained.
+     */
+    ShiftRegister(HAL& hal, const uint8_t& serPin, const uint8_t& srClkPin, const uint8_t& rclkPin, const uint8_t& chainLength)
+            : hal(hal),
+              mode(SHIFT_REGISTER_BIT_BANG),
+              chainLength(chainLength),
+              serPin(serPin),
+              srClkPin(srClkPin),
+              rclkPin(rclkPin),
+              spiClock(0),
+              serLevel(false),
+              shiftedKnown(false),
+              latchedKnown(false),
+              shifted(0),
+              latched(0) {
+    }
+
+    /**
+     * Hardware SPI mode.
+     * @param rclkPin The latch pin.
+     * @param spiClock Frequency of SRCLK. The ATmega328 can't go higher than half of its clock (8 MHz).
+     */
+    ShiftRegister(HAL& hal, const uint8_t& rclkPin, const uint8_t& chainLength, const uint32_t& spiClock = SHIFT_REGISTER_DEFAULT_SPI_CLOCK)
+            : hal(hal),
+              mode(SHIFT_REGISTER_HARDWARE_SPI),
+              chainLength(chainLength),
+              serPin(0),
+              srClkPin(0),
+              rclkPin(rclkPin),
+              spiClock(spiClock),
+              serLevel(false),
+              shiftedKnown(false),
+              latchedKnown(false),
+              shifted(0),
+              latched(0) {
+    }
+
+    /**
+     * Configures the pins (and the SPI peripheral). Must be called in setup().
+     */
+    void begin() {
+
+        hal.pinMode(rclkPin, OUTPUT);
+        rclk = hal.pin(rclkPin);
+        hal.write(rclk, LOW);
+
+        if (mode == SHIFT_REGISTER_HARDWARE_SPI) {
+            hal.spiBegin();
+            return;
+        }
+
+        hal.pinMode(serPin, OUTPUT);
+        hal.pinMode(srClkPin, OUTPUT);
+        ser = hal.pin(serPin);
+        srClk = hal.pin(srClkPin);
+        hal.write(srClk, LOW);
+        hal.write(ser, LOW);
+        serLevel = false;
+    }
+
+    /**
+     * Shifts the given bytes without latching them.
+     * @param bytes Must have chainLength elements. The first one goes to the last register in the chain.
+     * @param bitOrder MSBFIRST or LSBFIRST for the bits in each byte.
+     */
+    void shift(const uint8_t* bytes, const uint8_t& bitOrder = MSBFIRST) {
+        shiftedKnown = false;
+        shiftBytes(bytes, bitOrder);
+    }
+
+    /**
+     * Shifts the lowest chainLength bytes of the @param bits without latching them.
+     * The most significant byte goes to the last register in the chain.
+     * Nothing is shifted if the Shift Register already holds them or if the chain is longer than SHIFT_REGISTER_MAX_CHAIN_LENGTH.
+     */
+    void shift(const uint32_t& bits, const uint8_t& bitOrder = MSBFIRST) {
+
+        if (chainLength > SHIFT_REGISTER_MAX_CHAIN_LENGTH)
+            return;
+
+        if (bitOrder == MSBFIRST && shiftedKnown && bits == shifted)
+            return;
+
+        uint8_t bytes[SHIFT_REGISTER_MAX_CHAIN_LENGTH];
+
+        for (uint8_t i = 0; i < chainLength; ++i)
+            bytes[i] = bits >> (8 * (chainLength - 1 - i));
+
+        shiftBytes(bytes, bitOrder);
+        shiftedKnown = bitOrder == MSBFIRST;
+        shifted = bits;
+    }
+
+    /**
+     * Moves the shifted bits to the outputs.
+     * The 74HC595 moves the bits to the Storage Register on the rising edge of RCLK.
+     */
+    void latch() {
+        hal.beginOperation(PERF_LATCH);
+        uint8_t interrupts = hal.disableInterrupts();
+        hal.write(rclk, HIGH);
+        hal.write(rclk, LOW);
+        hal.restoreInterrupts(interrupts);
+        hal.endOperation(PERF_LATCH);
+
+        latchedKnown = shiftedKnown;
+        latched = shifted;
+    }
+
+    void write(const uint8_t* bytes, const uint8_t& bitOrder = MSBFIRST) {
+        shift(bytes, bitOrder);
+        latch();
+    }
+
+    /**
+     * Shifts and latches the @param bits, unless they are already on the outputs. Like shift() only for chains up to
+     * SHIFT_REGISTER_MAX_CHAIN_LENGTH registers.
+     */
+    void write(const uint32_t& bits, const uint8_t& bitOrder = MSBFIRST) {
+
+        if (chainLength > SHIFT_REGISTER_MAX_CHAIN_LENGTH)
+            return;
+
+        if (bitOrder == MSBFIRST && latchedKnown && bits == latched)
+            return;
+
+        shift(bits, bitOrder);
+        latch();
+    }
+
+    uint8_t getMode() const {
+        return mode;
+    }
+
+    uint8_t getChainLength() const {
+        return chainLength;
+    }
+
+private:
+
+    /**
+     * The whole chain is shifted with disabled interrupts, not each byte on its own.
+     */
+    void shiftBytes(const uint8_t* bytes, const uint8_t& bitOrder) {
+
+        hal.beginOperation(PERF_SHIFT);
+
+        if (mode == SHIFT_REGISTER_HARDWARE_SPI) {
+            hal.spiTransfer(bytes, chainLength, spiClock, bitOrder);
+        } else {
+            uint8_t interrupts = hal.disableInterrupts();
+
+            for (uint8_t i = 0; i < chainLength; ++i)
+                shiftByte(bytes[i], bitOrder);
+
+            hal.restoreInterrupts(interrupts);
+        }
+
+        hal.endOperation(PERF_SHIFT);
+    }
+
+    /**
+     * Same as Arduino's shiftOut(), but with the prepared pins.
+     * The bit is placed on SER and then stored on the rising edge of SRCLK. SER is written only when the bit differs from the previous one,
+     * an address has long runs of the same bits (the unused high ones are all 0).
+     */
+    void shiftByte(const uint8_t& value, const uint8_t& bitOrder) {
+
+        for (uint8_t i = 0; i < 8; ++i) {
+            bool bit = bitOrder == LSBFIRST ? (value >> i) & 0b1 : (value >> (7 - i)) & 0b1;
+
+            if (bit != serLevel) {
+                hal.write(ser, bit);
+                serLevel = bit;
+            }
+
+            hal.write(srClk, HIGH);
+            hal.write(srClk, LOW);
+        }
+    }
+
+    HAL& hal;
+    uint8_t mode;
+    uint8_t chainLength;
+    uint8_t serPin;
+    uint8_t srClkPin;
+    uint8_t rclkPin;
+    uint32_t spiClock;
+
+    typename HAL::Pin ser;
+    typename HAL::Pin srClk;
+    typename HAL::Pin rclk;
+
+    /**
+     * The level of SER and the words in the Shift Register and on the outputs. Unknown after the byte array functions and LSBFIRST.
+     */
+    bool serLevel;
+    bool shiftedKnown;
+    bool latchedKnown;
+    uint32_t shifted;
+    uint32_t latched;
+};
+
+#endif
@@ -0,0 +1,308 @@
+#include "SimulatedBoard.h"
+
+/*---------------- Simulated74HC595Chain ----------------*/
+
+Simulated74HC595Chain::Simulated74HC595Chain(const uint8_t& length)
+        : length(length),
+          mask(length >= 4 ? 0xFFFFFFFF : (1UL << (8 * length)) - 1),
+          shiftRegister(0),
+          outputs(0) {
+}
+
+void Simulated74HC595Chain::clock(const bool& ser) {
+    shiftRegister = ((shiftRegister << 1) | ser) & mask;
+}
+
+void Simulated74HC595Chain::latch() {
+    outputs = shiftRegister;
+}
+
+uint32_t Simulated74HC595Chain::getShiftRegister() const {
+    return shiftRegister;
+}
+
+uint32_t Simulated74HC595Chain::getOutputs() const {
+    return outputs;
+}
+
+uint8_t Simulated74HC595Chain::getLength() const {
+    return length;
+}
+
+/*---------------- SimulatedBoard ----------------*/
+
+SimulatedBoard::SimulatedBoard(SimulatedEEPROM& eeprom, const SimulatedBoardPins& pins, const SimulatedBoardTiming& timing)
+        : pins(pins),
+          timing(timing),
+          chain(pins.chainLength),
+          interruptsEnabled(true),
+          dataBusDirection(DATA_BUS_INPUT),
+          dataBus(0),
+          busContention(false),
+          socketCount(1) {
+
+    Socket first = {&eeprom, pins.we, pins.outputEnableBit, false, 0};
+    sockets[0] = first;
+    sockets[1] = first;
+
+    for (uint8_t i = 0; i < SIMULATED_BOARD_PIN_COUNT; ++i) {
+        levels[i] = LOW;
+        pinToggles[i] = 0;
+    }
+
+    SimulatedBoardCounters empty = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+    counters = empty;
+}
+
+SimulatedBoard::Pin SimulatedBoard::pin(const uint8_t& number) {
+    return number;
+}
+
+void SimulatedBoard::pinMode(const uint8_t& number, const uint8_t& mode) {
+    (void) number;
+    (void) mode;
+    elapse(timing.pinModeCycles);
+}
+
+void SimulatedBoard::write(const Pin& pin, const bool& value) {
+
+    elapse(timing.pinWriteCycles);
+
+    if (pin >= SIMULATED_BOARD_PIN_COUNT || levels[pin] == value)
+        return;
+
+    levels[pin] = value;
+    pinToggles[pin]++;
+    counters.pinToggles++;
+
+    if (pin == pins.srClk && value) {
+        chain.clock(levels[pins.ser]);
+        counters.shiftClocks++;
+    } else if (pin == pins.rclk && value) {
+        latchChain();
+    } else {
+        for (uint8_t socket = 0; socket < socketCount; ++socket) {
+            if (pin == sockets[socket].we)
+                writeEnableEdge(socket, value);
+        }
+    }
+}
+
+uint8_t SimulatedBoard::disableInterrupts() {
+    elapse(timing.interruptsCycles);
+
+    uint8_t state = interruptsEnabled;
+    interruptsEnabled = false;
+    return state;
+}
+
+void SimulatedBoard::restoreInterrupts(const uint8_t& state) {
+    elapse(timing.interruptsCycles);
+    interruptsEnabled = state;
+}
+
+/**
+ * Like ArduinoHAL the outputs are cleared when the bus becomes an input, so there are no pull-ups.
+ */
+void SimulatedBoard::setDataBusDirection(const uint8_t& direction) {
+
+    elapse(timing.dataBusDirectionCycles);
+    dataBusDirection = direction;
+
+    if (direction != DATA_BUS_OUTPUT)
+        dataBus = 0;
+
+    updateBusContention();
+}
+
+void SimulatedBoard::writeDataBus(const uint8_t& data) {
+
+    elapse(timing.dataBusWriteCycles);
+    counters.dataBusWrites++;
+
+    if (dataBusDirection == DATA_BUS_OUTPUT) {
+        for (uint8_t changed = dataBus ^ data; changed; changed &= changed - 1)
+            counters.pinToggles++;
+    }
+
+    dataBus = data;
+}
+
+uint8_t SimulatedBoard::readDataBus() {
+
+    elapse(timing.dataBusReadCycles);
+    counters.dataBusReads++;
+
+    if (dataBusDirection == DATA_BUS_OUTPUT)
+        return dataBus;
+
+    /**
+     * With both outputs enabled each bit is LOW if any of the chips pulls it LOW.
+     */
+    uint8_t data = 0xFF;
+    bool driven = false;
+
+    for (uint8_t socket = 0; socket < socketCount; ++socket) {
+        if (isOutputEnabled(socket) && !sockets[socket].writing) {
+            data &= sockets[socket].eeprom->read(getAddress(), nowUs());
+            driven = true;
+        }
+    }
+
+    return driven ? data : 0;
+}
+
+void SimulatedBoard::spiBegin() {
+    elapse(3 * timing.pinModeCycles);
+}
+
+/**
+ * SPI mode 0 - MOSI is set before the rising edge of SCK, so each bit goes to the chain like with bit bang.
+ */
+void SimulatedBoard::spiTransfer(const uint8_t* bytes, const uint8_t& length, const uint32_t& clock, const uint8_t& bitOrder) {
+
+    (void) clock;
+    elapse(timing.spiTransactionCycles);
+
+    bool mosi = LOW;
+
+    for (uint8_t i = 0; i < length; ++i) {
+        elapse(timing.spiByteCycles);
+
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            bool value = bitOrder == LSBFIRST ? (bytes[i] >> bit) & 0b1 : (bytes[i] >> (7 - bit)) & 0b1;
+
+            if (value != mosi)
+                counters.pinToggles++;
+
+            mosi = value;
+            chain.clock(value);
+            counters.shiftClocks++;
+            counters.pinToggles += 2;
+        }
+    }
+}
+
+uint32_t SimulatedBoard::micros() {
+    elapse(timing.microsCycles);
+    return nowUs();
+}
+
+void SimulatedBoard::delayMicroseconds(const uint16_t& us) {
+    elapse((uint32_t) ((uint64_t) us * timing.clockHz / 1000000));
+}
+
+void SimulatedBoard::delayMilliseconds(const uint16_t& ms) {
+    elapse((uint32_t) ((uint64_t) ms * timing.clockHz / 1000));
+}
+
+void SimulatedBoard::beginCycleCounter() {
+}
+
+uint16_t SimulatedBoard::cycleCounter() {
+    return counters.cycles;
+}
+
+void SimulatedBoard::beginOperation(const uint8_t&) {
+}
+
+void SimulatedBoard::endOperation(const uint8_t&) {
+}
+
+const SimulatedBoardCounters& SimulatedBoard::getCounters() const {
+    return counters;
+}
+
+uint64_t SimulatedBoard::getPinToggles(const uint8_t& pin) const {
+    return pin < SIMULATED_BOARD_PIN_COUNT ? pinToggles[pin] : 0;
+}
+
+bool SimulatedBoard::getPinLevel(const uint8_t& pin) const {
+    return pin < SIMULATED_BOARD_PIN_COUNT && levels[pin];
+}
+
+void SimulatedBoard::attachSecondEEPROM(SimulatedEEPROM& second, const uint8_t& wePin, const uint8_t& outputEnableBit) {
+    Socket socket = {&second, wePin, outputEnableBit, false, 0};
+    sockets[1] = socket;
+    socketCount = 2;
+}
+
+uint16_t SimulatedBoard::getAddress() const {
+    return chain.getOutputs() & ((1UL << pins.outputEnableBit) - 1) & (sockets[0].eeprom->getSize() - 1);
+}
+
+bool SimulatedBoard::isOutputEnabled() const {
+    return isOutputEnabled(0) || (socketCount > 1 && isOutputEnabled(1));
+}
+
+bool SimulatedBoard::isOutputEnabled(const uint8_t& socket) const {
+    return !((chain.getOutputs() >> sockets[socket].outputEnableBit) & 0b1);
+}
+
+const Simulated74HC595Chain& SimulatedBoard::getChain() const {
+    return chain;
+}
+
+SimulatedEEPROM& SimulatedBoard::getEEPROM(const uint8_t& socket) {
+    return *sockets[socket < socketCount ? socket : 0].eeprom;
+}
+
+double SimulatedBoard::cyclesToMicros(const uint64_t& cycles) const {
+    return cycles * 1000000.0 / timing.clockHz;
+}
+
+void SimulatedBoard::elapse(const uint32_t& cycles) {
+    counters.cycles += cycles;
+}
+
+/**
+ * The time seen by the EEPROM. Unlike micros() it costs nothing.
+ */
+uint32_t SimulatedBoard::nowUs() const {
+    return (uint32_t) (counters.cycles * 1000000 / timing.clockHz);
+}
+
+void SimulatedBoard::latchChain() {
+    chain.latch();
+    counters.latches++;
+    updateBusContention();
+}
+
+/**
+ * The AT28C16 latches the address on the falling edge of WE and the data on the rising one.
+ * A LOW OE of the same chip inhibits the write.
+ */
+void SimulatedBoard::writeEnableEdge(const uint8_t& socket, const bool& level) {
+
+    Socket& chip = sockets[socket];
+
+    if (!level) {
+        chip.writing = !isOutputEnabled(socket);
+        chip.writeAddress = getAddress();
+
+        if (!chip.writing)
+            counters.inhibitedWrites++;
+
+        return;
+    }
+
+    if (!chip.writing)
+        return;
+
+    chip.writing = false;
+    counters.writePulses++;
+    chip.eeprom->write(chip.writeAddress, dataBusDirection == DATA_BUS_OUTPUT ? dataBus : 0, nowUs());
+}
+
+/**
+ * The Nano and a chip, or two chips drive the bus at the same time.
+ */
+void SimulatedBoard::updateBusContention() {
+
+    bool contention = (dataBusDirection == DATA_BUS_OUTPUT && isOutputEnabled()) || (socketCount > 1 && isOutputEnabled(0) && isOutputEnabled(1));
+
+    if (contention && !busContention)
+        counters.busContentions++;
+
+    busContention = contention;
+}
@@ -0,0 +1,248 @@
+#ifndef SIMULATED_BOARD_H
+#define SIMULATED_BOARD_H
+
+#include <stdint.h>
+
+#include <HAL.h>
+#include <DataBus.h>
+#include <SimulatedEEPROM.h>
+
+/**
+ * Pin level model of the programmer's board, which implements the HAL (see HAL.h) on the host.
+ * The drivers (ShiftRegister, EEPROMProgrammer) run unchanged on it and each of their pin writes is executed
+ * on a model of the 74HC595 chain and the AT28C16 (SimulatedEEPROM):
+ * - SRCLK rising edge - The level of SER is shifted in.
+ * - RCLK rising edge - The shifted bits are moved to the outputs, which are the address and OE (active LOW, bit 11 for the AT28C16).
+ * - WE falling edge - The EEPROM latches the address. If OE is active the write is inhibited like on the real chip.
+ * - WE rising edge - The EEPROM latches the data bus and starts its write cycle.
+ * A second EEPROM can be attached (attachSecondEEPROM()) like the second socket of EEPROMProgrammer. It shares the address and the data bus,
+ * but has its own WE pin and OE bit. If both outputs are enabled at once, the chips fight over the bus (counted as a bus contention).
+ *
+ * The time is simulated. Each HAL call costs the CPU cycles of the Nano given by SimulatedBoardTiming,
+ * so the benchmarks give the same numbers on every run and every machine.
+ */
+
+#define SIMULATED_BOARD_PIN_COUNT 32
+#define SIMULATED_BOARD_SOCKETS 2
+
+/**
+ * Chain of 74HC595 shift registers. The bits are shifted from the first register to the next ones through QH'.
+ * The outputs of the chain are a single number, where the first register drives the lowest byte.
+ */
+class Simulated74HC595Chain {
+
+public:
+
+    explicit Simulated74HC595Chain(const uint8_t& length);
+
+    /**
+     * Rising edge of SRCLK.
+     */
+    void clock(const bool& ser);
+
+    /**
+     * Rising edge of RCLK.
+     */
+    void latch();
+
+    uint32_t getShiftRegister() const;
+
+    uint32_t getOutputs() const;
+
+    uint8_t getLength() const;
+
+private:
+
+    uint8_t length;
+    uint32_t mask;
+    uint32_t shiftRegister;
+    uint32_t outputs;
+};
+
+/**
+ * Which pin of the Nano is connected to what. The data bus is not here, because the HAL moves it as a whole byte.
+ * In SPI mode the chain is clocked by spiTransfer() and SER and SRCLK are not used.
+ * @param outputEnableBit The output of the chain connected to OE (ChipProfile.h). The outputs below it are the address.
+ */
+struct SimulatedBoardPins {
+    uint8_t ser;
+    uint8_t srClk;
+    uint8_t rclk;
+    uint8_t we;
+    uint8_t chainLength;
+    uint8_t outputEnableBit;
+};
+
+/**
+ * Cost of each HAL call in CPU cycles.
+ * ! They are estimates of the code in ArduinoHAL.h compiled for the ATmega328 and not measurements on the real Nano.
+ * The loops and the function calls in the drivers are not counted, so the real board is somewhat slower.
+ */
+struct SimulatedBoardTiming {
+    uint32_t clockHz;
+    uint16_t pinWriteCycles;
+    uint16_t pinModeCycles;
+    uint16_t interruptsCycles;
+    uint16_t dataBusWriteCycles;
+    uint16_t dataBusReadCycles;
+    uint16_t dataBusDirectionCycles;
+    uint16_t spiTransactionCycles;
+    uint16_t spiByteCycles;
+    uint16_t microsCycles;
+};
+
+/**
+ * ATmega328 at 16 MHz:
+ * - Pin write - Read-modify-write of the port register through a pointer.
+ * - Interrupts - Saving SREG and cli(), or restoring it.
+ * - Data bus write/read - Two masked port writes (reads) and the bit reversal lookups (DataBus.h).
+ * - Data bus direction - Four masked register writes.
+ * - SPI byte - 16 cycles at 8 MHz SCK and waiting for the SPIF flag.
+ * - micros() - Reading the Timer0 overflow counter with disabled interrupts.
+ */
+constexpr SimulatedBoardTiming SIMULATED_NANO_TIMING = {16000000, 5, 60, 3, 20, 16, 16, 30, 20, 50};
+
+/**
+ * Counters since the creation of the board. Take a copy before and subtract it to measure a part of the work.
+ * @param pinToggles Level changes of the pins, the data bus included (only while it is an output).
+ * @param busContentions How many times both the Nano and the EEPROM started to drive the data bus (OE active while the bus is OUTPUT).
+ * @param inhibitedWrites WE pulses while OE was active, which the EEPROM ignores.
+ */
+struct SimulatedBoardCounters {
+    uint64_t cycles;
+    uint64_t pinToggles;
+    uint32_t shiftClocks;
+    uint32_t latches;
+    uint32_t dataBusWrites;
+    uint32_t dataBusReads;
+    uint32_t writePulses;
+    uint32_t inhibitedWrites;
+    uint32_t busContentions;
+};
+
+class SimulatedBoard {
+
+public:
+
+    typedef uint8_t Pin;
+
+    SimulatedBoard(SimulatedEEPROM& eeprom, const SimulatedBoardPins& pins, const SimulatedBoardTiming& timing = SIMULATED_NANO_TIMING);
+
+    /*---------------- HAL ----------------*/
+
+    Pin pin(const uint8_t& number);
+
+    void pinMode(const uint8_t& number, const uint8_t& mode);
+
+    void write(const Pin& pin, const bool& value);
+
+    uint8_t disableInterrupts();
+
+    void restoreInterrupts(const uint8_t& state);
+
+    void setDataBusDirection(const uint8_t& direction);
+
+    void writeDataBus(const uint8_t& data);
+
+    /**
+     * Returns the EEPROM's data if its output is enabled. A floating bus (no pull-ups) is read as 0.
+     */
+    uint8_t readDataBus();
+
+    void spiBegin();
+
+    void spiTransfer(const uint8_t* bytes, const uint8_t& length, const uint32_t& clock, const uint8_t& bitOrder);
+
+    uint32_t micros();
+
+    void delayMicroseconds(const uint16_t& us);
+
+    void delayMilliseconds(const uint16_t& ms);
+
+    void beginCycleCounter();
+
+    uint16_t cycleCounter();
+
+    /**
+     * Not measured, the board has its own counters. Wrap it in ProfilingHAL for the PerfCounters.
+     */
+    void beginOperation(const uint8_t& operation);
+
+    void endOperation(const uint8_t& operation);
+
+    /**
+     * The second chip on the same address and data bus. @param outputEnableBit must be above the address bits.
+     */
+    void attachSecondEEPROM(SimulatedEEPROM& second, const uint8_t& wePin, const uint8_t& outputEnableBit);
+
+    /*---------------- Inspection ----------------*/
+
+    const SimulatedBoardCounters& getCounters() const;
+
+    uint64_t getPinToggles(const uint8_t& pin) const;
+
+    bool getPinLevel(const uint8_t& pin) const;
+
+    uint16_t getAddress() const;
+
+    /**
+     * True if any of the chips drives the data bus.
+     */
+    bool isOutputEnabled() const;
+
+    const Simulated74HC595Chain& getChain() const;
+
+    /**
+     * @param socket 0 for the first chip, 1 for the attached second one.
+     */
+    SimulatedEEPROM& getEEPROM(const uint8_t& socket = 0);
+
+    /**
+     * Converts CPU cycles of the simulated Nano to microseconds.
+     */
+    double cyclesToMicros(const uint64_t& cycles) const;
+
+private:
+
+    void elapse(const uint32_t& cycles);
+
+    uint32_t nowUs() const;
+
+    void latchChain();
+
+    bool isOutputEnabled(const uint8_t& socket) const;
+
+    void writeEnableEdge(const uint8_t& socket, const bool& level);
+
+    void updateBusContention();
+
+    /**
+     * A chip on the board. @param writing Between the falling and the rising edge of its WE, if the write wasn't inhibited.
+     */
+    struct Socket {
+        SimulatedEEPROM* eeprom;
+        uint8_t we;
+        uint8_t outputEnableBit;
+        bool writing;
+        uint16_t writeAddress;
+    };
+
+    SimulatedBoardPins pins;
+    SimulatedBoardTiming timing;
+    Simulated74HC595Chain chain;
+
+    bool levels[SIMULATED_BOARD_PIN_COUNT];
+    uint64_t pinToggles[SIMULATED_BOARD_PIN_COUNT];
+    bool interruptsEnabled;
+
+    uint8_t dataBusDirection;
+    uint8_t dataBus;
+    bool busContention;
+
+    Socket sockets[SIMULATED_BOARD_SOCKETS];
+    uint8_t socketCount;
+
+    SimulatedBoardCounters counters;
+};
+
+#endif
@@ -0,0 +1,163 @@
+#include "SimulatedEEPROM.h"
+
+SimulatedEEPROM::SimulatedEEPROM(const uint32_t& size, const uint32_t& writeCycleUs)
+        : memory(size, 0xFF),
+          writeCycleUs(writeCycleUs),
+          pageSize(1),
+          byteLoadCycleUs(0),
+          dataPolling(true),
+          toggleBit(true),
+          loading(false),
+          loadPage(0),
+          lastLoadUs(0),
+          busy(false),
+          busySinceUs(0),
+          pendingAddress(0),
+          pendingData(0),
+          toggleState(0),
+          writes(0),
+          ignoredWrites(0),
+          pageBoundaryErrors(0),
+          writeCycles(0) {
+}
+
+bool SimulatedEEPROM::write(const uint32_t& address, const uint8_t& data, const uint32_t& nowUs) {
+
+    if (isBusy(nowUs)) {
+        ignoredWrites++;
+        return false;
+    }
+
+    uint32_t pageAddress = address % memory.size();
+
+    if (pageSize <= 1) {
+        pendingAddresses.assign(1, pageAddress);
+        pendingValues.assign(1, data);
+        startWriteCycle(nowUs);
+    } else {
+        if (!loading) {
+            loading = true;
+            loadPage = pageAddress / pageSize;
+            pendingAddresses.clear();
+            pendingValues.clear();
+        } else if (pageAddress / pageSize != loadPage) {
+            pageBoundaryErrors++;
+            pageAddress = loadPage * pageSize + pageAddress % pageSize;
+        }
+
+        lastLoadUs = nowUs;
+        pendingAddresses.push_back(pageAddress);
+        pendingValues.push_back(data);
+    }
+
+    pendingAddress = pageAddress;
+    pendingData = data;
+    toggleState = 0;
+    writes++;
+
+    return true;
+}
+
+/**
+ * Example (written data 0b10110110, old data 0b11111111):
+ * Busy, Read 1: 0b0 0 111111 (I/O7 is the complement, I/O6 toggled to 0, the rest is the old data)
+ * Busy, Read 2: 0b0 1 111111 (I/O6 toggled to 1)
+ * Done, Read 3: 0b10110110
+ */
+uint8_t SimulatedEEPROM::read(const uint32_t& address, const uint32_t& nowUs) {
+
+    if (!isBusy(nowUs) && loading)
+        startWriteCycle(nowUs);
+
+    if (!isBusy(nowUs))
+        return memory[address % memory.size()];
+
+    uint8_t status = memory[pendingAddress];
+
+    if (dataPolling)
+        status = (status & 0b01111111) | (~pendingData & 0b10000000);
+
+    if (toggleBit) {
+        status = (status & 0b10111111) | toggleState;
+        toggleState ^= 0b01000000;
+    }
+
+    return status;
+}
+
+bool SimulatedEEPROM::isBusy(const uint32_t& nowUs) {
+
+    if (loading && nowUs - lastLoadUs >= byteLoadCycleUs)
+        startWriteCycle(lastLoadUs + byteLoadCycleUs);
+
+    if (busy && nowUs - busySinceUs >= writeCycleUs)
+        completeWriteCycle();
+
+    return busy;
+}
+
+void SimulatedEEPROM::startWriteCycle(const uint32_t& sinceUs) {
+    loading = false;
+    busy = true;
+    busySinceUs = sinceUs;
+    writeCycles++;
+}
+
+void SimulatedEEPROM::completeWriteCycle() {
+
+    for (uint32_t i = 0; i < pendingAddresses.size(); ++i)
+        memory[pendingAddresses[i]] = pendingValues[i];
+
+    busy = false;
+}
+
+uint8_t SimulatedEEPROM::peek(const uint32_t& address) const {
+    return memory[address % memory.size()];
+}
+
+void SimulatedEEPROM::fill(const uint8_t& value) {
+
+    for (uint32_t address = 0; address < memory.size(); ++address)
+        memory[address] = value;
+}
+
+void SimulatedEEPROM::setWriteCycleUs(const uint32_t& writeCycleUs) {
+    this->writeCycleUs = writeCycleUs;
+}
+
+uint32_t SimulatedEEPROM::getWriteCycleUs() const {
+    return writeCycleUs;
+}
+
+void SimulatedEEPROM::setPageMode(const uint32_t& pageSize, const uint32_t& byteLoadCycleUs) {
+    this->pageSize = pageSize;
+    this->byteLoadCycleUs = byteLoadCycleUs;
+}
+
+void SimulatedEEPROM::setDataPolling(const bool& enabled) {
+    dataPolling = enabled;
+}
+
+void SimulatedEEPROM::setToggleBit(const bool& enabled) {
+    toggleBit = enabled;
+}
+
+uint32_t SimulatedEEPROM::getSize() const {
+    return memory.size();
+}
+
+uint32_t SimulatedEEPROM::getWrites() const {
+    return writes;
+}
+
+uint32_t SimulatedEEPROM::getIgnoredWrites() const {
+    return ignoredWrites;
+}
+
+uint32_t SimulatedEEPROM::getPageBoundaryErrors() const {
+    return pageBoundaryErrors;
+}
+
+uint32_t SimulatedEEPROM::getWriteCycles() const {
+    return writeCycles;
+}
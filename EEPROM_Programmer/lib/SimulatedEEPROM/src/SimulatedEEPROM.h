@@ -0,0 +1,151 @@
+#ifndef SIMULATED_EEPROM_H
+#define SIMULATED_EEPROM_H
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Software model of the AT28C16 EEPROM, which is used on the host instead of the real chip.
+ * Only the behaviour, which is important for the programmer is modeled:
+ * - Write starts an internal write cycle with configurable length (tWC). Writes during it are ignored like on the real chip.
+ * - Reads during the write cycle return the DATA# Polling (I/O7) and Toggle Bit (I/O6) status instead of the data.
+ * - After the write cycle the data is stored.
+ * - Page write (28C64B, 28C256) - The writes within tBLC of each other are collected and written with a single write cycle,
+ *   which starts tBLC after the last one or on the first read (OE active), so the polling can start right after the last load.
+ *   A byte from another page is written in the loaded page (like on the real chip the page address of the first byte is used)
+ *   and counted as a page boundary error.
+ *
+ * The time is not measured by the model. It is given on each call, so the simulation is deterministic.
+ */
+class SimulatedEEPROM {
+
+public:
+
+    /**
+     * @param size Number of addresses. 2048 for the AT28C16.
+     * @param writeCycleUs Length of the internal write cycle in microseconds.
+     */
+    explicit SimulatedEEPROM(const uint32_t& size = 2048, const uint32_t& writeCycleUs = 1000);
+
+    /**
+     * Latches the data on the rising edge of WE and starts the write cycle (in page mode loads the byte in the page).
+     * @return False if the chip was busy with previous write cycle and the write was ignored.
+     */
+    bool write(const uint32_t& address, const uint8_t& data, const uint32_t& nowUs);
+
+    /**
+     * Reads the data on the given address with OE active.
+     * During the write cycle the returned value is the polling status (DATA#, Toggle Bit) and not the data.
+     */
+    uint8_t read(const uint32_t& address, const uint32_t& nowUs);
+
+    bool isBusy(const uint32_t& nowUs);
+
+    /**
+     * Returns the stored data without timing or polling behaviour. Useful for checking the result of the programming.
+     * Data of a write cycle in progress is not visible until isBusy() is called after the cycle has ended.
+     */
+    uint8_t peek(const uint32_t& address) const;
+
+    void fill(const uint8_t& value);
+
+    void setWriteCycleUs(const uint32_t& writeCycleUs);
+
+    uint32_t getWriteCycleUs() const;
+
+    /**
+     * @param pageSize 1 disables the page write.
+     * @param byteLoadCycleUs tBLC - The maximum time between the loads of two bytes of a page.
+     */
+    void setPageMode(const uint32_t& pageSize, const uint32_t& byteLoadCycleUs);
+
+    /**
+     * Disabling them simulates chips (or clones), which doesn't support the given polling method.
+     */
+    void setDataPolling(const bool& enabled);
+
+    void setToggleBit(const bool& enabled);
+
+    uint32_t getSize() const;
+
+    uint32_t getWrites() const;
+
+    /**
+     * Writes during a write cycle. In page mode that includes the bytes loaded too late (after tBLC).
+     */
+    uint32_t getIgnoredWrites() const;
+
+    uint32_t getPageBoundaryErrors() const;
+
+    /**
+     * Number of the write cycles. In page mode a cycle writes the whole loaded page.
+     */
+    uint32_t getWriteCycles() const;
+
+private:
+
+    void startWriteCycle(const uint32_t& sinceUs);
+
+    void completeWriteCycle();
+
+    std::vector<uint8_t> memory;
+    uint32_t writeCycleUs;
+    uint32_t pageSize;
+    uint32_t byteLoadCycleUs;
+    bool dataPolling;
+    bool toggleBit;
+
+    bool loading;
+    uint32_t loadPage;
+    uint32_t lastLoadUs;
+
+    bool busy;
+    uint32_t busySinceUs;
+    std::vector<uint32_t> pendingAddresses;
+    std::vector<uint8_t> pendingValues;
+    uint32_t pendingAddress;
+    uint8_t pendingData;
+    uint8_t toggleState;
+
+    uint32_t writes;
+    uint32_t ignoredWrites;
+    uint32_t pageBoundaryErrors;
+    uint32_t writeCycles;
+};
+
+/**
+ * Simulated time, which is advanced by the code that uses the simulation instead of passing on its own.
+ */
+struct SimulatedClock {
+    uint32_t nowUs;
+
+    void advance(const uint32_t& us) {
+        nowUs += us;
+    }
+};
+
+/**
+ * Connects the simulated EEPROM to waitForWriteCycle().
+ * Each read costs @param readCostUs of simulated time, which is the time the programmer needs for a single read of the data bus.
+ */
+struct SimulatedWriteCycleBus {
+    SimulatedEEPROM& eeprom;
+    SimulatedClock& clock;
+    uint32_t address;
+    uint32_t readCostUs;
+
+    uint8_t readData() {
+        clock.advance(readCostUs);
+        return eeprom.read(address, clock.nowUs);
+    }
+
+    uint32_t micros() {
+        return clock.nowUs;
+    }
+
+    void delayMilliseconds(const uint16_t& ms) {
+        clock.advance(ms * 1000UL);
+    }
+};
+
+#endif
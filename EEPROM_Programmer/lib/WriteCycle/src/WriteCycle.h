@@ -0,0 +1,252 @@
+#ifndef WRITE_CYCLE_H
+#define WRITE_CYCLE_H
+
+#include <stdint.h>
+
+/**
+ * After the rising edge of WE the EEPROM starts its internal write cycle (tWC).
+ * While it is busy it ignores every new write, so we must wait for it before writing the next byte.
+ * Waiting a fixed worst case time (10ms) works, but the chip usually finishes much sooner.
+ *
+ * While the write cycle is in progress the chip still answers to reads (OE LOW) in a special way:
+ * - DATA# Polling: I/O7 returns the complement of the bit 7 that was written. When the cycle is done it returns the true data.
+ * - Toggle Bit: I/O6 changes its value on every consecutive read. When the cycle is done it stops toggling.
+ *
+ * That way by reading the data bus we can find the real end of the write cycle and continue immediately.
+ * The methods can be combined. The cycle is considered complete only when all of the selected methods agree.
+ */
+
+#define WRITE_CYCLE_FIXED_DELAY 0b00
+#define WRITE_CYCLE_DATA_POLLING 0b01
+#define WRITE_CYCLE_TOGGLE_BIT 0b10
+
+#define WRITE_CYCLE_DEFAULT_TIMEOUT_US 20000
+#define WRITE_CYCLE_DEFAULT_FALLBACK_DELAY_MS 10
+
+#define DATA_POLLING_BIT 0b10000000
+#define TOGGLE_BIT 0b01000000
+
+/**
+ * @param methods Combination of WRITE_CYCLE_DATA_POLLING and WRITE_CYCLE_TOGGLE_BIT or WRITE_CYCLE_FIXED_DELAY for only waiting.
+ * @param timeoutUs For how long to poll the data bus before giving up.
+ * @param fallbackDelayMs How long to wait when the polling timed out or is disabled. That is the old fixed delay.
+ */
+struct WriteCycleConfig {
+    uint8_t methods;
+    uint32_t timeoutUs;
+    uint16_t fallbackDelayMs;
+};
+
+/**
+ * @param completed True if the end of the write cycle was detected and the data bus returned the written data.
+ * False means that the polling timed out and the fallback delay was used.
+ * @param elapsedUs Time from the start of the polling until detection or timeout.
+ * @param polls How many times the data bus was read.
+ */
+struct WriteCycleResult {
+    bool completed;
+    uint32_t elapsedUs;
+    uint16_t polls;
+};
+
+/**
+ * True if all of the selected @param methods agree, that the write cycle of the @param data is over.
+ * @param current The last read of the data bus.
+ * @param previous The read before it (Toggle Bit compares them).
+ */
+inline bool isWriteCycleDone(const uint8_t& current, const uint8_t& previous, const uint8_t& data, const uint8_t& methods) {
+
+    bool dataPollingDone = ((current ^ data) & DATA_POLLING_BIT) == 0;
+    bool toggleBitDone = ((current ^ previous) & TOGGLE_BIT) == 0;
+
+    bool done = true;
+
+    if (methods & WRITE_CYCLE_DATA_POLLING)
+        done = done && dataPollingDone;
+
+    if (methods & WRITE_CYCLE_TOGGLE_BIT)
+        done = done && toggleBitDone;
+
+    return done;
+}
+
+/**
+ * Will block until the EEPROM completes its internal write cycle or the timeout passes.
+ * Before calling it the address of the written byte must be selected and OE must be active, so that each read returns the polling data.
+ *
+ * The @param bus must provide:
+ * - uint8_t readData() - Reads the data bus (I/O0-7).
+ * - uint32_t micros() - Monotonic time in microseconds.
+ * - void delayMilliseconds(uint16_t) - Blocks for the given time.
+ *
+ * That way the same logic is used by the Arduino and by the simulated EEPROM on the host.
+ *
+ * Example (DATA# Polling, written data 0b10110110):
+ * Read 1: 0b0xxxxxxx (I/O7 is the complement, still busy)
+ * Read 2: 0b0xxxxxxx (Still busy)
+ * Read 3: 0b1xxxxxxx (I/O7 is the true bit, the cycle is done)
+ * Read 4: 0b10110110 (Other I/O pins may settle after I/O7, thus one more read for verification)
+ *
+ * If the verification read doesn't return the written data the polling continues.
+ * That protects us from chips, which doesn't support the selected method and return random data.
+ */
+template<typename Bus>
+WriteCycleResult waitForWriteCycle(Bus& bus, const uint8_t& data, const WriteCycleConfig& config) {
+
+    WriteCycleResult result = {false, 0, 0};
+
+    if (config.methods == WRITE_CYCLE_FIXED_DELAY) {
+        bus.delayMilliseconds(config.fallbackDelayMs);
+        return result;
+    }
+
+    uint32_t start = bus.micros();
+    uint8_t previous = bus.readData();
+    result.polls++;
+
+    while (true) {
+        uint8_t current = bus.readData();
+        result.polls++;
+        result.elapsedUs = bus.micros() - start;
+
+        if (isWriteCycleDone(current, previous, data, config.methods)) {
+            current = bus.readData();
+            result.polls++;
+
+            if (current == data) {
+                result.completed = true;
+                return result;
+            }
+        }
+
+        if (result.elapsedUs >= config.timeoutUs)
+            break;
+
+        previous = current;
+    }
+
+    bus.delayMilliseconds(config.fallbackDelayMs);
+    return result;
+}
+
+#define WRITE_CYCLE_POLLER_IDLE 0
+#define WRITE_CYCLE_POLLER_FIRST_READ 1
+#define WRITE_CYCLE_POLLER_POLLING 2
+#define WRITE_CYCLE_POLLER_FALLBACK 3
+
+/**
+ * The same detection as waitForWriteCycle(), but without blocking. Each poll() reads the data bus once (or only checks the time
+ * while the fallback delay runs) and returns, so the caller can do something else during the write cycle (see Scheduler.h).
+ * Nothing may change the address or OE between the polls. Shifting without latching (ShiftRegister::shift()) is fine.
+ *
+ * The @param Bus of poll() needs only readData() and micros().
+ * Like in waitForWriteCycle() a failed verification read is the previous read of the next poll, so Toggle Bit always compares
+ * two adjacent reads.
+ *
+ * Example:
+ * poller.begin(bus.micros(), data, config);
+ * while (!poller.poll(bus))
+ *     receiveSerial();
+ */
+class WriteCyclePoller {
+
+public:
+
+    WriteCyclePoller() : state(WRITE_CYCLE_POLLER_IDLE), data(0), previous(0), methods(WRITE_CYCLE_FIXED_DELAY), timeoutUs(0), fallbackUs(0), startUs(0) {
+        result.completed = false;
+        result.elapsedUs = 0;
+        result.polls = 0;
+    }
+
+    /**
+     * Starts waiting for the write cycle of the @param data, which began at @param nowUs.
+     */
+    void begin(const uint32_t& nowUs, const uint8_t& data, const WriteCycleConfig& config) {
+
+        this->data = data;
+        methods = config.methods;
+        timeoutUs = config.timeoutUs;
+        fallbackUs = (uint32_t) config.fallbackDelayMs * 1000;
+        startUs = nowUs;
+        result.completed = false;
+        result.elapsedUs = 0;
+        result.polls = 0;
+
+        state = methods == WRITE_CYCLE_FIXED_DELAY ? WRITE_CYCLE_POLLER_FALLBACK : WRITE_CYCLE_POLLER_FIRST_READ;
+    }
+
+    /**
+     * @return True when the write cycle is over (also when the poller is idle). The details are in getResult().
+     */
+    template<typename Bus>
+    bool poll(Bus& bus) {
+
+        switch (state) {
+
+            case WRITE_CYCLE_POLLER_IDLE:
+                return true;
+
+            case WRITE_CYCLE_POLLER_FIRST_READ:
+                previous = bus.readData();
+                result.polls++;
+                state = WRITE_CYCLE_POLLER_POLLING;
+                return false;
+
+            case WRITE_CYCLE_POLLER_POLLING: {
+                uint8_t current = bus.readData();
+                result.polls++;
+                result.elapsedUs = bus.micros() - startUs;
+
+                if (isWriteCycleDone(current, previous, data, methods)) {
+                    current = bus.readData();
+                    result.polls++;
+
+                    if (current == data) {
+                        result.completed = true;
+                        state = WRITE_CYCLE_POLLER_IDLE;
+                        return true;
+                    }
+                }
+
+                previous = current;
+
+                if (result.elapsedUs >= timeoutUs) {
+                    startUs += result.elapsedUs;
+                    state = WRITE_CYCLE_POLLER_FALLBACK;
+                }
+
+                return false;
+            }
+
+            case WRITE_CYCLE_POLLER_FALLBACK:
+                if (bus.micros() - startUs < fallbackUs)
+                    return false;
+
+                state = WRITE_CYCLE_POLLER_IDLE;
+                return true;
+        }
+
+        return true;
+    }
+
+    bool isBusy() const {
+        return state != WRITE_CYCLE_POLLER_IDLE;
+    }
+
+    const WriteCycleResult& getResult() const {
+        return result;
+    }
+
+private:
+
+    uint8_t state;
+    uint8_t data;
+    uint8_t previous;
+    uint8_t methods;
+    uint32_t timeoutUs;
+    uint32_t fallbackUs;
+    uint32_t startUs;
+    WriteCycleResult result;
+};
+
+#endif
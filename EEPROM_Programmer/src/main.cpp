@@ -1,4 +1,16 @@
 #include <Arduino.h>
+#include <WriteCycle.h>
+#include <DataBus.h>
+#include <ArduinoHAL.h>
+#include <ShiftRegister.h>
+#include <EEPROMProgrammer.h>
+#include <TracingHAL.h>
+#include <ProfilingHAL.h>
+#include <SerialSession.h>
+#include <IntelHex.h>
+#include <Microcode.h>
+#include <DisplayDecoder.h>
+#include <Scheduler.h>
 
 /**
  * We need to control a EEPROM (AT28C16), which has total of 21 pins:
@@ -16,271 +28,395 @@
  * that doesn't require timing.
  */
 
+/**
+ * CHIP_28C16, CHIP_28C64 or CHIP_28C256. See ChipProfile.h
+ * The bigger chips use more outputs of the shift registers for the address and OE moves above it.
+ */
+#define EEPROM_CHIP CHIP_28C16
+
 #define EEPROM_IO_START_PIN 5
 #define EEPROM_IO_END_PIN 12
 #define EEPROM_WE_PIN 13
 
+/**
+ * If enabled a second chip sits next to the first one on the same address and data bus (the second socket in EEPROMProgrammer.h).
+ * Its WE is on EEPROM_SECOND_WE_PIN (14 is A0) and its OE on the EEPROM_SECOND_OE_BIT output of the shift registers, above the first chip's OE.
+ * Then both halves of the microcode are programmed in a single pass (programMicrocodeEEPROMPair()).
+ */
+#define DUAL_SOCKET false
+#define EEPROM_SECOND_WE_PIN 14
+#define EEPROM_SECOND_OE_BIT 12
+
 #define SHIFT_REGISTER_SER_PIN 2
 #define SHIFT_REGISTER_RCLK_PIN 3
 #define SHIFT_REGISTER_SR_CLK_PIN 4
+#define SHIFT_REGISTER_CHAIN_LENGTH 2
 
-#define BAUD_RATE 9600
+/**
+ * SHIFT_REGISTER_BIT_BANG works with the current wiring (SER, RCLK, SRCLK on pins 2, 3, 4).
+ * SHIFT_REGISTER_HARDWARE_SPI is a lot faster, but SER must be moved to pin 11 (MOSI) and SRCLK to pin 13 (SCK).
+ * Pins 11 - 13 are taken by the SPI peripheral, thus the data bus and WE must be moved from them first.
+ * Pin 10 (SS) must stay an OUTPUT or the peripheral falls into slave mode. The data bus is an INPUT during reads, so it can't use it either.
+ */
+#define SHIFT_REGISTER_MODE SHIFT_REGISTER_BIT_BANG
+#define SHIFT_REGISTER_SPI_CLOCK 8000000
 
-#define MS 1
-#define US 2
+#if DUAL_SOCKET
+static_assert(EEPROM_SECOND_OE_BIT < 8 * SHIFT_REGISTER_CHAIN_LENGTH && EEPROM_SECOND_OE_BIT != EEPROM_CHIP.outputEnableBit &&
+              EEPROM_SECOND_OE_BIT >= EEPROM_CHIP.addressBits, "The second OE must be a free output of the shift registers");
+#endif
+
+#if SHIFT_REGISTER_MODE == SHIFT_REGISTER_HARDWARE_SPI && ((EEPROM_IO_START_PIN <= 13 && EEPROM_IO_END_PIN >= 10) || (EEPROM_WE_PIN >= 11 && EEPROM_WE_PIN <= 13))
+#error "The hardware SPI uses pins 11 - 13 and SS (pin 10) must stay an output. Move the EEPROM's data bus and WE pin before enabling it."
+#endif
+
+static_assert(SHIFT_REGISTER_CHAIN_LENGTH <= SHIFT_REGISTER_MAX_CHAIN_LENGTH, "The programmer shifts the address as a single uint32_t word");
+
+/**
+ * The serial link is used for the text logs and for the binary protocol (SerialProtocol.h) with the host tools.
+ * 1 Mbaud is exact with the Nano's 16 MHz clock.
+ */
+#define BAUD_RATE 1000000
+
+/**
+ * If enabled the hardcoded program in setup() is burned on each start of the programmer.
+ * ! Opening the serial port resets the Arduino Nano, so each run of a host tool starts the programming again.
+ * Disable it when the images are uploaded from the host, for example several chips at once with eeprom_batch.
+ */
+#define PROGRAM_ON_BOOT true
+
+/**
+ * Instead of always waiting the worst case write time, we detect the end of the EEPROM's write cycle by reading the data bus.
+ * If the chip doesn't answer with the written data in WRITE_CYCLE_TIMEOUT_US we fall back to the old fixed delay.
+ * The timeout is twice the tWC of the 28C256 and the delay covers its tWC plus tBLC (the page is written after it).
+ */
+#define WRITE_CYCLE_METHODS (WRITE_CYCLE_DATA_POLLING | WRITE_CYCLE_TOGGLE_BIT)
+#define WRITE_CYCLE_TIMEOUT_US 20000
+#define WRITE_CYCLE_FALLBACK_DELAY_MS 11
+
+/**
+ * The loop()'s tasks (see the scheduler below). The serial port is drained at least that often.
+ */
+#define SCHEDULER_TASKS 2
+#define SERIAL_RECEIVE_INTERVAL_US 200
+
+/**
+ * PROGRAMMING_FULL or PROGRAMMING_DIFFERENTIAL. See EEPROMProgrammer.h
+ */
+#define PROGRAMMING_MODE PROGRAMMING_DIFFERENTIAL
+
+/**
+ * If enabled the microcode's fingerprint (ImageFingerprint.h) is stored on the chip after it is programmed.
+ * A chip, which already has the same fingerprint and content, is only read back instead of programmed again.
+ */
+#define IMAGE_FINGERPRINT true
+
+/**
+ * Ids of the images in the flash, which the host can verify a chip against (VERIFY in SerialProtocol.h).
+ */
+#define VERIFY_IMAGE_FIRST_MICROCODE 1
+#define VERIFY_IMAGE_SECOND_MICROCODE 2
+
+/**
+ * If enabled the transitions of SER, SRCLK, RCLK, WE, OE and the data bus are recorded in a ring buffer (PinTrace.h).
+ * The host downloads it with trace_download, which saves a VCD file and checks the EEPROM's timing.
+ * Each event takes 4 bytes of RAM and some cycles, so keep it disabled when not needed.
+ */
+#define PIN_TRACE false
+#define PIN_TRACE_LENGTH 128
+
+/**
+ * If enabled the time of each operation (shift, latch, data bus, write cycle, serial) is counted with min/avg/max (PerfCounters.h).
+ * The host reads them with perf_stats, the same as board_benchmark --perf prints for the simulated board.
+ * Costs ~170 bytes of RAM and some cycles per operation.
+ */
+#define PERF_COUNTERS false
 
 #define DECIMAL 10
 #define HEX 16
 #define BINARY 2
 
 /**
- * Because, we have many control signals we can't use a single EEPROM.
- * ! Single EEPROM have only 8 outputs, which can't cover all signals and thus we can't active them.
- * That means we must use 2 EEPROMs and program them separately. For the same address program first half and then the second.
- * For easier programming the eeproms, instead of each time making the bits for a given microinstruction we can pre-define where the bits for a given
- * control signal to be activated need to be and the using bitwise operators create the final control signals for single microinstruction.
+ * Formats for dumping whole ranges with printEEPROMAddress(from, to, format).
+ * RAW_BINARY - The bytes as they are. INTEL_HEX - Intel HEX records with checksums.
  */
+#define RAW_BINARY 1
+#define INTEL_HEX 3
 
-//First EEPROM
-#define HLT_CS 0b10000000
-#define MI_CS 0b01000000
-#define RI_CS 0b00100000
-#define RO_CS 0b00010000
-#define IO_CS 0b00001000
-#define II_CS 0b00000100
-#define AI_CS 0b00000010
-#define AO_CS 0b00000001
-
-//Second EEPROM
-#define EO_CS  0b10000000
-#define SU_CS  0b01000000
-#define BI_CS  0b00100000
-#define OI_CS  0b00010000
-#define CE_CS  0b00001000
-#define CO_CS  0b00000100
-#define J_CS   0b00000010
-
-const uint8_t LDA_INSTRUCTION_CODE = 0b0000;
-const uint8_t LDB_INSTRUCTION_CODE = 0b0001;
-const uint8_t ADD_INSTRUCTION_CODE = 0b0010;
-const uint8_t SUB_INSTRUCTION_CODE = 0b0011;
-const uint8_t STA_INSTRUCTION_CODE = 0b0100;
-const uint8_t LDI_INSTRUCTION_CODE = 0b0101;
-const uint8_t JMP_INSTRUCTION_CODE = 0b0110;
-const uint8_t OUT_INSTRUCTION_CODE = 0b0111;
-const uint8_t HLT_INSTRUCTION_CODE = 0b1000;
+#define DUMP_CHUNK_LENGTH 32
 
 /**
- * Each index corresponds to the digit.
- * Index 0 = Digit 0
- * Index 1 = Digit 9
- * Up to Index 9.
- *
- * (7) HIGH, LOW, LOW, HIGH, HIGH, LOW, LOW = 0b00110010
- * (8) HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH = 0b11111110
- * (9) HIGH, LOW, LOW, HIGH, HIGH, HIGH, HIGH = 0b11110010
+ * On the ATmega328 (Arduino Nano) the data bus is moved directly through the PORTD/PORTB registers if it is on pins 5 - 12. See DataBus.h
+ * On other boards (or other wiring) each pin is written on its own.
  */
-byte segmentDisplayMappingDigits[10] = {0b01111110, 0b00010010, 0b10111100, 0b10110110, 0b11010010, 0b11100110, 0b11101110, 0b00110010, 0b11111110, 0b11110010};
+ArduinoHAL arduinoHAL(EEPROM_IO_START_PIN, EEPROM_IO_END_PIN);
 
-/**
- * Index 0 = NOTHING
- * Index 1 = -
- */
-byte segmentDisplayCharacterMapping[2] = {0b00000000, 0b10000000};
+#if PERF_COUNTERS
+typedef ProfilingHAL<ArduinoHAL> BoardHAL;
+
+PerfCounters perfCounters;
+BoardHAL boardHAL(arduinoHAL, perfCounters, F_CPU);
+#else
+typedef ArduinoHAL BoardHAL;
+
+BoardHAL& boardHAL = arduinoHAL;
+#endif
+
+#if PIN_TRACE
+typedef TracingHAL<BoardHAL, PinTraceBuffer<PIN_TRACE_LENGTH> > ProgrammerHAL;
 
-void digitalWriteBetween(const unsigned int& startPin, const unsigned int& endPin, const unsigned int& value);
+PinTraceBuffer<PIN_TRACE_LENGTH> pinTrace;
+ProgrammerHAL hal(boardHAL, pinTrace, SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN, EEPROM_WE_PIN,
+                  EEPROM_CHIP.outputEnableBit);
+#else
+typedef BoardHAL ProgrammerHAL;
 
-unsigned int digitalReadBetween(const unsigned int& startPin, const unsigned int& endPin);
+ProgrammerHAL& hal = boardHAL;
+#endif
 
-void delay(const unsigned int& timeValue, const int& timeUnit);
+#if SHIFT_REGISTER_MODE == SHIFT_REGISTER_HARDWARE_SPI
+ShiftRegister<ProgrammerHAL> shiftRegister(hal, SHIFT_REGISTER_RCLK_PIN, SHIFT_REGISTER_CHAIN_LENGTH, SHIFT_REGISTER_SPI_CLOCK);
+#else
+ShiftRegister<ProgrammerHAL> shiftRegister(hal, SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, SHIFT_REGISTER_RCLK_PIN, SHIFT_REGISTER_CHAIN_LENGTH);
+#endif
 
-void clockPin(const uint8_t& pin, const bool& val, const unsigned int& timeValue, const int& timeUnit);
+WriteCycleConfig writeCycleConfig = {WRITE_CYCLE_METHODS, WRITE_CYCLE_TIMEOUT_US, WRITE_CYCLE_FALLBACK_DELAY_MS};
 
-void clockPin(const uint8_t& pin, const bool& val);
+EEPROMProgrammer<ProgrammerHAL> programmer(hal, shiftRegister, EEPROM_WE_PIN, writeCycleConfig, PROGRAMMING_MODE, EEPROM_CHIP);
 
-template<size_t N>
-void pinModes(int (& pins)[N], const bool& mode);
+/**
+ * The expected data of verifyEEPROMRange() from an image in the flash.
+ */
+struct ProgmemImage {
+    const uint8_t* data;
 
-void setShiftRegisterBits(const uint16_t& bits, const uint8_t& bitOrder = MSBFIRST);
+    uint8_t operator()(const uint16_t& address) const {
+        return pgm_read_byte(data + address);
+    }
+};
 
-void setEEPROMPins(const uint16_t& address, const bool& outputEnable, const uint8_t& bitOrder = MSBFIRST);
+void printEEPROMAddressBinary(const uint16_t& address, const uint8_t& addressData);
 
-uint8_t readEEPROMAddress(const uint16_t& address);
+void printEEPROMAddressDecimal(const uint16_t& address, const uint8_t& addressData);
 
-void printEEPROMAddressBinary(const uint16_t& address);
+void printEEPROMAddressHex(const uint16_t& address, const uint8_t& addressData);
 
-void printEEPROMAddressDecimal(const uint16_t& address);
+void printEEPROMData(const uint16_t& address, const uint8_t& data, const uint8_t& format);
 
-void printEEPROMAddressHex(const uint16_t& address);
+void printEEPROMIntelHex(const uint16_t& from, const uint16_t& to);
 
 void printEEPROMAddress(const uint16_t& address, const uint8_t& format);
 
 void printEEPROMAddress(const uint16_t& from, const uint16_t& to, const uint8_t& format);
 
-void setEEPROMAddressData(const uint16_t& address, const uint8_t& data, const uint8_t& bitOrder = MSBFIRST);
+void printProgrammingStats();
 
 void programEEPROM3BitsSegmentDecoder();
 
 void programEEPROM8BitsSegmentDecoder();
 
-uint16_t generateMicroinstructionAddress(const uint8_t& step, const uint8_t& instruction);
+void programImageEEPROM(const uint8_t* image, const uint16_t& size);
 
-/*
-*
-* Address:
-* A0/3 Instruction (4 bits)
-* A4/6: Microinstruction (3 bits)
-* A7/11: Nothing Yet (5 bits all 0)
-*
-* Data:
-* First EEPROM: HLT, MI, RI, RO, IO, II, AI, AO
-* Second EEPROM: EO, SU, BI, OI, CE, CO, J, NOTHING (0)
- *
- * Example:
- *
- * Instruction | N Microinstruction | Activate Control Signals (HLT, MI, RI, RO, IO ... J)
- *
- * 0001             000                 0100000000000010
- * 0001             001                 0001010000000100
- * 0001             010                 0100100000000000
- * 0001             011                 0001001000000000
- *
- * 0b00000{Microinstruction 3 bits}{Instruction 4 Bits}
- * 0b00000{Step 3 bits}{Code 4 Bits}
- * */
-void programFirstEEPROM() {
+void programMicrocodeEEPROM(const uint8_t* image, const ImageFingerprint& fingerprint);
+
+void programMicrocodeEEPROMPair();
 
-    setEEPROMAddressData(generateMicroinstructionAddress(0, LDA_INSTRUCTION_CODE), MI_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, LDA_INSTRUCTION_CODE), RO_CS | II_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, LDA_INSTRUCTION_CODE), MI_CS | IO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, LDA_INSTRUCTION_CODE), RO_CS | AI_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, LDA_INSTRUCTION_CODE), 0);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, LDB_INSTRUCTION_CODE), MI_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, LDB_INSTRUCTION_CODE), RO_CS | II_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, LDB_INSTRUCTION_CODE), MI_CS | IO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, LDB_INSTRUCTION_CODE), RO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, LDB_INSTRUCTION_CODE), 0);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, ADD_INSTRUCTION_CODE), MI_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, ADD_INSTRUCTION_CODE), RO_CS | II_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, ADD_INSTRUCTION_CODE), MI_CS | IO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, ADD_INSTRUCTION_CODE), RI_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, ADD_INSTRUCTION_CODE), 0);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, SUB_INSTRUCTION_CODE), MI_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, SUB_INSTRUCTION_CODE), RO_CS | II_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, SUB_INSTRUCTION_CODE), MI_CS | IO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, SUB_INSTRUCTION_CODE), RO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, SUB_INSTRUCTION_CODE), AI_CS);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, STA_INSTRUCTION_CODE), MI_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, STA_INSTRUCTION_CODE), RO_CS | II_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, STA_INSTRUCTION_CODE), MI_CS | IO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, STA_INSTRUCTION_CODE), RI_CS | AO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, STA_INSTRUCTION_CODE), 0);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, LDI_INSTRUCTION_CODE), MI_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, LDI_INSTRUCTION_CODE), RO_CS | II_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, LDI_INSTRUCTION_CODE), IO_CS | AI_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, LDI_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, LDI_INSTRUCTION_CODE), 0);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, JMP_INSTRUCTION_CODE), MI_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, JMP_INSTRUCTION_CODE), RO_CS | II_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, JMP_INSTRUCTION_CODE), IO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, JMP_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, JMP_INSTRUCTION_CODE), 0);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, OUT_INSTRUCTION_CODE), MI_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, OUT_INSTRUCTION_CODE), RO_CS | II_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, OUT_INSTRUCTION_CODE), AO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, OUT_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, OUT_INSTRUCTION_CODE), 0);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, HLT_INSTRUCTION_CODE), MI_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, HLT_INSTRUCTION_CODE), RO_CS | II_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, HLT_INSTRUCTION_CODE), HLT_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, HLT_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, HLT_INSTRUCTION_CODE), 0);
+uint16_t verifyMicrocodeEEPROM(const uint8_t* image, const uint16_t& size);
+
+uint16_t programPackedEEPROM(const uint8_t* packed, const uint16_t& packedLength);
+
+/**
+ * Computed at compile time together with the images.
+ */
+constexpr ImageFingerprint FIRST_MICROCODE_FINGERPRINT = {MICROCODE_IMAGE_SIZE, microcodeFingerprint(false)};
+constexpr ImageFingerprint SECOND_MICROCODE_FINGERPRINT = {MICROCODE_IMAGE_SIZE, microcodeFingerprint(true)};
+
+static_assert(MICROCODE_IMAGE_SIZE <= imageFingerprintAddress(EEPROM_CHIP), "The fingerprint must not overlap the image");
+
+void programFirstEEPROM() {
+    programMicrocodeEEPROM(MicrocodeImage::first, FIRST_MICROCODE_FINGERPRINT);
 }
 
 void programSecondEEPROM() {
+    programMicrocodeEEPROM(MicrocodeImage::second, SECOND_MICROCODE_FINGERPRINT);
+}
+
+/**
+ * Connects the SerialSession (the host's uploads) to the Serial and the EEPROM.
+ */
+struct SerialDevice {
+
+    int available() {
+        return Serial.available();
+    }
+
+    int read() {
+        return Serial.read();
+    }
+
+    void write(const uint8_t* bytes, const uint8_t& length) {
+        hal.beginOperation(PERF_SERIAL);
+        Serial.write(bytes, length);
+        hal.endOperation(PERF_SERIAL);
+    }
+
+    uint32_t millis() {
+        return ::millis();
+    }
+
+    uint8_t startBytes(const uint16_t& address, const uint8_t* data, const uint8_t& length) {
+        return programmer.startEEPROMBytes(address, data, length);
+    }
+
+    bool pollBytes(uint8_t* results) {
+        return programmer.pollEEPROMBytes(results);
+    }
+
+    void prepareBytes(const uint16_t& address) {
+        programmer.prepareEEPROMBytes(address);
+    }
+
+    void readBytes(const uint16_t& address, uint8_t* buffer, const uint8_t& length) {
+        programmer.readEEPROMRange(address, buffer, length);
+    }
+
+    uint16_t verifyImageSize(const uint8_t& image) {
+        return image == VERIFY_IMAGE_FIRST_MICROCODE || image == VERIFY_IMAGE_SECOND_MICROCODE ? MICROCODE_IMAGE_SIZE : 0;
+    }
+
+    uint16_t verifyBytes(const uint8_t& image, const uint16_t& address, const uint16_t& length, uint8_t* bitmap, uint32_t& crc) {
+
+        if (image == VERIFY_IMAGE_NONE) {
+            crc = programmer.crc32EEPROMRange(address, length, crc);
+            return 0;
+        }
+
+        ProgmemImage expected = {image == VERIFY_IMAGE_FIRST_MICROCODE ? MicrocodeImage::first : MicrocodeImage::second};
+        return programmer.verifyEEPROMRange(address, length, expected, bitmap, crc);
+    }
+
+#if PIN_TRACE
+    uint16_t traceLength() {
+        return pinTrace.getCount();
+    }
+
+    uint32_t traceOverwritten() {
+        return pinTrace.getOverwritten();
+    }
+
+    void readTraceEvent(const uint16_t& index, uint8_t* out) {
+        encodePinTraceEvent(pinTrace.get(index), out);
+    }
+
+    void clearTrace() {
+        pinTrace.clear();
+    }
+#else
+    uint16_t traceLength() {
+        return 0;
+    }
+
+    uint32_t traceOverwritten() {
+        return 0;
+    }
+
+    void readTraceEvent(const uint16_t& index, uint8_t* out) {
+    }
+
+    void clearTrace() {
+    }
+#endif
+
+#if PERF_COUNTERS
+    uint8_t perfOperations() {
+        return PERF_OPERATIONS;
+    }
+
+    void readPerfCounter(const uint8_t& operation, uint8_t* out) {
+        encodePerfCounter(perfCounters.get(operation), out);
+    }
+
+    void clearPerfCounters() {
+        perfCounters.clear();
+    }
+#else
+    uint8_t perfOperations() {
+        return 0;
+    }
+
+    void readPerfCounter(const uint8_t& operation, uint8_t* out) {
+    }
+
+    void clearPerfCounters() {
+    }
+#endif
 
-    setEEPROMAddressData(generateMicroinstructionAddress(0, LDA_INSTRUCTION_CODE), CO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, LDA_INSTRUCTION_CODE), CE_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, LDA_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, LDA_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, LDA_INSTRUCTION_CODE), 0);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, LDB_INSTRUCTION_CODE), CO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, LDB_INSTRUCTION_CODE), CE_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, LDB_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, LDB_INSTRUCTION_CODE), BI_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, LDB_INSTRUCTION_CODE), 0);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, ADD_INSTRUCTION_CODE), CO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, ADD_INSTRUCTION_CODE), CE_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, ADD_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, ADD_INSTRUCTION_CODE), EO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, ADD_INSTRUCTION_CODE), 0);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, SUB_INSTRUCTION_CODE), CO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, SUB_INSTRUCTION_CODE), CE_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, SUB_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, SUB_INSTRUCTION_CODE), EO_CS | SU_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, SUB_INSTRUCTION_CODE), 0);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, STA_INSTRUCTION_CODE), CO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, STA_INSTRUCTION_CODE), CE_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, STA_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, STA_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, STA_INSTRUCTION_CODE), 0);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, LDI_INSTRUCTION_CODE), CO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, LDI_INSTRUCTION_CODE), CE_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, LDI_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, LDI_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, LDI_INSTRUCTION_CODE), 0);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, JMP_INSTRUCTION_CODE), CO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, JMP_INSTRUCTION_CODE), CE_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, JMP_INSTRUCTION_CODE), J_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, JMP_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, JMP_INSTRUCTION_CODE), 0);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, OUT_INSTRUCTION_CODE), CO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, OUT_INSTRUCTION_CODE), CE_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, OUT_INSTRUCTION_CODE), OI_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, OUT_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, OUT_INSTRUCTION_CODE), 0);
-
-    setEEPROMAddressData(generateMicroinstructionAddress(0, HLT_INSTRUCTION_CODE), CO_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(1, HLT_INSTRUCTION_CODE), CE_CS);
-    setEEPROMAddressData(generateMicroinstructionAddress(2, HLT_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(3, HLT_INSTRUCTION_CODE), 0);
-    setEEPROMAddressData(generateMicroinstructionAddress(4, HLT_INSTRUCTION_CODE), 0);
+    uint32_t perfClockHz() {
+        return F_CPU;
+    }
+};
+
+SerialDevice serialDevice;
+SerialSession<SerialDevice> serialSession(serialDevice);
+
+/**
+ * The loop() runs two tasks (Scheduler.h). None of them waits for the EEPROM:
+ * - The serial port is drained every SERIAL_RECEIVE_INTERVAL_US. At 1 Mbaud the 64 byte receive buffer fills in ~640us.
+ * - The upload is programmed on every pass of the loop() while there are buffered bytes. Each pass polls the write cycle once,
+ *   so the next bytes start right after it. In between the frames are received and decoded.
+ */
+Scheduler<SCHEDULER_TASKS> scheduler;
+
+uint32_t receiveSerialTask(void* context) {
+    serialSession.receive();
+    return SERIAL_RECEIVE_INTERVAL_US;
+}
+
+uint32_t programTask(void* context) {
+    serialSession.program();
+    return serialSession.isProgramming() ? 0 : SERIAL_RECEIVE_INTERVAL_US;
 }
 
 void setup() {
     Serial.begin(BAUD_RATE);
     Serial.println("EEPROM Start!");
 
-    digitalWrite(EEPROM_WE_PIN, HIGH);
+#if PERF_COUNTERS
+    boardHAL.begin();
+#endif
 
-    int outputPins[4] = {EEPROM_WE_PIN, SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_RCLK_PIN, SHIFT_REGISTER_SR_CLK_PIN};
-    pinModes(outputPins, OUTPUT);
+#if PIN_TRACE
+    hal.begin();
+#endif
 
+    if (DUAL_SOCKET)
+        programmer.setSecondSocket(EEPROM_SECOND_WE_PIN, EEPROM_SECOND_OE_BIT);
 
+    programmer.begin();
 
-    Serial.println("Started programming!");
-    //programFirstEEPROM();
-    programSecondEEPROM();
-    Serial.println("Finished programming!");
+    if (PROGRAM_ON_BOOT) {
+        Serial.println("Started programming!");
+        programmer.beginProgramming();
+
+        if (DUAL_SOCKET) {
+            programMicrocodeEEPROMPair();
+        } else {
+            //programFirstEEPROM();
+            programSecondEEPROM();
+        }
+
+        Serial.println("Finished programming!");
+        printProgrammingStats();
+    }
+
+    Serial.println("Waiting for the host.");
+
+    scheduler.add(receiveSerialTask, 0, micros());
+    scheduler.add(programTask, 0, micros());
 }
 
 void loop() {
-
+    scheduler.runDue(micros());
 }
 
 /*
@@ -292,283 +428,307 @@ void loop() {
  * 0111 1111 = 127
  * */
 
+/**
+ * The display decoder of the output register with all display modes (DisplayDecoder.h). The image is computed at compile time,
+ * so it is only copied a page at a time. The 28C16 gets the first two modes (signed and unsigned).
+ */
 void programEEPROM8BitsSegmentDecoder() {
+    Serial.println("Programming EEPROM as decoder for 8 bit to display decoder.");
+    programImageEEPROM(DisplayDecoderImage::image, DISPLAY_DECODER_IMAGE_SIZE < chipSize(programmer.getChip()) ? DISPLAY_DECODER_IMAGE_SIZE :
+                                                                                                                 chipSize(programmer.getChip()));
+    Serial.println("Programmed EEPROM as decoder for 8 bit to display decoder.");
+}
 
-    for (int programNumber = -128; programNumber <= 127; ++programNumber) {
+/**
+ * The digits 0 - 7 at the addresses 0 - 7.
+ */
+void programEEPROM3BitsSegmentDecoder() {
+    Serial.println("Programming EEPROM as decoder for 3 bit to display decoder.");
 
-        bool isPositive = programNumber >= 0;
+    for (uint16_t address = 0; address < 8;)
+        address += programmer.programEEPROMBytes(address, DISPLAY_SEGMENTS + address, 8 - address);
 
-        /**
-         * Example:
-         * programNumber = -103 = 0b10011001 (Two's Complement)
-         * The (0b10 << 8) | programNumberConverted will not work. The result will still be 0b10011001 instead of 0b1010011001
-         * Looks like the number must be 0b10011001, but positive to work the shifting.
-         * That means 0b10011001 = 153
-         * To keep the bits, but turn it into positive just move it to uint8_t. That way the shifting will work as expected.
-         */
-        uint8_t programNumberConverted = programNumber;
+    Serial.println("Programmed EEPROM as decoder for 3 bit to display decoder.");
 
-        int combination0Address = (0b00 << 8) | programNumberConverted;
-        int combination1Address = (0b10 << 8) | programNumberConverted;
-        int combination2Address = (0b01 << 8) | programNumberConverted;
-        int combination3Address = (0b11 << 8) | programNumberConverted;
+    //printEEPROMAddress(0, 7, BINARY);
+}
 
-        int programNumberPositive = abs(programNumber);
-        int onesDigit = programNumberPositive % 10;
-        int secondDigit = (programNumberPositive / 10) % 10;
-        int thirdDigit = (programNumberPositive / 100) % 10;
+/**
+ * Programs the first @param size bytes of the @param image in the flash from address 0.
+ * The image is copied from the flash a page at a time, so on chips with page write each page takes a single write cycle.
+ */
+void programImageEEPROM(const uint8_t* image, const uint16_t& size) {
 
-        setEEPROMAddressData(combination0Address, segmentDisplayMappingDigits[thirdDigit]);
-        setEEPROMAddressData(combination1Address, segmentDisplayMappingDigits[secondDigit]);
-        setEEPROMAddressData(combination2Address, segmentDisplayMappingDigits[onesDigit]);
-        setEEPROMAddressData(combination3Address, isPositive ? segmentDisplayCharacterMapping[0] : segmentDisplayCharacterMapping[1]);
-    }
-}
+    uint8_t page[EEPROM_MAX_PAGE_SIZE];
 
-void programEEPROM3BitsSegmentDecoder() {
-    Serial.println("Programming EEPROM as decoder for 3 bit to display decoder.");
-    setEEPROMAddressData(0, 0b01111110);
-    setEEPROMAddressData(1, 0b00010010);
-    setEEPROMAddressData(2, 0b10111100);
-    setEEPROMAddressData(3, 0b10110110);
-    setEEPROMAddressData(4, 0b11010010);
-    setEEPROMAddressData(5, 0b11100110);
-    setEEPROMAddressData(6, 0b11101110);
-    setEEPROMAddressData(7, 0b00110010);
-    Serial.println("Programmed EEPROM as decoder for 3 bit to display decoder.");
+    for (uint16_t address = 0; address < size;) {
+        uint8_t length = bytesToPageEnd(programmer.getChip(), address);
 
-    //printEEPROMAddress(0, 7, BINARY);
+        if (length > size - address)
+            length = size - address;
+
+        for (uint8_t i = 0; i < length; ++i)
+            page[i] = pgm_read_byte(image + address + i);
+
+        address += programmer.programEEPROMBytes(address, page, length);
+    }
 }
 
 /**
- * Example:
- * Let's say we have the OUT instruction.
- * The OUT instruction unique code (4 bit) is 0110.
- * The OUT instruction needs 5 total microinstruction.
- *       EEPROM Addr. |  Control Signals
- * 0:  0b000000000110      0b01000000
- * 1:  0b000000010110      0b00010100
- * 2:  0b000000100110      0b00000001
- * 3:  0b000000110110      0b00000000
- * 4:  0b000001000110      0b00000000
- *
- * Where EEPROM Address's patter is the following:
- * 0b00000{N Microinstruction (3 bits)}{Instruction (4 Bits)}
+ * Programs the whole @param image (the microcode of one of the EEPROMs, see Microcode.h) from the flash.
+ * All control words are computed at compile time, thus the loop only reads the next byte and writes it (programImageEEPROM()).
  *
- * Instead of programming the eeprom the hard way and getting lost while writing the bits for each instruction's microinstructions:
- *  setEEPROMAddressData(0b000000000110, 0b01000000); //Microinstruction: 1;
- *  setEEPROMAddressData(0b000000010110, 0b00010100); //Microinstruction: 2;
- *  setEEPROMAddressData(0b000000100110, 0b00000001); //Microinstruction: 3;
- *  setEEPROMAddressData(0b000000110110, 0b00000000); //Microinstruction: 4;
- *  setEEPROMAddressData(0b000001000110, 0b00000000); //Microinstruction: 5;
- * You can use that method to easily generate them and not get lost in the bits:
- *  setEEPROMAddressData(generateMicroinstructionAddress(0, OUT_INSTRUCTION_CODE), 0b01000000); //Microinstruction: 1;
- *  setEEPROMAddressData(generateMicroinstructionAddress(1, OUT_INSTRUCTION_CODE), 0b00010100); //Microinstruction: 2;
- *  setEEPROMAddressData(generateMicroinstructionAddress(2, OUT_INSTRUCTION_CODE), 0b00000001); //Microinstruction: 3;
- *  setEEPROMAddressData(generateMicroinstructionAddress(3, OUT_INSTRUCTION_CODE), 0b00000000); //Microinstruction: 4;
- *  setEEPROMAddressData(generateMicroinstructionAddress(4, OUT_INSTRUCTION_CODE), 0b00000000); //Microinstruction: 5;
- *
- * @param step Which line of instruction is that.
- * @param code The unique code of the instruction
+ * With IMAGE_FINGERPRINT a chip, which already holds the image (@param fingerprint), is only verified.
+ * Otherwise after the programming the whole image is verified again (verifyMicrocodeEEPROM()) and the fingerprint is stored
+ * only if nothing is left wrong.
  */
-uint16_t generateMicroinstructionAddress(const uint8_t& step, const uint8_t& code) {
-    return 0b000000000000 | (step << 4) | code;;
+void programMicrocodeEEPROM(const uint8_t* image, const ImageFingerprint& fingerprint) {
+
+    if (IMAGE_FINGERPRINT && programmer.isImageCurrent(fingerprint)) {
+        Serial.println("The fingerprint and the checksum match, the EEPROM is up to date.");
+        return;
+    }
+
+    uint16_t size = fingerprint.size;
+    programImageEEPROM(image, size);
+
+    if (verifyMicrocodeEEPROM(image, size) == 0 && IMAGE_FINGERPRINT && !programmer.programImageFingerprint(fingerprint))
+        Serial.println("The fingerprint can't be stored.");
 }
 
 /**
- * Will shift the bits to the 74HC595 shift register.
- * We are using the Arduino's prebuild shift out function, but it is limited to shifting only 8 bits at a time.
- * Thus we use it twice.
- * The prebuild function will place each of the provided bits on the SER_PIN and clock the SR_CLK pin, which will store them.
- * The shift register has two storages. Shift and Storage Register. The outputed bits from it are from the Storage Register.
- * After storing the 16 bits in the shift register we clock the RCLK_PIN, which moves the stored bits in the Shift Register to the Storage Register.
+ * Programs an image packed by the host (PackedImage.h) from the flash, for example the arrays of microcode_report --save-packed:
+ * programPackedEEPROM(PackedMicrocode::first, PackedMicrocode::firstLength);
+ * The records are expanded a page at a time straight into programEEPROMBytes(), so the image is never whole in the RAM
+ * and the skipped addresses are not touched at all.
+ * @return The number of the bytes, which failed.
  */
-void setShiftRegisterBits(const uint16_t& bits, const uint8_t& bitOrder) {
-    uint8_t msb = bits >> 8;
-    uint8_t lsb = bits & 0b11111111;
+uint16_t programPackedEEPROM(const uint8_t* packed, const uint16_t& packedLength) {
 
-    shiftOut(SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, bitOrder, msb);
-    shiftOut(SHIFT_REGISTER_SER_PIN, SHIFT_REGISTER_SR_CLK_PIN, bitOrder, lsb);
+    PackedImageReader<ProgmemImage> reader;
+    ProgmemImage source = {packed};
+    uint8_t page[EEPROM_MAX_PAGE_SIZE];
+    uint8_t results[EEPROM_MAX_PAGE_SIZE];
+    uint16_t failed = 0;
+    uint16_t pageAddress;
+    uint8_t length;
 
-    clockPin(SHIFT_REGISTER_RCLK_PIN, HIGH);
+    reader.begin(source, packedLength, 0);
+
+    while ((length = reader.read(pageAddress, page, bytesToPageEnd(programmer.getChip(), reader.getAddress()))) > 0) {
+
+        /**
+         * After a skipped range the bytes may cross a page, then the rest is a second write.
+         */
+        for (uint8_t offset = 0; offset < length;) {
+            uint8_t count = programmer.programEEPROMBytes(pageAddress + offset, page + offset, length - offset, results);
+
+            for (uint8_t i = 0; i < count; ++i)
+                failed += results[i] == PROGRAM_BYTE_FAILED;
+
+            offset += count;
+        }
+    }
+
+    return failed;
 }
 
 /**
- * Sets the address of the EEPROM and if the EEPROM's output will be enabled.
+ * Programs the first half of the microcode in the first socket and the second half in the second one (DUAL_SOCKET).
+ * Each address is set once for both chips and their write cycles overlap, so it takes about as long as programMicrocodeEEPROM() of one chip.
+ * Then each chip is verified and gets its fingerprint like with programMicrocodeEEPROM().
  */
-void setEEPROMPins(const uint16_t& address, const bool& outputEnable, const uint8_t& bitOrder) {
-    uint16_t shiftOutData = (!outputEnable << 11) | address;
+void programMicrocodeEEPROMPair() {
 
-    setShiftRegisterBits(shiftOutData, bitOrder);
-}
+    if (!programmer.hasSecondSocket()) {
+        Serial.println("The second socket isn't enabled (DUAL_SOCKET).");
+        return;
+    }
+
+    if (IMAGE_FINGERPRINT && programmer.isImageCurrent(FIRST_MICROCODE_FINGERPRINT)) {
+        programmer.selectSocket(EEPROM_SOCKET_SECOND);
+        bool current = programmer.isImageCurrent(SECOND_MICROCODE_FINGERPRINT);
+        programmer.selectSocket(EEPROM_SOCKET_FIRST);
+
+        if (current) {
+            Serial.println("The fingerprints and the checksums match, both EEPROMs are up to date.");
+            return;
+        }
+    }
+
+    uint8_t firstPage[EEPROM_MAX_PAGE_SIZE];
+    uint8_t secondPage[EEPROM_MAX_PAGE_SIZE];
 
-uint8_t readEEPROMAddress(const uint16_t& address) {
+    for (uint16_t address = 0; address < MICROCODE_IMAGE_SIZE;) {
+        uint8_t length = bytesToPageEnd(programmer.getChip(), address);
 
-    setEEPROMPins(address, true);
+        if (length > MICROCODE_IMAGE_SIZE - address)
+            length = MICROCODE_IMAGE_SIZE - address;
 
-    return digitalReadBetween(EEPROM_IO_START_PIN, EEPROM_IO_END_PIN);
+        for (uint8_t i = 0; i < length; ++i) {
+            firstPage[i] = pgm_read_byte(MicrocodeImage::first + address + i);
+            secondPage[i] = pgm_read_byte(MicrocodeImage::second + address + i);
+        }
+
+        address += programmer.programEEPROMPairBytes(address, firstPage, secondPage, length);
+    }
+
+    const uint8_t* images[2] = {MicrocodeImage::first, MicrocodeImage::second};
+    const ImageFingerprint* fingerprints[2] = {&FIRST_MICROCODE_FINGERPRINT, &SECOND_MICROCODE_FINGERPRINT};
+
+    for (uint8_t socket = EEPROM_SOCKET_FIRST; socket <= EEPROM_SOCKET_SECOND; ++socket) {
+        programmer.selectSocket(socket);
+
+        if (verifyMicrocodeEEPROM(images[socket], MICROCODE_IMAGE_SIZE) == 0 && IMAGE_FINGERPRINT && !programmer.programImageFingerprint(*fingerprints[socket]))
+            Serial.println("The fingerprint can't be stored.");
+    }
+
+    programmer.selectSocket(EEPROM_SOCKET_FIRST);
 }
 
-void printEEPROMAddressBinary(const uint16_t& address) {
+/**
+ * Reads the whole @param image back in a tight loop (CRC32 and comparison with the flash, nothing is printed on the way)
+ * and rewrites only the mismatching addresses from the bitmap of each block.
+ * @return The mismatches, which are still wrong after the rewrite.
+ */
+uint16_t verifyMicrocodeEEPROM(const uint8_t* image, const uint16_t& size) {
+
+    ProgmemImage expected = {image};
+    uint8_t bitmap[FRAME_VERIFY_MAP_ADDRESSES / 8];
+    uint32_t crc = 0xFFFFFFFF;
+    uint16_t mismatches = 0;
+    uint16_t left = 0;
+
+    for (uint16_t block = 0; block < size; block += FRAME_VERIFY_MAP_ADDRESSES) {
+        uint16_t length = size - block < FRAME_VERIFY_MAP_ADDRESSES ? size - block : FRAME_VERIFY_MAP_ADDRESSES;
+        memset(bitmap, 0, sizeof(bitmap));
+
+        if (programmer.verifyEEPROMRange(block, length, expected, bitmap, crc) == 0)
+            continue;
+
+        for (uint16_t i = 0; i < length; ++i) {
+            if (!(bitmap[i >> 3] & (0x80 >> (i & 7))))
+                continue;
+
+            mismatches++;
 
-    uint8_t addressData = readEEPROMAddress(address);
+            if (programmer.programEEPROMAddressData(block + i, expected(block + i)) == PROGRAM_BYTE_FAILED)
+                left++;
+        }
+    }
+
+    char printBuffer[64];
+    sprintf(printBuffer, "Verified: CRC32 %08lX Mismatches: %u Left: %u", (unsigned long) ~crc, mismatches, left);
+    Serial.println(printBuffer);
+
+    return left;
+}
+
+void printEEPROMAddressBinary(const uint16_t& address, const uint8_t& addressData) {
 
     bool dataBits[8] = {};
 
     for (int i = 0; i < 8; ++i)
         dataBits[i] = (0b1 << (7 - i)) & addressData;
 
-    char printBuffer[34];
-    sprintf(printBuffer, "Address: %d Value: %d %d %d %d %d %d %d %d", address, dataBits[0], dataBits[1], dataBits[2], dataBits[3], dataBits[4], dataBits[5], dataBits[6], dataBits[7]);
+    char printBuffer[40];
+    sprintf(printBuffer, "Address: %u Value: %d %d %d %d %d %d %d %d", address, dataBits[0], dataBits[1], dataBits[2], dataBits[3], dataBits[4], dataBits[5], dataBits[6], dataBits[7]);
     Serial.println(printBuffer);
 }
 
-void printEEPROMAddressDecimal(const uint16_t& address) {
-    uint8_t addressData = readEEPROMAddress(address);
-
-    char printBuffer[20];
-    sprintf(printBuffer, "Address: %d Value: %d", address, addressData);
+void printEEPROMAddressDecimal(const uint16_t& address, const uint8_t& addressData) {
+    char printBuffer[28];
+    sprintf(printBuffer, "Address: %u Value: %d", address, addressData);
     Serial.println(printBuffer);
 }
 
-void printEEPROMAddressHex(const uint16_t& address) {
-    uint8_t addressData = readEEPROMAddress(address);
-
-    char printBuffer[20];
-    sprintf(printBuffer, "Address: %d Value: %X", address, addressData);
+void printEEPROMAddressHex(const uint16_t& address, const uint8_t& addressData) {
+    char printBuffer[28];
+    sprintf(printBuffer, "Address: %u Value: %X", address, addressData);
     Serial.println(printBuffer);
 }
 
-
-void printEEPROMAddress(const uint16_t& address, const uint8_t& format) {
+void printEEPROMData(const uint16_t& address, const uint8_t& data, const uint8_t& format) {
 
     switch (format) {
 
         case BINARY:
-            return printEEPROMAddressBinary(address);
+            return printEEPROMAddressBinary(address, data);
 
         case DECIMAL:
-            return printEEPROMAddressDecimal(address);
+            return printEEPROMAddressDecimal(address, data);
 
         case HEX:
-            return printEEPROMAddressHex(address);
-    }
-
-}
-
-void printEEPROMAddress(const uint16_t& from, const uint16_t& to, const uint8_t& format) {
+            return printEEPROMAddressHex(address, data);
 
-    for (uint16_t address = from; address <= to; ++address) {
-        printEEPROMAddress(address, format);
+        case RAW_BINARY:
+            Serial.write(data);
+            return;
     }
 }
 
-void setEEPROMAddressData(const uint16_t& address, const uint8_t& data, const uint8_t& bitOrder) {
-
-    setEEPROMPins(address, false, bitOrder);
+void printEEPROMAddress(const uint16_t& address, const uint8_t& format) {
 
-    digitalWriteBetween(EEPROM_IO_START_PIN, EEPROM_IO_END_PIN, data);
+    if (format == INTEL_HEX)
+        return printEEPROMIntelHex(address, address);
 
-    clockPin(EEPROM_WE_PIN, LOW, 1, US);
-    delay(10);
+    printEEPROMData(address, programmer.readEEPROMAddress(address), format);
 }
 
-/*---------------- Utils ----------------*/
-
 /**
- * Will read each pin between the given ones and from the bits construct a integer.
- * The function is extremely useful, when you have multiple I/O pins connected sequentially to arduino and you want to read bits from them.
- *
- * Example:
- *
- * startPin: 5
- * endPin: 12
- * Current Pin State: pin:5 (HIGH) pin: 6 (HIGH) pin: 7 (LOW) pin: 8 (LOW) pin: 9 (HIGH) pin: 10 (LOW) pin: 11 (HIGH) pin: 12 (LOW)
- *
- * Integer to be returned: 202 (11001010 in binary)
+ * The range is read in chunks with readEEPROMRange() and then printed.
+ * RAW_BINARY writes the bytes as they are, INTEL_HEX prints records with checksums. The other formats print a line per address.
  */
-unsigned int digitalReadBetween(const unsigned int& startPin, const unsigned int& endPin) {
-
-    unsigned int data = 0;
+void printEEPROMAddress(const uint16_t& from, const uint16_t& to, const uint8_t& format) {
 
-    for (unsigned int pin = startPin; pin <= endPin; ++pin) {
-        pinMode(pin, INPUT);
+    if (format == INTEL_HEX)
+        return printEEPROMIntelHex(from, to);
 
-        bool readBit = digitalRead(pin);
+    uint8_t buffer[DUMP_CHUNK_LENGTH];
 
-        if (readBit)
-            data = (data << 1) | 0b1;
-        else
-            data = data << 1;
-    }
+    for (uint32_t chunkStart = from; chunkStart <= to; chunkStart += DUMP_CHUNK_LENGTH) {
+        uint16_t count = to - chunkStart + 1 < DUMP_CHUNK_LENGTH ? to - chunkStart + 1 : DUMP_CHUNK_LENGTH;
 
-    return data;
-}
-
-/**
- * Will set each pin between the given ones to the bit, which is position relative to the value
- * The function is extremely useful, when you have multiple I/O pins connected sequentially to arduino and you want to set bits on them.
- *
- * Example:
- *
- * startPin: 5
- * endPin: 12
- * value: 0b11001010
- *
- * Result Pins State: pin:5 (HIGH) pin: 6 (HIGH) pin: 7 (LOW) pin: 8 (LOW) pin: 9 (HIGH) pin: 10 (LOW) pin: 11 (HIGH) pin: 12 (LOW)
- */
-void digitalWriteBetween(const unsigned int& startPin, const unsigned int& endPin, const unsigned int& value) {
+        programmer.readEEPROMRange(chunkStart, buffer, count);
 
-    unsigned int bitIndex = 0;
+        if (format == RAW_BINARY) {
+            hal.beginOperation(PERF_SERIAL);
+            Serial.write(buffer, count);
+            hal.endOperation(PERF_SERIAL);
+            continue;
+        }
 
-    for (unsigned int pin = endPin; pin >= startPin; --pin) {
-        pinMode(pin, OUTPUT);
-        digitalWrite(pin, ((0b1 << bitIndex) & value) > 0);
-        bitIndex++;
+        for (uint16_t i = 0; i < count; ++i)
+            printEEPROMData(chunkStart + i, buffer[i], format);
     }
 }
 
 /**
- * Will set all of the provided @param pins to the given @param mode
- * @param mode Can be 0 (INPUT) or 1 (OUTPUT)
+ * Prints the range as Intel HEX records (16 bytes each) and the end of file record. See IntelHex.h
+ * The output of the serial monitor can be saved and used directly as .hex file.
  */
-template<size_t N>
-void pinModes(int (& pins)[N], const bool& mode) {
+void printEEPROMIntelHex(const uint16_t& from, const uint16_t& to) {
 
-    for (size_t i = 0; i < N; ++i)
-        pinMode(pins[i], mode);
-}
+    uint8_t buffer[INTEL_HEX_RECORD_DATA];
+    char line[INTEL_HEX_MAX_LINE + 1];
 
-/**
- * Will block the execution of the program for the given time.
- * Time unit can be 1 (MS) or 2 (US). There are macros for easier use.
- */
-void delay(const unsigned int& timeValue, const int& timeUnit) {
-    switch (timeUnit) {
-        case MS:
-            return delay(timeValue);
-        case US:
-            return delayMicroseconds(timeValue);
-    }
-}
+    for (uint32_t chunkStart = from; chunkStart <= to; chunkStart += INTEL_HEX_RECORD_DATA) {
+        uint8_t count = to - chunkStart + 1 < INTEL_HEX_RECORD_DATA ? to - chunkStart + 1 : INTEL_HEX_RECORD_DATA;
 
-/**
- * Will put the pin LOW or HIGH depending on the @param val for the given time @param timeValue then return it to the opposite @param val
- * Use case for example is when you need to hold a given pin LOW for given time so that the chip can complete given action.
- * @param timeUnit Can be 1 (MS) or 2(US)
- */
-void clockPin(const uint8_t& pin, const bool& val, const unsigned int& timeValue, const int& timeUnit) {
+        programmer.readEEPROMRange(chunkStart, buffer, count);
+        encodeIntelHexRecord(INTEL_HEX_DATA, chunkStart, buffer, count, line);
+        hal.beginOperation(PERF_SERIAL);
+        Serial.println(line);
+        hal.endOperation(PERF_SERIAL);
+    }
 
-    digitalWrite(pin, val);
-    delay(timeValue, timeUnit);
-    digitalWrite(pin, !val);
+    encodeIntelHexRecord(INTEL_HEX_END_OF_FILE, 0, 0, 0, line);
+    Serial.println(line);
 }
 
-/**
- * Will put the pin LOW or HIGH depending on the @param val and then return it to the opposite @param val
- * Use case for example is when some action in a chip triggers on the rising edge of a signal and thus you need to bring it LOW then HIGH again
- */
-void clockPin(const uint8_t& pin, const bool& val) {
-    digitalWrite(pin, val);
-    digitalWrite(pin, !val);
+void printProgrammingStats() {
+    const ProgrammingStats& stats = programmer.getStats();
+    char printBuffer[64];
+    sprintf(printBuffer, "Written: %u Skipped: %u Verified: %u Failed: %u", stats.written, stats.skipped, stats.verified, stats.failed);
+    Serial.println(printBuffer);
 }